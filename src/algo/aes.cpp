@@ -17,32 +17,38 @@
  * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <ndn-cxx/encoding/buffer-stream.hpp>
 #include "aes.hpp"
+#include "crypto-backend.hpp"
 #include "error.hpp"
 
 namespace ndn {
 namespace gep {
 namespace algo {
 
-using namespace CryptoPP;
+static const size_t BLOCK_SIZE = 16;
 
-static Buffer
-transform(CipherModeBase* cipher, const uint8_t* data, size_t dataLen)
+/**
+ * @brief Get the initial vector in @p params of CBC mode, nullptr in the other modes
+ */
+static const uint8_t*
+getInitialVector(const EncryptParams& params, Buffer& initVector)
 {
-  OBufferStream obuf;
-  StringSource pipe(data, dataLen, true,
-                    new StreamTransformationFilter(*cipher, new FileSink(obuf)));
-  return *(obuf.buf());
+  if (params.getAlgorithmType() != tlv::AlgorithmAesCbc)
+    return nullptr;
+
+  initVector = params.getIV();
+  if (initVector.size() != BLOCK_SIZE)
+    throw Error("incorrect initial vector size");
+  return initVector.buf();
 }
 
 DecryptKey<Aes>
 Aes::generateKey(RandomNumberGenerator& rng, AesKeyParams& params)
 {
-  SecByteBlock key(0x00, params.getKeySize() >> 3);  // Converting key bit-size to byte-size.
-  rng.GenerateBlock(key.data(), key.size());
+  Buffer key(params.getKeySize() >> 3);  // Converting key bit-size to byte-size.
+  rng.GenerateBlock(key.buf(), key.size());
 
-  DecryptKey<Aes> decryptKey(std::move(Buffer(key.data(), key.size())));
+  DecryptKey<Aes> decryptKey(std::move(key));
   return decryptKey;
 }
 
@@ -59,22 +65,17 @@ Aes::decrypt(const uint8_t* key, size_t keyLen,
              const uint8_t* payload, size_t payloadLen,
              const EncryptParams& params)
 {
-  switch (params.getAlgorithmType()) {
-    case tlv::AlgorithmAesEcb: {
-      ECB_Mode<AES>::Decryption ecbDecryption(key, keyLen);
-      return transform(&ecbDecryption, payload, payloadLen);
-    }
-    case tlv::AlgorithmAesCbc: {
-      const Buffer& initVector = params.getIV();
-      if (initVector.size() != static_cast<size_t>(AES::BLOCKSIZE))
-        throw Error("incorrect initial vector size");
+  Buffer initVector;
+  const uint8_t* iv = getInitialVector(params, initVector);
+  return CryptoBackend::get().decryptAes(params.getAlgorithmType(), key, keyLen,
+                                         iv, payload, payloadLen);
+}
 
-      CBC_Mode<AES>::Decryption cbcDecryption(key, keyLen, initVector.get());
-      return transform(&cbcDecryption, payload, payloadLen);
-    }
-    default:
-      throw Error("unsupported encryption mode");
-  }
+std::vector<Buffer>
+Aes::decryptBatch(const uint8_t* key, size_t keyLen,
+                  const std::vector<CbcPayload>& payloads)
+{
+  return CryptoBackend::get().decryptAesCbcBatch(key, keyLen, payloads);
 }
 
 Buffer
@@ -82,22 +83,10 @@ Aes::encrypt(const uint8_t* key, size_t keyLen,
              const uint8_t* payload, size_t payloadLen,
              const EncryptParams& params)
 {
-  switch (params.getAlgorithmType()) {
-    case tlv::AlgorithmAesEcb: {
-      ECB_Mode<AES>::Encryption ecbEncryption(key, keyLen);
-      return transform(&ecbEncryption, payload, payloadLen);
-    }
-    case tlv::AlgorithmAesCbc: {
-      const Buffer& initVector = params.getIV();
-      if (initVector.size() != static_cast<size_t>(AES::BLOCKSIZE))
-        throw Error("incorrect initial vector size");
-
-      CBC_Mode<AES>::Encryption cbcEncryption(key, keyLen, initVector.get());
-      return transform(&cbcEncryption, payload, payloadLen);
-    }
-    default:
-      throw Error("unsupported encryption mode");
-  }
+  Buffer initVector;
+  const uint8_t* iv = getInitialVector(params, initVector);
+  return CryptoBackend::get().encryptAes(params.getAlgorithmType(), key, keyLen,
+                                         iv, payload, payloadLen);
 }
 
 } // namespace algo
@@ -24,6 +24,7 @@
 #include "../random-number-generator.hpp"
 #include "encrypt-params.hpp"
 #include "../decrypt-key.hpp"
+#include "crypto-backend.hpp"
 
 
 namespace ndn {
@@ -44,6 +45,22 @@ public:
           const uint8_t* payload, size_t payloadLen,
           const EncryptParams& params);
 
+  typedef algo::CbcPayload CbcPayload;
+
+  /**
+   * @brief Decrypt the AES-CBC @p payloads encrypted with the same @p key
+   *
+   * The CryptoPP backend expands the key schedule once for the whole batch. As the
+   * blocks of CBC decryption are independent, the blocks of all payloads are decrypted in
+   * one pass, which lets the AES implementation process several blocks at once.
+   *
+   * @return The plain texts, in the order of @p payloads
+   * @throw Error a payload is not a padded multiple of the block size
+   */
+  static std::vector<Buffer>
+  decryptBatch(const uint8_t* key, size_t keyLen,
+               const std::vector<CbcPayload>& payloads);
+
   static Buffer
   encrypt(const uint8_t* key, size_t keyLen,
           const uint8_t* payload, size_t payloadLen,
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compression.hpp"
+#include "error.hpp"
+#include "../common.hpp"
+
+#ifdef NDN_GEP_HAVE_LZ4
+#include <lz4.h>
+#endif // NDN_GEP_HAVE_LZ4
+
+#ifdef NDN_GEP_HAVE_ZSTD
+#include <zstd.h>
+#endif // NDN_GEP_HAVE_ZSTD
+
+namespace ndn {
+namespace gep {
+namespace algo {
+
+static const size_t SIZE_HEADER_LENGTH = 4;
+// level 1 favors speed, as payloads are compressed on every sample
+static const int ZSTD_LEVEL = 1;
+
+static void
+writeSizeHeader(uint8_t* header, size_t size)
+{
+  header[0] = static_cast<uint8_t>(size >> 24);
+  header[1] = static_cast<uint8_t>(size >> 16);
+  header[2] = static_cast<uint8_t>(size >> 8);
+  header[3] = static_cast<uint8_t>(size);
+}
+
+static size_t
+readSizeHeader(const uint8_t* payload, size_t payloadLen)
+{
+  if (payloadLen < SIZE_HEADER_LENGTH)
+    throw Error("Compressed payload is too short");
+
+  size_t size = (static_cast<size_t>(payload[0]) << 24) | (static_cast<size_t>(payload[1]) << 16) |
+                (static_cast<size_t>(payload[2]) << 8) | static_cast<size_t>(payload[3]);
+  if (size > Compression::MAX_PAYLOAD_LENGTH)
+    throw Error("Decompressed payload is too large");
+  return size;
+}
+
+// bound of the memory allocated for a decompressed payload
+const size_t Compression::MAX_PAYLOAD_LENGTH = 16 * 1024 * 1024;
+
+bool
+Compression::isSupported(tlv::CompressionTypeValue type)
+{
+  switch (type) {
+    case tlv::CompressionNone:
+      return true;
+#ifdef NDN_GEP_HAVE_LZ4
+    case tlv::CompressionLz4:
+      return true;
+#endif // NDN_GEP_HAVE_LZ4
+#ifdef NDN_GEP_HAVE_ZSTD
+    case tlv::CompressionZstd:
+      return true;
+#endif // NDN_GEP_HAVE_ZSTD
+    default:
+      return false;
+  }
+}
+
+Buffer
+Compression::compress(tlv::CompressionTypeValue type, const uint8_t* payload, size_t payloadLen)
+{
+  // reject at the producer what consumers would refuse to decompress
+  if (type != tlv::CompressionNone && payloadLen > MAX_PAYLOAD_LENGTH)
+    throw Error("Payload is too large to compress");
+
+  switch (type) {
+    case tlv::CompressionNone:
+      return Buffer(payload, payloadLen);
+#ifdef NDN_GEP_HAVE_LZ4
+    case tlv::CompressionLz4: {
+      Buffer result(SIZE_HEADER_LENGTH + LZ4_compressBound(payloadLen));
+      writeSizeHeader(result.buf(), payloadLen);
+      int length = LZ4_compress_default(reinterpret_cast<const char*>(payload),
+                                        reinterpret_cast<char*>(result.buf()) + SIZE_HEADER_LENGTH,
+                                        payloadLen, result.size() - SIZE_HEADER_LENGTH);
+      if (length <= 0 && payloadLen > 0)
+        throw Error("LZ4 compression failed");
+      result.resize(SIZE_HEADER_LENGTH + length);
+      return result;
+    }
+#endif // NDN_GEP_HAVE_LZ4
+#ifdef NDN_GEP_HAVE_ZSTD
+    case tlv::CompressionZstd: {
+      Buffer result(SIZE_HEADER_LENGTH + ZSTD_compressBound(payloadLen));
+      writeSizeHeader(result.buf(), payloadLen);
+      size_t length = ZSTD_compress(result.buf() + SIZE_HEADER_LENGTH,
+                                    result.size() - SIZE_HEADER_LENGTH,
+                                    payload, payloadLen, ZSTD_LEVEL);
+      if (ZSTD_isError(length))
+        throw Error(std::string("zstd compression failed: ") + ZSTD_getErrorName(length));
+      result.resize(SIZE_HEADER_LENGTH + length);
+      return result;
+    }
+#endif // NDN_GEP_HAVE_ZSTD
+    default:
+      throw Error("Unsupported compression method");
+  }
+}
+
+Buffer
+Compression::decompress(tlv::CompressionTypeValue type, const uint8_t* payload, size_t payloadLen)
+{
+  switch (type) {
+    case tlv::CompressionNone:
+      return Buffer(payload, payloadLen);
+#ifdef NDN_GEP_HAVE_LZ4
+    case tlv::CompressionLz4: {
+      Buffer result(readSizeHeader(payload, payloadLen));
+      int length = LZ4_decompress_safe(reinterpret_cast<const char*>(payload) + SIZE_HEADER_LENGTH,
+                                       reinterpret_cast<char*>(result.buf()),
+                                       payloadLen - SIZE_HEADER_LENGTH, result.size());
+      if (length < 0 || static_cast<size_t>(length) != result.size())
+        throw Error("Malformed LZ4 payload");
+      return result;
+    }
+#endif // NDN_GEP_HAVE_LZ4
+#ifdef NDN_GEP_HAVE_ZSTD
+    case tlv::CompressionZstd: {
+      Buffer result(readSizeHeader(payload, payloadLen));
+      size_t length = ZSTD_decompress(result.buf(), result.size(),
+                                      payload + SIZE_HEADER_LENGTH,
+                                      payloadLen - SIZE_HEADER_LENGTH);
+      if (ZSTD_isError(length) || length != result.size())
+        throw Error("Malformed zstd payload");
+      return result;
+    }
+#endif // NDN_GEP_HAVE_ZSTD
+    default:
+      throw Error("Unsupported compression method");
+  }
+}
+
+} // namespace algo
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_ALGO_COMPRESSION_HPP
+#define NDN_GEP_ALGO_COMPRESSION_HPP
+
+#include <ndn-cxx/encoding/buffer.hpp>
+#include "../tlv.hpp"
+
+namespace ndn {
+namespace gep {
+namespace algo {
+
+/**
+ * @brief Lossless compression of the payload before encryption
+ *
+ * The compressed payload starts with the size of the original payload as a 4-octet
+ * big-endian integer. The algorithms available depend on the libraries found when the
+ * library is configured.
+ */
+class Compression
+{
+public:
+  /// @brief Maximum length of a payload to compress, and of a decompressed payload
+  static const size_t MAX_PAYLOAD_LENGTH;
+
+  /// @brief Check if compression @p type is available
+  static bool
+  isSupported(tlv::CompressionTypeValue type);
+
+  /**
+   * @brief Compress @p payload of @p payloadLen using compression @p type
+   *
+   * @throw Error @p type is not available, or @p payloadLen is above MAX_PAYLOAD_LENGTH
+   */
+  static Buffer
+  compress(tlv::CompressionTypeValue type, const uint8_t* payload, size_t payloadLen);
+
+  /**
+   * @brief Decompress @p payload of @p payloadLen compressed using compression @p type
+   *
+   * @throw Error @p type is not available or @p payload is malformed
+   */
+  static Buffer
+  decompress(tlv::CompressionTypeValue type, const uint8_t* payload, size_t payloadLen);
+};
+
+} // namespace algo
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_ALGO_COMPRESSION_HPP
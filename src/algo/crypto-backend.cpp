@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "crypto-backend.hpp"
+#include "cryptopp-backend.hpp"
+#include "openssl-backend.hpp"
+#include "error.hpp"
+
+#include <atomic>
+
+#ifndef NDN_GEP_DEFAULT_CRYPTO_BACKEND
+#define NDN_GEP_DEFAULT_CRYPTO_BACKEND "cryptopp"
+#endif // NDN_GEP_DEFAULT_CRYPTO_BACKEND
+
+namespace ndn {
+namespace gep {
+namespace algo {
+
+static const size_t AES_BLOCK_SIZE = 16;
+
+static std::atomic<CryptoBackend*>&
+getSelectedBackend()
+{
+  static std::atomic<CryptoBackend*> backend(&CryptoBackend::get(NDN_GEP_DEFAULT_CRYPTO_BACKEND));
+  return backend;
+}
+
+std::vector<Buffer>
+CryptoBackend::decryptAesCbcBatch(const uint8_t* key, size_t keyLen,
+                                  const std::vector<CbcPayload>& payloads)
+{
+  for (const auto& item : payloads) {
+    if (item.payloadLen == 0 || item.payloadLen % AES_BLOCK_SIZE != 0)
+      throw Error("incorrect payload size");
+  }
+
+  std::vector<Buffer> results;
+  results.reserve(payloads.size());
+  for (const auto& item : payloads)
+    results.push_back(decryptAes(tlv::AlgorithmAesCbc, key, keyLen,
+                                 item.iv, item.payload, item.payloadLen));
+  return results;
+}
+
+CryptoBackend&
+CryptoBackend::get()
+{
+  return *getSelectedBackend().load();
+}
+
+CryptoBackend&
+CryptoBackend::get(const std::string& name)
+{
+  if (name == "cryptopp") {
+    static CryptoppBackend backend;
+    return backend;
+  }
+#ifdef NDN_GEP_HAVE_OPENSSL
+  if (name == "openssl") {
+    static OpensslBackend backend;
+    return backend;
+  }
+#endif // NDN_GEP_HAVE_OPENSSL
+  throw Error("crypto backend " + name + " is not available");
+}
+
+void
+CryptoBackend::select(const std::string& name)
+{
+  getSelectedBackend() = &get(name);
+}
+
+std::vector<std::string>
+CryptoBackend::getNames()
+{
+  std::vector<std::string> names{"cryptopp"};
+#ifdef NDN_GEP_HAVE_OPENSSL
+  names.push_back("openssl");
+#endif // NDN_GEP_HAVE_OPENSSL
+  return names;
+}
+
+} // namespace algo
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_ALGO_CRYPTO_BACKEND_HPP
+#define NDN_GEP_ALGO_CRYPTO_BACKEND_HPP
+
+#include "../common.hpp"
+#include "../random-number-generator.hpp"
+#include "../tlv.hpp"
+
+#include <ndn-cxx/encoding/buffer.hpp>
+
+namespace ndn {
+namespace gep {
+namespace algo {
+
+/**
+ * @brief An AES-CBC encrypted payload and its initial vector
+ */
+struct CbcPayload
+{
+  const uint8_t* iv;
+  const uint8_t* payload;
+  size_t payloadLen;
+};
+
+/**
+ * @brief Implementation of the cryptographic primitives behind Rsa and Aes
+ *
+ * RSA private keys are encoded as PKCS#8 PrivateKeyInfo and public keys as X.509
+ * SubjectPublicKeyInfo, so the keys and ciphertexts of all the backends are interchangeable.
+ * AES payloads are padded with PKCS#7. The methods may be called from several threads.
+ *
+ * The backend used by Rsa and Aes is chosen when the library is configured, and can be
+ * changed at runtime with select().
+ */
+class CryptoBackend : noncopyable
+{
+public:
+  virtual
+  ~CryptoBackend() = default;
+
+  virtual std::string
+  getName() const = 0;
+
+  /// @brief Generate an RSA private key of @p keySize bits
+  virtual Buffer
+  generateRsaKey(RandomNumberGenerator& rng, size_t keySize) = 0;
+
+  /// @brief Get the public key of RSA @p privateKey
+  virtual Buffer
+  deriveRsaPublicKey(const uint8_t* privateKey, size_t keyLen) = 0;
+
+  /// @brief Get the size in octets of the modulus of RSA @p publicKey
+  virtual size_t
+  getRsaModulusSize(const uint8_t* publicKey, size_t keyLen) = 0;
+
+  /// @brief Encrypt @p payload with RSA @p publicKey using @p padding
+  virtual Buffer
+  encryptRsa(const uint8_t* publicKey, size_t keyLen,
+             const uint8_t* payload, size_t payloadLen,
+             tlv::AlgorithmTypeValue padding) = 0;
+
+  /// @brief Decrypt @p payload with RSA @p privateKey using @p padding
+  virtual Buffer
+  decryptRsa(const uint8_t* privateKey, size_t keyLen,
+             const uint8_t* payload, size_t payloadLen,
+             tlv::AlgorithmTypeValue padding) = 0;
+
+  /**
+   * @brief Encrypt @p payload with AES @p key in @p mode
+   *
+   * @p iv is the 16-octet initial vector of CBC mode, and is ignored in ECB mode.
+   */
+  virtual Buffer
+  encryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+             const uint8_t* iv, const uint8_t* payload, size_t payloadLen) = 0;
+
+  /// @brief Decrypt @p payload with AES @p key in @p mode
+  virtual Buffer
+  decryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+             const uint8_t* iv, const uint8_t* payload, size_t payloadLen) = 0;
+
+  /**
+   * @brief Decrypt the AES-CBC @p payloads encrypted with the same @p key
+   *
+   * The default implementation decrypts the payloads one by one.
+   */
+  virtual std::vector<Buffer>
+  decryptAesCbcBatch(const uint8_t* key, size_t keyLen, const std::vector<CbcPayload>& payloads);
+
+public:
+  /// @brief Get the backend used by Rsa and Aes
+  static CryptoBackend&
+  get();
+
+  /**
+   * @brief Get the backend named @p name
+   *
+   * @throw Error the backend is not built in this library
+   */
+  static CryptoBackend&
+  get(const std::string& name);
+
+  /**
+   * @brief Use the backend named @p name in Rsa and Aes afterwards
+   *
+   * @throw Error the backend is not built in this library
+   */
+  static void
+  select(const std::string& name);
+
+  /// @brief Get the names of the backends built in this library
+  static std::vector<std::string>
+  getNames();
+};
+
+} // namespace algo
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_ALGO_CRYPTO_BACKEND_HPP
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cryptopp-backend.hpp"
+#include "error.hpp"
+
+#include <ndn-cxx/encoding/buffer-stream.hpp>
+
+namespace ndn {
+namespace gep {
+namespace algo {
+
+using namespace CryptoPP;
+
+static Buffer
+transform(SimpleProxyFilter* filter, const uint8_t* data, size_t dataLen)
+{
+  OBufferStream obuf;
+  filter->Attach(new FileSink(obuf));
+
+  StringSource pipe(data, dataLen, true, filter);
+  return *(obuf.buf());
+}
+
+static Buffer
+transform(CipherModeBase* cipher, const uint8_t* data, size_t dataLen)
+{
+  OBufferStream obuf;
+  StringSource pipe(data, dataLen, true,
+                    new StreamTransformationFilter(*cipher, new FileSink(obuf)));
+  return *(obuf.buf());
+}
+
+template<typename Key>
+static void
+loadKey(Key& rsaKey, const uint8_t* key, size_t keyLen)
+{
+  ByteQueue keyQueue;
+  keyQueue.LazyPut(key, keyLen);
+  rsaKey.Load(keyQueue);
+}
+
+std::string
+CryptoppBackend::getName() const
+{
+  return "cryptopp";
+}
+
+Buffer
+CryptoppBackend::generateRsaKey(RandomNumberGenerator& rng, size_t keySize)
+{
+  RSA::PrivateKey privateKey;
+  privateKey.GenerateRandomWithKeySize(rng, keySize);
+
+  OBufferStream obuf;
+  privateKey.Save(FileSink(obuf).Ref());
+  return *(obuf.buf());
+}
+
+Buffer
+CryptoppBackend::deriveRsaPublicKey(const uint8_t* privateKey, size_t keyLen)
+{
+  RSA::PrivateKey rsaPrivateKey;
+  loadKey(rsaPrivateKey, privateKey, keyLen);
+
+  RSA::PublicKey publicKey(rsaPrivateKey);
+
+  OBufferStream obuf;
+  publicKey.Save(FileSink(obuf).Ref());
+  return *(obuf.buf());
+}
+
+size_t
+CryptoppBackend::getRsaModulusSize(const uint8_t* publicKey, size_t keyLen)
+{
+  RSA::PublicKey rsaPublicKey;
+  loadKey(rsaPublicKey, publicKey, keyLen);
+  return rsaPublicKey.GetModulus().ByteCount();
+}
+
+Buffer
+CryptoppBackend::encryptRsa(const uint8_t* publicKey, size_t keyLen,
+                            const uint8_t* payload, size_t payloadLen,
+                            tlv::AlgorithmTypeValue padding)
+{
+  AutoSeededRandomPool rng;
+  RSA::PublicKey rsaPublicKey;
+  loadKey(rsaPublicKey, publicKey, keyLen);
+
+  switch (padding) {
+    case tlv::AlgorithmRsaPkcs: {
+      RSAES_PKCS1v15_Encryptor encryptor_pkcs1v15(rsaPublicKey);
+      PK_EncryptorFilter* filter_pkcs1v15 = new PK_EncryptorFilter(rng, encryptor_pkcs1v15);
+      return transform(filter_pkcs1v15, payload, payloadLen);
+    }
+    case tlv::AlgorithmRsaOaep: {
+      RSAES_OAEP_SHA_Encryptor encryptor_oaep_sha(rsaPublicKey);
+      PK_EncryptorFilter* filter_oaep_sha = new PK_EncryptorFilter(rng, encryptor_oaep_sha);
+      return transform(filter_oaep_sha, payload, payloadLen);
+    }
+    default:
+      throw Error("unsupported padding scheme");
+  }
+}
+
+Buffer
+CryptoppBackend::decryptRsa(const uint8_t* privateKey, size_t keyLen,
+                            const uint8_t* payload, size_t payloadLen,
+                            tlv::AlgorithmTypeValue padding)
+{
+  AutoSeededRandomPool rng;
+  RSA::PrivateKey rsaPrivateKey;
+  loadKey(rsaPrivateKey, privateKey, keyLen);
+
+  switch (padding) {
+    case tlv::AlgorithmRsaPkcs: {
+      RSAES_PKCS1v15_Decryptor decryptor_pkcs1v15(rsaPrivateKey);
+      PK_DecryptorFilter* filter_pkcs1v15 = new PK_DecryptorFilter(rng, decryptor_pkcs1v15);
+      return transform(filter_pkcs1v15, payload, payloadLen);
+    }
+    case tlv::AlgorithmRsaOaep: {
+      RSAES_OAEP_SHA_Decryptor decryptor_oaep_sha(rsaPrivateKey);
+      PK_DecryptorFilter* filter_oaep_sha = new PK_DecryptorFilter(rng, decryptor_oaep_sha);
+      return transform(filter_oaep_sha, payload, payloadLen);
+    }
+    default:
+      throw Error("unsupported padding scheme");
+  }
+}
+
+Buffer
+CryptoppBackend::encryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+                            const uint8_t* iv, const uint8_t* payload, size_t payloadLen)
+{
+  switch (mode) {
+    case tlv::AlgorithmAesEcb: {
+      ECB_Mode<AES>::Encryption ecbEncryption(key, keyLen);
+      return transform(&ecbEncryption, payload, payloadLen);
+    }
+    case tlv::AlgorithmAesCbc: {
+      CBC_Mode<AES>::Encryption cbcEncryption(key, keyLen, iv);
+      return transform(&cbcEncryption, payload, payloadLen);
+    }
+    default:
+      throw Error("unsupported encryption mode");
+  }
+}
+
+Buffer
+CryptoppBackend::decryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+                            const uint8_t* iv, const uint8_t* payload, size_t payloadLen)
+{
+  switch (mode) {
+    case tlv::AlgorithmAesEcb: {
+      ECB_Mode<AES>::Decryption ecbDecryption(key, keyLen);
+      return transform(&ecbDecryption, payload, payloadLen);
+    }
+    case tlv::AlgorithmAesCbc: {
+      CBC_Mode<AES>::Decryption cbcDecryption(key, keyLen, iv);
+      return transform(&cbcDecryption, payload, payloadLen);
+    }
+    default:
+      throw Error("unsupported encryption mode");
+  }
+}
+
+std::vector<Buffer>
+CryptoppBackend::decryptAesCbcBatch(const uint8_t* key, size_t keyLen,
+                                    const std::vector<CbcPayload>& payloads)
+{
+  const size_t blockSize = AES::BLOCKSIZE;
+
+  size_t totalLen = 0;
+  for (const auto& item : payloads) {
+    if (item.payloadLen == 0 || item.payloadLen % blockSize != 0)
+      throw Error("incorrect payload size");
+    totalLen += item.payloadLen;
+  }
+
+  // P[i] = D(C[i]) xor C[i-1], where C[-1] is the initial vector. Lay out the cipher
+  // blocks of all payloads, and the blocks they are xored with, back to back.
+  Buffer xorBlocks(totalLen);
+  size_t offset = 0;
+  for (const auto& item : payloads) {
+    std::copy(item.iv, item.iv + blockSize, xorBlocks.begin() + offset);
+    std::copy(item.payload, item.payload + item.payloadLen - blockSize,
+              xorBlocks.begin() + offset + blockSize);
+    offset += item.payloadLen;
+  }
+
+  Buffer cipherBlocks;
+  cipherBlocks.reserve(totalLen);
+  for (const auto& item : payloads)
+    cipherBlocks.insert(cipherBlocks.end(), item.payload, item.payload + item.payloadLen);
+
+  Buffer plainBlocks(totalLen);
+  AES::Decryption aesDecryption(key, keyLen);
+  if (totalLen > 0)
+    aesDecryption.AdvancedProcessBlocks(cipherBlocks.buf(), xorBlocks.buf(), plainBlocks.buf(),
+                                        totalLen, BlockTransformation::BT_AllowParallel);
+
+  // split the plain texts and remove the PKCS#7 padding
+  std::vector<Buffer> results;
+  results.reserve(payloads.size());
+  offset = 0;
+  for (const auto& item : payloads) {
+    const uint8_t* begin = plainBlocks.buf() + offset;
+    const uint8_t* end = begin + item.payloadLen;
+    uint8_t padding = *(end - 1);
+    if (padding == 0 || padding > blockSize ||
+        std::any_of(end - padding, end, [padding] (uint8_t b) { return b != padding; }))
+      throw Error("invalid padding");
+
+    results.push_back(Buffer(begin, end - padding));
+    offset += item.payloadLen;
+  }
+  return results;
+}
+
+} // namespace algo
+} // namespace gep
+} // namespace ndn
@@ -26,6 +26,7 @@ namespace algo {
 
 EncryptParams::EncryptParams(tlv::AlgorithmTypeValue algorithm, uint8_t ivLength)
   : m_algo(algorithm)
+  , m_compression(tlv::CompressionNone)
 {
   if (ivLength != 0){
     RandomNumberGenerator rng;
@@ -58,6 +59,18 @@ EncryptParams::getAlgorithmType() const
   return m_algo;
 }
 
+void
+EncryptParams::setCompressionType(tlv::CompressionTypeValue compression)
+{
+  m_compression = compression;
+}
+
+tlv::CompressionTypeValue
+EncryptParams::getCompressionType() const
+{
+  return m_compression;
+}
+
 } // namespace algo
 } // namespace gep
 } // namespace ndn
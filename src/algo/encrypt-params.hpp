@@ -25,8 +25,16 @@ public:
   tlv::AlgorithmTypeValue
   getAlgorithmType() const;
 
+  /// @brief Set the compression applied to the payload before symmetric encryption
+  void
+  setCompressionType(tlv::CompressionTypeValue compression);
+
+  tlv::CompressionTypeValue
+  getCompressionType() const;
+
 private:
   tlv::AlgorithmTypeValue m_algo;
+  tlv::CompressionTypeValue m_compression;
   Buffer m_iv;
 };
 
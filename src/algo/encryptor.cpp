@@ -22,6 +22,8 @@
 #include "../encrypted-content.hpp"
 #include "aes.hpp"
 #include "rsa.hpp"
+#include "compression.hpp"
+#include "crypto-backend.hpp"
 
 #include "error.hpp"
 
@@ -29,7 +31,9 @@ namespace ndn {
 namespace gep {
 namespace algo {
 
-using namespace CryptoPP;
+static const size_t AES_BLOCK_SIZE = 16;
+// overhead of the PKCS#1 v1.5 padding, which bounds the payload wrapped directly
+static const size_t RSA_PKCS1_PADDING_SIZE = 11;
 
 /**
  * @brief Helper method for symmetric encryption
@@ -47,15 +51,28 @@ encryptSymmetric(const uint8_t* payload, size_t payloadLen,
   const Buffer& iv = params.getIV();
   KeyLocator keyLocator(keyName);
 
+  // compress the payload before encryption, ciphertext cannot be compressed
+  tlv::CompressionTypeValue compression = params.getCompressionType();
+  Buffer compressedPayload;
+  if (compression != tlv::CompressionNone) {
+    compressedPayload = Compression::compress(compression, payload, payloadLen);
+    payload = compressedPayload.buf();
+    payloadLen = compressedPayload.size();
+  }
+
   switch (algType) {
     case tlv::AlgorithmAesEcb: {
       const Buffer& encryptedPayload = Aes::encrypt(key, keyLen, payload, payloadLen, params);
-      return EncryptedContent(algType, keyLocator, encryptedPayload.buf(), encryptedPayload.size(), iv.buf(), iv.size());
+      EncryptedContent content(algType, keyLocator, encryptedPayload.buf(), encryptedPayload.size(), iv.buf(), iv.size());
+      content.setCompressionAlgorithm(compression);
+      return content;
     }
     case tlv::AlgorithmAesCbc: {
-      BOOST_ASSERT(iv.size() == static_cast<size_t>(AES::BLOCKSIZE));
+      BOOST_ASSERT(iv.size() == AES_BLOCK_SIZE);
       const Buffer& encryptedPayload = Aes::encrypt(key, keyLen, payload, payloadLen, params);
-      return EncryptedContent(algType, keyLocator, encryptedPayload.buf(), encryptedPayload.size(), iv.buf(), iv.size());
+      EncryptedContent content(algType, keyLocator, encryptedPayload.buf(), encryptedPayload.size(), iv.buf(), iv.size());
+      content.setCompressionAlgorithm(compression);
+      return content;
     }
     default: {
       BOOST_ASSERT(false);
@@ -110,30 +127,25 @@ encryptData(Data& data, const uint8_t* payload, size_t payloadLen,
     }
     case tlv::AlgorithmRsaPkcs:
     case tlv::AlgorithmRsaOaep: {
-      size_t maxPlaintextLength = 0;
-      RSA::PublicKey publicKey;
-      ByteQueue keyQueue;
-
-      keyQueue.LazyPut(key, keyLen);
-      publicKey.Load(keyQueue);
-      RSAES_PKCS1v15_Encryptor enc(publicKey);
-      maxPlaintextLength = enc.FixedMaxPlaintextLength();
+      size_t modulusSize = CryptoBackend::get().getRsaModulusSize(key, keyLen);
+      size_t maxPlaintextLength = modulusSize > RSA_PKCS1_PADDING_SIZE ?
+                                  modulusSize - RSA_PKCS1_PADDING_SIZE : 0;
 
       if (maxPlaintextLength < payloadLen) {
         RandomNumberGenerator rng;
-        SecByteBlock nonceKey(0x00, 16);  // 128 bits key.
-        rng.GenerateBlock(nonceKey.data(), nonceKey.size());
+        Buffer nonceKey(16);  // 128 bits key.
+        rng.GenerateBlock(nonceKey.buf(), nonceKey.size());
 
         Name nonceKeyName(keyName);
         nonceKeyName.append("nonce");
 
-        EncryptParams symParams(tlv::AlgorithmAesCbc, AES::BLOCKSIZE);
+        EncryptParams symParams(tlv::AlgorithmAesCbc, AES_BLOCK_SIZE);
 
         const EncryptedContent& nonceContent =
-          encryptSymmetric(payload, payloadLen, nonceKey.data(), nonceKey.size(), nonceKeyName, symParams);
+          encryptSymmetric(payload, payloadLen, nonceKey.buf(), nonceKey.size(), nonceKeyName, symParams);
 
         const EncryptedContent& payloadContent =
-          encryptAsymmetric(nonceKey.data(), nonceKey.size(), key, keyLen, keyName, params);
+          encryptAsymmetric(nonceKey.buf(), nonceKey.size(), key, keyLen, keyName, params);
 
         Block content(tlv::Content);
         content.push_back(payloadContent.wireEncode());
@@ -153,6 +165,40 @@ encryptData(Data& data, const uint8_t* payload, size_t payloadLen,
   }
 }
 
+Block
+encryptNonce(Buffer& nonceKey, const Name& keyName, const uint8_t* key, size_t keyLen,
+             const EncryptParams& params)
+{
+  RandomNumberGenerator rng;
+  nonceKey = Buffer(16);  // 128 bits key.
+  rng.GenerateBlock(nonceKey.buf(), nonceKey.size());
+
+  return encryptAsymmetric(nonceKey.buf(), nonceKey.size(), key, keyLen, keyName, params)
+           .wireEncode();
+}
+
+void
+encryptDataWithNonce(Data& data, const uint8_t* payload, size_t payloadLen,
+                     const Name& keyName, const Buffer& nonceKey, const Block& encryptedNonce)
+{
+  Name dataName = data.getName();
+  dataName.append(NAME_COMPONENT_FOR).append(keyName);
+  data.setName(dataName);
+
+  Name nonceKeyName(keyName);
+  nonceKeyName.append("nonce");
+
+  EncryptParams symParams(tlv::AlgorithmAesCbc, AES_BLOCK_SIZE);
+  const EncryptedContent& nonceContent =
+    encryptSymmetric(payload, payloadLen, nonceKey.buf(), nonceKey.size(), nonceKeyName, symParams);
+
+  Block content(tlv::Content);
+  content.push_back(encryptedNonce);
+  content.push_back(nonceContent.wireEncode());
+
+  data.setContent(content);
+}
+
 } // namespace algo
 } // namespace gep
 } // namespace ndn
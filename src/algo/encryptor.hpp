@@ -36,13 +36,36 @@ namespace algo {
  * @p data. If @p params defines an asymmetric encryption and the payload is
  * larger than the max plaintext size, this method will encrypt the payload
  * with a symmetric key that will be asymmetrically encrypted and provided as
- * a nonce in the content of @p data.
+ * a nonce in the content of @p data. If @p params defines a compression,
+ * the payload is compressed before symmetric encryption.
  */
 void
 encryptData(Data& data, const uint8_t* payload, size_t payloadLen,
             const Name& keyName, const uint8_t* key, size_t keyLen,
             const EncryptParams& params);
 
+/**
+ * @brief Encrypt a fresh nonce key with the asymmetric @p key of @p keyName.
+ *
+ * The nonce key is set to @p nonceKey, and the returned EncryptedContent TLV can be
+ * used with encryptDataWithNonce() for several payloads encrypted for @p keyName,
+ * so that the asymmetric encryption is done only once.
+ */
+Block
+encryptNonce(Buffer& nonceKey, const Name& keyName, const uint8_t* key, size_t keyLen,
+             const EncryptParams& params);
+
+/**
+ * @brief Prepare a data packet encrypted with a nonce key.
+ *
+ * This method will encrypt @p payload using @p nonceKey, and set the content of @p data
+ * in the same format as encryptData() does for a large payload, using @p encryptedNonce
+ * returned by encryptNonce() for @p keyName.
+ */
+void
+encryptDataWithNonce(Data& data, const uint8_t* payload, size_t payloadLen,
+                     const Name& keyName, const Buffer& nonceKey, const Block& encryptedNonce);
+
 } // namespace algo
 } // namespace gep
 } // namespace ndn
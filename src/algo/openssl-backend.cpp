@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "openssl-backend.hpp"
+
+#ifdef NDN_GEP_HAVE_OPENSSL
+
+#include "error.hpp"
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+namespace ndn {
+namespace gep {
+namespace algo {
+
+typedef std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> PKeyPtr;
+typedef std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> PKeyCtxPtr;
+typedef std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> CipherCtxPtr;
+
+static void
+checkResult(bool isOk, const char* what)
+{
+  if (!isOk) {
+    // the error queue is per thread, do not leave it to the next caller
+    ERR_clear_error();
+    throw Error(what);
+  }
+}
+
+static PKeyPtr
+loadPrivateKey(const uint8_t* key, size_t keyLen)
+{
+  const unsigned char* p = key;
+  PKeyPtr pkey(d2i_AutoPrivateKey(nullptr, &p, static_cast<long>(keyLen)), &EVP_PKEY_free);
+  checkResult(pkey != nullptr, "cannot load RSA private key");
+  return pkey;
+}
+
+static PKeyPtr
+loadPublicKey(const uint8_t* key, size_t keyLen)
+{
+  const unsigned char* p = key;
+  PKeyPtr pkey(d2i_PUBKEY(nullptr, &p, static_cast<long>(keyLen)), &EVP_PKEY_free);
+  checkResult(pkey != nullptr, "cannot load RSA public key");
+  return pkey;
+}
+
+static Buffer
+transformRsa(EVP_PKEY* pkey, bool isEncryption,
+             const uint8_t* payload, size_t payloadLen, tlv::AlgorithmTypeValue padding)
+{
+  int rsaPadding = 0;
+  switch (padding) {
+    case tlv::AlgorithmRsaPkcs:
+      rsaPadding = RSA_PKCS1_PADDING;
+      break;
+    case tlv::AlgorithmRsaOaep:
+      // SHA-1 and MGF1 with SHA-1, as RSAES_OAEP_SHA of CryptoPP
+      rsaPadding = RSA_PKCS1_OAEP_PADDING;
+      break;
+    default:
+      throw Error("unsupported padding scheme");
+  }
+
+  auto init = isEncryption ? &EVP_PKEY_encrypt_init : &EVP_PKEY_decrypt_init;
+  auto transform = isEncryption ? &EVP_PKEY_encrypt : &EVP_PKEY_decrypt;
+
+  PKeyCtxPtr ctx(EVP_PKEY_CTX_new(pkey, nullptr), &EVP_PKEY_CTX_free);
+  checkResult(ctx != nullptr && init(ctx.get()) > 0 &&
+              EVP_PKEY_CTX_set_rsa_padding(ctx.get(), rsaPadding) > 0,
+              "cannot set up RSA");
+
+  size_t outLen = 0;
+  checkResult(transform(ctx.get(), nullptr, &outLen, payload, payloadLen) > 0,
+              "cannot set up RSA");
+  Buffer out(outLen);
+  checkResult(transform(ctx.get(), out.buf(), &outLen, payload, payloadLen) > 0,
+              isEncryption ? "RSA encryption failed" : "RSA decryption failed");
+  out.resize(outLen);
+  return out;
+}
+
+static const EVP_CIPHER*
+getAesCipher(tlv::AlgorithmTypeValue mode, size_t keyLen)
+{
+  bool isCbc = false;
+  switch (mode) {
+    case tlv::AlgorithmAesEcb:
+      break;
+    case tlv::AlgorithmAesCbc:
+      isCbc = true;
+      break;
+    default:
+      throw Error("unsupported encryption mode");
+  }
+
+  switch (keyLen) {
+    case 16:
+      return isCbc ? EVP_aes_128_cbc() : EVP_aes_128_ecb();
+    case 24:
+      return isCbc ? EVP_aes_192_cbc() : EVP_aes_192_ecb();
+    case 32:
+      return isCbc ? EVP_aes_256_cbc() : EVP_aes_256_ecb();
+    default:
+      throw Error("incorrect key size");
+  }
+}
+
+static Buffer
+transformAes(bool isEncryption, tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+             const uint8_t* iv, const uint8_t* payload, size_t payloadLen)
+{
+  const EVP_CIPHER* cipher = getAesCipher(mode, keyLen);
+  CipherCtxPtr ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+  checkResult(ctx != nullptr &&
+              EVP_CipherInit_ex(ctx.get(), cipher, nullptr, key,
+                                mode == tlv::AlgorithmAesCbc ? iv : nullptr,
+                                isEncryption ? 1 : 0) == 1,
+              "cannot set up AES");
+
+  // PKCS#7 padding adds at most one block
+  Buffer out(payloadLen + EVP_CIPHER_block_size(cipher));
+  int len = 0;
+  int finalLen = 0;
+  checkResult(EVP_CipherUpdate(ctx.get(), out.buf(), &len,
+                               payload, static_cast<int>(payloadLen)) == 1 &&
+              EVP_CipherFinal_ex(ctx.get(), out.buf() + len, &finalLen) == 1,
+              isEncryption ? "AES encryption failed" : "AES decryption failed");
+  out.resize(len + finalLen);
+  return out;
+}
+
+std::string
+OpensslBackend::getName() const
+{
+  return "openssl";
+}
+
+Buffer
+OpensslBackend::generateRsaKey(RandomNumberGenerator&, size_t keySize)
+{
+  // the key is generated from the random number generator of OpenSSL
+  PKeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr), &EVP_PKEY_CTX_free);
+  checkResult(ctx != nullptr && EVP_PKEY_keygen_init(ctx.get()) > 0 &&
+              EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), static_cast<int>(keySize)) > 0,
+              "cannot set up RSA key generation");
+
+  EVP_PKEY* generatedKey = nullptr;
+  checkResult(EVP_PKEY_keygen(ctx.get(), &generatedKey) > 0, "cannot generate RSA key");
+  PKeyPtr pkey(generatedKey, &EVP_PKEY_free);
+
+  // PKCS#8 PrivateKeyInfo, as CryptoPP saves private keys
+  std::unique_ptr<PKCS8_PRIV_KEY_INFO, decltype(&PKCS8_PRIV_KEY_INFO_free)>
+    info(EVP_PKEY2PKCS8(pkey.get()), &PKCS8_PRIV_KEY_INFO_free);
+  checkResult(info != nullptr, "cannot encode RSA private key");
+
+  Buffer out(i2d_PKCS8_PRIV_KEY_INFO(info.get(), nullptr));
+  unsigned char* p = out.buf();
+  i2d_PKCS8_PRIV_KEY_INFO(info.get(), &p);
+  return out;
+}
+
+Buffer
+OpensslBackend::deriveRsaPublicKey(const uint8_t* privateKey, size_t keyLen)
+{
+  PKeyPtr pkey = loadPrivateKey(privateKey, keyLen);
+
+  int outLen = i2d_PUBKEY(pkey.get(), nullptr);
+  checkResult(outLen > 0, "cannot encode RSA public key");
+  Buffer out(outLen);
+  unsigned char* p = out.buf();
+  i2d_PUBKEY(pkey.get(), &p);
+  return out;
+}
+
+size_t
+OpensslBackend::getRsaModulusSize(const uint8_t* publicKey, size_t keyLen)
+{
+  return EVP_PKEY_size(loadPublicKey(publicKey, keyLen).get());
+}
+
+Buffer
+OpensslBackend::encryptRsa(const uint8_t* publicKey, size_t keyLen,
+                           const uint8_t* payload, size_t payloadLen,
+                           tlv::AlgorithmTypeValue padding)
+{
+  return transformRsa(loadPublicKey(publicKey, keyLen).get(), true,
+                      payload, payloadLen, padding);
+}
+
+Buffer
+OpensslBackend::decryptRsa(const uint8_t* privateKey, size_t keyLen,
+                           const uint8_t* payload, size_t payloadLen,
+                           tlv::AlgorithmTypeValue padding)
+{
+  return transformRsa(loadPrivateKey(privateKey, keyLen).get(), false,
+                      payload, payloadLen, padding);
+}
+
+Buffer
+OpensslBackend::encryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+                           const uint8_t* iv, const uint8_t* payload, size_t payloadLen)
+{
+  return transformAes(true, mode, key, keyLen, iv, payload, payloadLen);
+}
+
+Buffer
+OpensslBackend::decryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+                           const uint8_t* iv, const uint8_t* payload, size_t payloadLen)
+{
+  return transformAes(false, mode, key, keyLen, iv, payload, payloadLen);
+}
+
+} // namespace algo
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_HAVE_OPENSSL
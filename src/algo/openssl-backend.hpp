@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_ALGO_OPENSSL_BACKEND_HPP
+#define NDN_GEP_ALGO_OPENSSL_BACKEND_HPP
+
+#include "crypto-backend.hpp"
+
+namespace ndn {
+namespace gep {
+namespace algo {
+
+/**
+ * @brief Crypto backend on OpenSSL libcrypto, built when the library is configured
+ *        --with-openssl
+ */
+class OpensslBackend : public CryptoBackend
+{
+public:
+  std::string
+  getName() const DECL_OVERRIDE;
+
+  Buffer
+  generateRsaKey(RandomNumberGenerator& rng, size_t keySize) DECL_OVERRIDE;
+
+  Buffer
+  deriveRsaPublicKey(const uint8_t* privateKey, size_t keyLen) DECL_OVERRIDE;
+
+  size_t
+  getRsaModulusSize(const uint8_t* publicKey, size_t keyLen) DECL_OVERRIDE;
+
+  Buffer
+  encryptRsa(const uint8_t* publicKey, size_t keyLen,
+             const uint8_t* payload, size_t payloadLen,
+             tlv::AlgorithmTypeValue padding) DECL_OVERRIDE;
+
+  Buffer
+  decryptRsa(const uint8_t* privateKey, size_t keyLen,
+             const uint8_t* payload, size_t payloadLen,
+             tlv::AlgorithmTypeValue padding) DECL_OVERRIDE;
+
+  Buffer
+  encryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+             const uint8_t* iv, const uint8_t* payload, size_t payloadLen) DECL_OVERRIDE;
+
+  Buffer
+  decryptAes(tlv::AlgorithmTypeValue mode, const uint8_t* key, size_t keyLen,
+             const uint8_t* iv, const uint8_t* payload, size_t payloadLen) DECL_OVERRIDE;
+};
+
+} // namespace algo
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_ALGO_OPENSSL_BACKEND_HPP
@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "caching-validator.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+namespace ndn {
+namespace gep {
+
+const size_t CachingValidator::DEFAULT_DIGEST_CAPACITY = 10000;
+const time::seconds CachingValidator::DEFAULT_SIGNER_LIFETIME = time::seconds(3600);
+
+CachingValidator::CachingValidator(unique_ptr<Validator> inner,
+                                   shared_ptr<CertificateCache> certificateCache,
+                                   size_t digestCapacity,
+                                   const time::seconds& signerLifetime)
+  : m_inner(std::move(inner))
+  , m_certificateCache(certificateCache)
+  , m_digestCapacity(digestCapacity)
+  , m_signerLifetime(signerLifetime)
+  , m_ioService(nullptr)
+  , m_isAlive(make_shared<bool>(true))
+  , m_nDigestHits(0)
+  , m_nSignerHits(0)
+  , m_nInnerValidations(0)
+{
+}
+
+CachingValidator::~CachingValidator() = default;
+
+void
+CachingValidator::addTrustedCertificate(const IdentityCertificate& certificate, const Name& scope)
+{
+  // the key locator of a packet names the certificate with or without version
+  for (const Name& signerName : {certificate.getName(), certificate.getName().getPrefix(-1)}) {
+    Signer& signer = m_signers[signerName];
+    if (signer.certificateName != certificate.getName()) {
+      signer.certificateName = certificate.getName();
+      signer.publicKey = certificate.getPublicKeyInfo();
+      signer.scopes.clear();
+      signer.dataNames.clear();
+    }
+    signer.notAfter = certificate.getNotAfter();
+    signer.scopes.insert(scope);
+  }
+}
+
+void
+CachingValidator::setWorkerPool(const shared_ptr<WorkerPool>& workerPool,
+                                boost::asio::io_service& ioService)
+{
+  m_workerPool = workerPool;
+  m_ioService = &ioService;
+}
+
+void
+CachingValidator::resetCache()
+{
+  m_digests.clear();
+  m_digestIndex.clear();
+  m_signers.clear();
+}
+
+void
+CachingValidator::checkPolicy(const Data& data, int nSteps,
+                              const OnDataValidated& onValidated,
+                              const OnDataValidationFailed& onValidationFailed,
+                              std::vector<shared_ptr<ValidationRequest>>& nextSteps)
+{
+  std::string digest = getDigest(data);
+  auto it = m_digestIndex.find(digest);
+  if (it != m_digestIndex.end()) {
+    m_digests.splice(m_digests.begin(), m_digests, it->second);
+    m_nDigestHits++;
+    onValidated(data.shared_from_this());
+    return;
+  }
+
+  Name signerName = getSignerName(data);
+  const Signer* signer = findSigner(signerName, data.getName());
+  if (signer != nullptr) {
+    m_nSignerHits++;
+    Verification verification{data.shared_from_this(), signer->publicKey, digest,
+                              onValidated, onValidationFailed, false};
+    if (m_workerPool != nullptr) {
+      // verify the packets received in the same round of the io_service in one batch
+      m_pendingBatch.push_back(verification);
+      if (m_pendingBatch.size() == 1) {
+        // the pool may be replaced or unset before the batch is verified
+        weak_ptr<bool> isAlive = m_isAlive;
+        shared_ptr<WorkerPool> workerPool = m_workerPool;
+        boost::asio::io_service* ioService = m_ioService;
+        m_ioService->post([this, isAlive, workerPool, ioService] {
+            if (!isAlive.expired())
+              verifyBatch(*workerPool, *ioService);
+          });
+      }
+      return;
+    }
+
+    verification.isValid = verifySignature(data, signer->publicKey);
+    finishVerification(verification);
+    return;
+  }
+
+  m_nInnerValidations++;
+  weak_ptr<bool> isAlive = m_isAlive;
+  m_inner->validate(data,
+                    [=] (const shared_ptr<const Data>& validData) {
+                      if (!isAlive.expired()) {
+                        learnSigner(signerName, validData->getName());
+                        addDigest(digest);
+                      }
+                      onValidated(validData);
+                    },
+                    onValidationFailed);
+}
+
+void
+CachingValidator::checkPolicy(const Interest& interest, int nSteps,
+                              const OnInterestValidated& onValidated,
+                              const OnInterestValidationFailed& onValidationFailed,
+                              std::vector<shared_ptr<ValidationRequest>>& nextSteps)
+{
+  // signed interests carry a nonce and a timestamp, so they are never validated twice
+  m_inner->validate(interest, onValidated, onValidationFailed);
+}
+
+std::string
+CachingValidator::getDigest(const Data& data)
+{
+  const name::Component& digest = data.getFullName().get(-1);
+  return std::string(reinterpret_cast<const char*>(digest.value()), digest.value_size());
+}
+
+Name
+CachingValidator::getSignerName(const Data& data)
+{
+  const Signature& signature = data.getSignature();
+  if (!signature.hasKeyLocator() ||
+      signature.getKeyLocator().getType() != KeyLocator::KeyLocator_Name)
+    return Name();
+
+  return signature.getKeyLocator().getName();
+}
+
+const CachingValidator::Signer*
+CachingValidator::findSigner(const Name& signerName, const Name& dataName)
+{
+  if (signerName.empty())
+    return nullptr;
+
+  auto it = m_signers.find(signerName);
+  if (it == m_signers.end())
+    return nullptr;
+
+  if (it->second.notAfter < time::system_clock::now()) {
+    m_signers.erase(it);
+    return nullptr;
+  }
+
+  if (it->second.dataNames.count(dataName) > 0)
+    return &it->second;
+  for (const Name& scope : it->second.scopes) {
+    if (scope.isPrefixOf(dataName))
+      return &it->second;
+  }
+  return nullptr;
+}
+
+void
+CachingValidator::learnSigner(const Name& signerName, const Name& dataName)
+{
+  if (m_certificateCache == nullptr || signerName.empty())
+    return;
+
+  shared_ptr<const IdentityCertificate> certificate = m_certificateCache->getCertificate(signerName);
+  if (certificate == nullptr && signerName.get(-1).isVersion())
+    certificate = m_certificateCache->getCertificate(signerName.getPrefix(-1));
+  if (certificate == nullptr)
+    return;
+
+  Signer& signer = m_signers[signerName];
+  if (signer.certificateName != certificate->getName()) {
+    signer.certificateName = certificate->getName();
+    signer.publicKey = certificate->getPublicKeyInfo();
+    signer.scopes.clear();
+    signer.dataNames.clear();
+  }
+  // the inner validator accepted the signer for this name only, its rules may not allow
+  // the signer for the other names of the namespace
+  signer.notAfter = std::min(certificate->getNotAfter(),
+                             time::system_clock::now() + m_signerLifetime);
+  if (signer.dataNames.size() >= std::max<size_t>(m_digestCapacity, 1))
+    signer.dataNames.clear();
+  signer.dataNames.insert(dataName);
+}
+
+void
+CachingValidator::addDigest(const std::string& digest)
+{
+  if (m_digestCapacity == 0 || m_digestIndex.count(digest) > 0)
+    return;
+
+  m_digests.push_front(digest);
+  m_digestIndex[digest] = m_digests.begin();
+  if (m_digests.size() > m_digestCapacity) {
+    m_digestIndex.erase(m_digests.back());
+    m_digests.pop_back();
+  }
+}
+
+void
+CachingValidator::verifyBatch(WorkerPool& workerPool, boost::asio::io_service& io)
+{
+  std::vector<Verification> batch;
+  batch.swap(m_pendingBatch);
+
+  // split the batch evenly across the workers
+  size_t chunkSize = (batch.size() + workerPool.size() - 1) / workerPool.size();
+  weak_ptr<bool> isAlive = m_isAlive;
+  boost::asio::io_service* ioService = &io;
+  for (size_t begin = 0; begin < batch.size(); begin += chunkSize) {
+    size_t end = std::min(begin + chunkSize, batch.size());
+    auto chunk = make_shared<std::vector<Verification>>(batch.begin() + begin,
+                                                        batch.begin() + end);
+    // keep the io_service running until the results are handed back
+    auto work = make_shared<boost::asio::io_service::work>(*ioService);
+
+    workerPool.post([this, chunk, isAlive, ioService, work] {
+        for (Verification& verification : *chunk)
+          verification.isValid = verifySignature(*verification.data, verification.publicKey);
+
+        ioService->post([this, chunk, isAlive] {
+            if (isAlive.expired())
+              return;
+            for (const Verification& verification : *chunk)
+              finishVerification(verification);
+          });
+      });
+  }
+}
+
+void
+CachingValidator::finishVerification(const Verification& verification)
+{
+  if (verification.isValid) {
+    addDigest(verification.digest);
+    verification.onValidated(verification.data);
+  }
+  else {
+    verification.onValidationFailed(verification.data,
+                                    "Cannot verify signature of " +
+                                    verification.data->getName().toUri());
+  }
+}
+
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_CACHING_VALIDATOR_HPP
+#define NDN_GEP_CACHING_VALIDATOR_HPP
+
+#include "worker-pool.hpp"
+
+#include <ndn-cxx/security/validator.hpp>
+#include <ndn-cxx/security/certificate-cache.hpp>
+#include <ndn-cxx/security/identity-certificate.hpp>
+
+namespace ndn {
+namespace gep {
+
+/**
+ * @brief Validator amortizing the validation of packets from the same signers
+ *
+ * The packets are validated by the inner validator the first time. Afterwards:
+ *  - a packet whose digest has been validated before is accepted directly, which avoids
+ *    verifying the same C-KEY or D-KEY packet again when it is retrieved once more;
+ *  - a packet signed by a known signer, with a name for which the inner validator has
+ *    accepted this signer before or under a scope given to addTrustedCertificate, is
+ *    accepted after its signature is verified against the cached public key, without
+ *    walking the certificate chain again.
+ *
+ * The signer is learnt for the exact names accepted by the inner validator only, because
+ * its rules may not allow the signer for the other names of the same namespace.
+ *
+ * The signers are learnt from @p certificateCache, which should be shared with the inner
+ * validator (e.g., the cache of ValidatorConfig), or added with addTrustedCertificate.
+ *
+ * If a worker pool is set, the signatures of known signers are verified in batches on
+ * the pool, and the validation callbacks are invoked on the io_service of the face.
+ */
+class CachingValidator : public Validator
+{
+public:
+  static const size_t DEFAULT_DIGEST_CAPACITY;
+  static const time::seconds DEFAULT_SIGNER_LIFETIME;
+
+public:
+  CachingValidator(unique_ptr<Validator> inner,
+                   shared_ptr<CertificateCache> certificateCache = nullptr,
+                   size_t digestCapacity = DEFAULT_DIGEST_CAPACITY,
+                   const time::seconds& signerLifetime = DEFAULT_SIGNER_LIFETIME);
+
+  ~CachingValidator();
+
+  /**
+   * @brief Trust the public key of @p certificate for the packets under @p scope
+   *
+   * The packets signed by @p certificate under @p scope are validated by their signature
+   * alone, until the certificate expires.
+   */
+  void
+  addTrustedCertificate(const IdentityCertificate& certificate, const Name& scope = Name());
+
+  /**
+   * @brief Verify the signatures of known signers on @p workerPool
+   *
+   * The validation callbacks are then invoked through @p ioService. Disable by setting a
+   * null pool.
+   */
+  void
+  setWorkerPool(const shared_ptr<WorkerPool>& workerPool, boost::asio::io_service& ioService);
+
+  /**
+   * @brief Forget all the validated digests and signers
+   */
+  void
+  resetCache();
+
+  /// @brief Get the number of packets accepted by their digest
+  size_t
+  getNDigestHits() const
+  {
+    return m_nDigestHits;
+  }
+
+  /// @brief Get the number of packets checked against the public key of a known signer
+  size_t
+  getNSignerHits() const
+  {
+    return m_nSignerHits;
+  }
+
+  /// @brief Get the number of packets validated by the inner validator
+  size_t
+  getNInnerValidations() const
+  {
+    return m_nInnerValidations;
+  }
+
+protected:
+  void
+  checkPolicy(const Data& data, int nSteps,
+              const OnDataValidated& onValidated,
+              const OnDataValidationFailed& onValidationFailed,
+              std::vector<shared_ptr<ValidationRequest>>& nextSteps) DECL_OVERRIDE;
+
+  void
+  checkPolicy(const Interest& interest, int nSteps,
+              const OnInterestValidated& onValidated,
+              const OnInterestValidationFailed& onValidationFailed,
+              std::vector<shared_ptr<ValidationRequest>>& nextSteps) DECL_OVERRIDE;
+
+private:
+  struct Signer
+  {
+    Name certificateName;
+    PublicKey publicKey;
+    time::system_clock::TimePoint notAfter;
+    // prefixes trusted through addTrustedCertificate
+    std::set<Name> scopes;
+    // names for which the inner validator accepted the signer, at most the digest capacity
+    std::set<Name> dataNames;
+  };
+
+  struct Verification
+  {
+    shared_ptr<const Data> data;
+    PublicKey publicKey;
+    std::string digest;
+    OnDataValidated onValidated;
+    OnDataValidationFailed onValidationFailed;
+    bool isValid;
+  };
+
+  static std::string
+  getDigest(const Data& data);
+
+  static Name
+  getSignerName(const Data& data);
+
+  const Signer*
+  findSigner(const Name& signerName, const Name& dataName);
+
+  void
+  learnSigner(const Name& signerName, const Name& dataName);
+
+  void
+  addDigest(const std::string& digest);
+
+  /// @brief Verify the pending batch on @p workerPool, then finish it through @p io
+  void
+  verifyBatch(WorkerPool& workerPool, boost::asio::io_service& io);
+
+  void
+  finishVerification(const Verification& verification);
+
+private:
+  unique_ptr<Validator> m_inner;
+  shared_ptr<CertificateCache> m_certificateCache;
+  size_t m_digestCapacity;
+  time::seconds m_signerLifetime;
+
+  // validated digests, the most recent first
+  std::list<std::string> m_digests;
+  std::unordered_map<std::string, std::list<std::string>::iterator> m_digestIndex;
+  std::map<Name, Signer> m_signers;
+
+  shared_ptr<WorkerPool> m_workerPool;
+  boost::asio::io_service* m_ioService;
+  std::vector<Verification> m_pendingBatch;
+  // expires when the validator is destroyed, so that late results are dropped
+  shared_ptr<bool> m_isAlive;
+
+  size_t m_nDigestHits;
+  size_t m_nSignerHits;
+  size_t m_nInnerValidations;
+};
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_CACHING_VALIDATOR_HPP
@@ -109,6 +109,7 @@ const ndn::name::Component NAME_COMPONENT_SAMPLE("SAMPLE");
 const ndn::name::Component NAME_COMPONENT_ACCESS("ACCESS");
 const ndn::name::Component NAME_COMPONENT_E_KEY("E-KEY");
 const ndn::name::Component NAME_COMPONENT_D_KEY("D-KEY");
+const ndn::name::Component NAME_COMPONENT_D_KEY_BUNDLE("D-KEY-BUNDLE");
 const ndn::name::Component NAME_COMPONENT_C_KEY("C-KEY");
 
 } // namespace gep
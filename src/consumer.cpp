@@ -22,12 +22,24 @@
 
 #include "consumer.hpp"
 #include "encrypted-content.hpp"
+#include "span-tracer.hpp"
+#include "algo/compression.hpp"
+#include "algo/error.hpp"
+
+#include <future>
+#include <thread>
 
 namespace ndn {
 namespace gep {
 
 const Link Consumer::NO_LINK = Link();
 
+// minimum number of contents for which decrypting on another thread pays off
+static const size_t MIN_BATCH_SIZE = 64;
+
+// delay before the first retry of a failed prefetch, doubled at each retry
+static const time::seconds PREFETCH_RETRY_DELAY(1);
+
 // public
 Consumer::Consumer(Face& face,
                    const Name& groupName, const Name& consumerName,
@@ -41,6 +53,13 @@ Consumer::Consumer(Face& face,
   , m_consumerName(consumerName)
   , m_cKeyLink(cKeyLink)
   , m_dKeyLink(dKeyLink)
+  , m_timestampNaming(TimestampNaming::Iso)
+  , m_delegationRacer(face)
+  , m_interestPacing(time::milliseconds(100))
+  , m_maxSegments(4096)
+  , m_isPrefetchEnabled(false)
+  , m_prefetchLeadTime(time::milliseconds::zero())
+  , m_scheduler(face.getIoService())
 {
 }
 
@@ -58,36 +77,373 @@ Consumer::addDecryptionKey(const Name& keyName, const Buffer& keyBuf)
   m_db.addKey(keyName, keyBuf);
 }
 
+void
+Consumer::fetchDKeyBundle(const TimeStamp& from, const TimeStamp& to,
+                          const function<void (size_t)>& callback,
+                          const ErrorCallBack& errorCallback)
+{
+  // D-KEY bundle name convention:
+  // /<group_name>/D-KEY-BUNDLE/[from-ts]/[to-ts]/FOR/[consumer-name]/[segment]
+  Name interestName = m_groupName;
+  interestName.append(NAME_COMPONENT_D_KEY_BUNDLE)
+    .append(encodeTimestamp(from, m_timestampNaming))
+    .append(encodeTimestamp(to, m_timestampNaming))
+    .append(NAME_COMPONENT_FOR).append(m_consumerName);
+  shared_ptr<Interest> interest = make_shared<Interest>(interestName);
+
+  struct BundleFetchState
+  {
+    uint64_t nSegments = 0;
+    uint64_t nDecrypted = 0;
+    size_t nDKeys = 0;
+    bool hasFailed = false;
+  };
+  auto state = make_shared<BundleFetchState>();
+
+  // report only the first error of the retrieval
+  ErrorCallBack onError = [=] (const ErrorCode& code, const std::string& msg) {
+    if (state->hasFailed)
+      return;
+    state->hasFailed = true;
+    errorCallback(code, msg);
+  };
+
+  // each segment of the bundle is decrypted on its own
+  auto onSegment = [=] (const shared_ptr<const Data>& validSegment) {
+    decryptDKeyBundle(*validSegment,
+                      [=] (size_t nDKeys) {
+                        if (state->hasFailed)
+                          return;
+                        state->nDKeys += nDKeys;
+                        if (++state->nDecrypted == state->nSegments)
+                          callback(state->nDKeys);
+                      },
+                      onError);
+  };
+
+  // the first segment received tells the number of segments and the name of the others
+  auto validationCallback =
+    [=] (const shared_ptr<const Data>& validBundleData) {
+    const Name& bundleName = validBundleData->getName();
+    const name::Component& finalBlockId = validBundleData->getFinalBlockId();
+    if (bundleName.empty() || !bundleName[-1].isSegment() || finalBlockId.empty()) {
+      state->nSegments = 1;
+      onSegment(validBundleData);
+      return;
+    }
+
+    uint64_t segmentNo = 0;
+    try {
+      segmentNo = bundleName[-1].toSegment();
+      state->nSegments = finalBlockId.toSegment() + 1;
+    }
+    catch (const tlv::Error& e) {
+      onError(ErrorCode::InvalidEncryptedFormat, e.what());
+      return;
+    }
+    if (state->nSegments > m_maxSegments || state->nSegments == 0 ||
+        segmentNo >= state->nSegments) {
+      onError(ErrorCode::InvalidEncryptedFormat, "Too many segments: " + bundleName.toUri());
+      return;
+    }
+
+    onSegment(validBundleData);
+    for (uint64_t i = 0; i < state->nSegments; i++) {
+      if (i != segmentNo)
+        sendInterest(Interest(bundleName.getPrefix(-1).appendSegment(i)), 1, m_dKeyLink, 0,
+                     onSegment, onError);
+    }
+  };
+  sendInterest(*interest, 1, m_dKeyLink, 0, validationCallback, onError);
+}
+
+void
+Consumer::setValidator(unique_ptr<Validator> validator)
+{
+  BOOST_ASSERT(validator != nullptr);
+  m_validator = std::move(validator);
+}
+
+void
+Consumer::setLocalKeyRegistry(const shared_ptr<LocalKeyRegistry>& localKeys)
+{
+  m_localKeys = localKeys;
+}
+
+void
+Consumer::setTraceRecorder(const shared_ptr<TraceRecorder>& traceRecorder)
+{
+  m_trace = traceRecorder;
+}
+
+void
+Consumer::setTimestampNaming(TimestampNaming naming)
+{
+  m_timestampNaming = naming;
+}
+
+Future<size_t>
+Consumer::fetchDKeyBundleAsync(const TimeStamp& from, const TimeStamp& to)
+{
+  Promise<size_t> promise;
+  fetchDKeyBundle(from, to,
+                  [=] (size_t nDKeys) { promise.setValue(nDKeys); },
+                  [=] (const ErrorCode& code, const std::string& msg) {
+                    promise.setError(code, msg);
+                  });
+  return promise.getFuture();
+}
+
+void
+Consumer::enablePrefetch(const time::milliseconds& leadTime, const ErrorCallBack& errorCallback)
+{
+  m_isPrefetchEnabled = true;
+  m_prefetchLeadTime = leadTime;
+  m_prefetchErrorCallback = errorCallback;
+}
+
+void
+Consumer::disablePrefetch()
+{
+  m_isPrefetchEnabled = false;
+  m_prefetches.clear();
+  m_scheduler.cancelAllEvents();
+}
+
+void
+Consumer::setDelegationFanout(size_t fanout)
+{
+  m_delegationRacer.setFanout(fanout);
+}
+
+void
+Consumer::setInterestPacing(const time::milliseconds& interval)
+{
+  m_interestPacing = interval;
+}
+
+void
+Consumer::setMaxSegments(uint64_t maxSegments)
+{
+  m_maxSegments = maxSegments;
+}
+
 void
 Consumer::consume(const Name& contentName,
                   const ConsumptionCallBack& consumptionCallBack,
                   const ErrorCallBack& errorCallback,
-                  const Link delegations)
+                  const Link& delegations)
 {
   shared_ptr<Interest> interest = make_shared<Interest>(contentName);
 
+  ConsumptionCallBack onConsumed = consumptionCallBack;
+  ErrorCallBack onError = errorCallback;
+  if (m_trace != nullptr) {
+    m_trace->record(trace::Consume, contentName, m_consumerName);
+    shared_ptr<TraceRecorder> traceRecorder = m_trace;
+    Name consumerName = m_consumerName;
+    onConsumed = [=] (const Data& data, const Buffer& plainText) {
+      traceRecorder->record(trace::Consumed, contentName, consumerName,
+                            time::system_clock::TimePoint(), plainText.size());
+      consumptionCallBack(data, plainText);
+    };
+    onError = [=] (const ErrorCode& code, const std::string& msg) {
+      traceRecorder->record(trace::ConsumeError, contentName, consumerName,
+                            time::system_clock::TimePoint(), static_cast<uint64_t>(code));
+      errorCallback(code, msg);
+    };
+  }
+
+  NDN_GEP_ASYNC_ID(spanId);
+  NDN_GEP_ASYNC_BEGIN("consume", spanId, contentName.toUri());
+  // the callbacks are wrapped only while tracing, spanId is always 0 otherwise
+  if (spanId != 0) {
+    ConsumptionCallBack onTracedConsumed = onConsumed;
+    ErrorCallBack onTracedError = onError;
+    onConsumed = [=] (const Data& data, const Buffer& plainText) {
+      NDN_GEP_ASYNC_END("consume", spanId, "");
+      onTracedConsumed(data, plainText);
+    };
+    onError = [=] (const ErrorCode& code, const std::string& msg) {
+      NDN_GEP_ASYNC_END("consume", spanId, msg);
+      onTracedError(code, msg);
+    };
+  }
+
   // prepare callback functions
   auto validationCallback =
     [=] (const shared_ptr<const Data>& validData) {
       // decrypt content
       decryptContent(*validData,
-                     [=] (const Buffer& plainText) {consumptionCallBack(*validData, plainText);},
+                     [=] (const Buffer& plainText) {onConsumed(*validData, plainText);},
+                     onError);
+  };
+
+  sendInterest(*interest, 1, delegations, 0, validationCallback, onError);
+}
+
+void
+Consumer::consumeSegments(const Name& dataName,
+                          const function<void (const Buffer&)>& consumptionCallBack,
+                          const ErrorCallBack& errorCallback,
+                          size_t window,
+                          const Link& delegations)
+{
+  BOOST_ASSERT(window > 0);
+
+  struct SegmentFetchState
+  {
+    std::vector<Data> segments;
+    uint64_t nextSegmentNo = 1;
+    uint64_t nReceived = 0;
+    bool hasFailed = false;
+  };
+  auto state = make_shared<SegmentFetchState>();
+
+  // report only the first error of the retrieval
+  ErrorCallBack onError = [=] (const ErrorCode& code, const std::string& msg) {
+    if (state->hasFailed)
+      return;
+    state->hasFailed = true;
+    errorCallback(code, msg);
+  };
+
+  // only the callbacks of the pending interests keep fetchSegment alive, so it is released
+  // once the retrieval succeeds or fails
+  auto fetchSegment = make_shared<function<void (uint64_t)>>();
+  weak_ptr<function<void (uint64_t)>> weakFetchSegment = fetchSegment;
+  *fetchSegment = [=] (uint64_t segmentNo) {
+    shared_ptr<function<void (uint64_t)>> fetchNext = weakFetchSegment.lock();
+    Interest interest(Name(dataName).appendSegment(segmentNo));
+    sendInterest(interest, 1, delegations, 0,
+                 [=] (const shared_ptr<const Data>& validData) {
+                   if (state->hasFailed)
+                     return;
+
+                   state->segments[segmentNo] = *validData;
+                   state->nReceived++;
+                   if (state->nextSegmentNo < state->segments.size()) {
+                     (*fetchNext)(state->nextSegmentNo++);
+                   }
+                   else if (state->nReceived == state->segments.size()) {
+                     decryptSegments(state->segments, consumptionCallBack, onError);
+                   }
+                 },
+                 onError);
+  };
+
+  // the segment 0 tells the number of segments
+  Interest interest(Name(dataName).appendSegment(0));
+  sendInterest(interest, 1, delegations, 0,
+               [=] (const shared_ptr<const Data>& validData) {
+                 uint64_t nSegments = 1;
+                 const name::Component& finalBlockId = validData->getFinalBlockId();
+                 if (!finalBlockId.empty()) {
+                   try {
+                     nSegments = finalBlockId.toSegment() + 1;
+                   }
+                   catch (const tlv::Error& e) {
+                     onError(ErrorCode::InvalidEncryptedFormat, e.what());
+                     return;
+                   }
+                 }
+                 if (nSegments > m_maxSegments || nSegments == 0) {
+                   onError(ErrorCode::InvalidEncryptedFormat,
+                           "Too many segments: " + validData->getName().toUri());
+                   return;
+                 }
+
+                 state->segments.resize(nSegments);
+                 state->segments[0] = *validData;
+                 state->nReceived = 1;
+                 if (nSegments == 1) {
+                   decryptSegments(state->segments, consumptionCallBack, onError);
+                   return;
+                 }
+
+                 while (state->nextSegmentNo < nSegments && state->nextSegmentNo <= window)
+                   (*fetchSegment)(state->nextSegmentNo++);
+               },
+               onError);
+}
+
+Future<ConsumedData>
+Consumer::consumeAsync(const Name& contentName, const Link& delegations)
+{
+  Promise<ConsumedData> promise;
+  shared_ptr<Interest> interest = make_shared<Interest>(contentName);
+  shared_ptr<TraceRecorder> traceRecorder = m_trace;
+  Name consumerName = m_consumerName;
+  if (traceRecorder != nullptr)
+    traceRecorder->record(trace::Consume, contentName, consumerName);
+  NDN_GEP_ASYNC_ID(spanId);
+  NDN_GEP_ASYNC_BEGIN("consume", spanId, contentName.toUri());
+
+  // the callbacks of all retrieval steps share the promise instead of copying each other
+  ErrorCallBack errorCallback = [=] (const ErrorCode& code, const std::string& msg) {
+    if (traceRecorder != nullptr)
+      traceRecorder->record(trace::ConsumeError, contentName, consumerName,
+                            time::system_clock::TimePoint(), static_cast<uint64_t>(code));
+    NDN_GEP_ASYNC_END("consume", spanId, msg);
+    promise.setError(code, msg);
+  };
+  auto validationCallback =
+    [=] (const shared_ptr<const Data>& validData) {
+      decryptContent(*validData,
+                     [=] (const Buffer& plainText) {
+                       if (traceRecorder != nullptr)
+                         traceRecorder->record(trace::Consumed, contentName, consumerName,
+                                               time::system_clock::TimePoint(),
+                                               plainText.size());
+                       NDN_GEP_ASYNC_END("consume", spanId, "");
+                       promise.setValue(std::make_pair(*validData, plainText));
+                     },
                      errorCallback);
   };
 
   sendInterest(*interest, 1, delegations, 0, validationCallback, errorCallback);
+  return promise.getFuture();
 }
 
 // private
 
+/**
+ * @brief Decompress @p content in place if @p compression is not CompressionNone
+ *
+ * @return false, after invoking @p errorCallback, when @p content cannot be decompressed
+ */
+static bool
+decompress(tlv::CompressionTypeValue compression, Buffer& content,
+           const ErrorCallBack& errorCallback)
+{
+  if (compression == tlv::CompressionNone)
+    return true;
+
+  if (!algo::Compression::isSupported(compression)) {
+    errorCallback(ErrorCode::UnsupportedEncryptionScheme,
+                  "Unsupported compression: " + std::to_string(compression));
+    return false;
+  }
+  try {
+    content = algo::Compression::decompress(compression, content.buf(), content.size());
+  }
+  catch (const algo::Error& e) {
+    errorCallback(ErrorCode::InvalidEncryptedFormat, e.what());
+    return false;
+  }
+  return true;
+}
+
 void
 Consumer::decrypt(const Block& encryptedBlock,
                   const Buffer& keyBits,
                   const PlainTextCallBack& plainTextCallBack,
                   const ErrorCallBack& errorCallback)
 {
+  NDN_GEP_SPAN(span, "decrypt");
   EncryptedContent encryptedContent(encryptedBlock);
   const Buffer& payload = encryptedContent.getPayload();
+  NDN_GEP_SPAN_DETAIL(span, std::to_string(encryptedContent.getAlgorithmType()));
 
   switch (encryptedContent.getAlgorithmType()) {
     case tlv::AlgorithmAesCbc: {
@@ -100,6 +456,10 @@ Consumer::decrypt(const Block& encryptedBlock,
       Buffer content = algo::Aes::decrypt(keyBits.buf(), keyBits.size(),
                                           payload.buf(), payload.size(),
                                           decryptParams);
+
+      // decompress content
+      if (!decompress(encryptedContent.getCompressionAlgorithm(), content, errorCallback))
+        return;
       plainTextCallBack(content);
       break;
     }
@@ -133,28 +493,244 @@ Consumer::decryptContent(const Data& data,
   // check if content key already in store
   auto it = m_cKeyMap.find(cKeyName);
 
+  NDN_GEP_SPAN(span, "decryptContent");
   if (it != m_cKeyMap.end()) { // decrypt content directly
+    NDN_GEP_SPAN_DETAIL(span, "C-KEY hit");
     decrypt(encryptedContent, it->second, plainTextCallBack, errorCallback);
   }
   else {
+    NDN_GEP_SPAN_DETAIL(span, "C-KEY miss");
     // retrieve the C-Key Data from network
-    Name interestName = cKeyName;
-    interestName.append(NAME_COMPONENT_FOR).append(m_groupName);
-    shared_ptr<Interest> interest = make_shared<Interest>(interestName);
+    fetchCKey(cKeyName,
+              [=] (const Buffer& cKeyBits) {
+                decrypt(encryptedContent, cKeyBits, plainTextCallBack, errorCallback);
+              },
+              errorCallback);
+  }
 
-    // prepare callback functions
-    auto validationCallback =
-      [=] (const shared_ptr<const Data>& validCKeyData) {
-      // decrypt content
-      decryptCKey(*validCKeyData,
-                  [=] (const Buffer& cKeyBits) {
-                    decrypt(encryptedContent, cKeyBits, plainTextCallBack, errorCallback);
-                    this->m_cKeyMap.insert(std::make_pair(cKeyName, cKeyBits));
-                  },
-                  errorCallback);
+  if (m_isPrefetchEnabled)
+    schedulePrefetch(cKeyName);
+}
+
+void
+Consumer::decryptSegments(const std::vector<Data>& segments,
+                          const PlainTextCallBack& plainTextCallBack,
+                          const ErrorCallBack& errorCallback)
+{
+  decryptContentBatch(segments,
+                      [=] (const std::vector<Buffer>& payloads) {
+                        size_t totalSize = 0;
+                        for (const auto& payload : payloads)
+                          totalSize += payload.size();
+
+                        Buffer content;
+                        content.reserve(totalSize);
+                        for (const auto& payload : payloads)
+                          content.insert(content.end(), payload.begin(), payload.end());
+                        plainTextCallBack(content);
+                      },
+                      errorCallback);
+}
+
+void
+Consumer::decryptContentBatch(const std::vector<Data>& dataList,
+                              const function<void (const std::vector<Buffer>&)>& callback,
+                              const ErrorCallBack& errorCallback)
+{
+  std::vector<Block> encryptedBlocks;
+  encryptedBlocks.reserve(dataList.size());
+  // C-KEY name => indexes of the contents encrypted with it
+  std::map<Name, std::vector<size_t>> batches;
+  for (const auto& data : dataList) {
+    encryptedBlocks.push_back(data.getContent().blockFromValue());
+    Name cKeyName = EncryptedContent(encryptedBlocks.back()).getKeyLocator().getName();
+    batches[cKeyName].push_back(encryptedBlocks.size() - 1);
+  }
+
+  // retrieve the missing C-KEYs one by one, then start over
+  for (const auto& batch : batches) {
+    if (m_cKeyMap.find(batch.first) == m_cKeyMap.end()) {
+      fetchCKey(batch.first,
+                [=] (const Buffer&) { decryptContentBatch(dataList, callback, errorCallback); },
+                errorCallback);
+      return;
+    }
+  }
+
+  std::vector<Buffer> payloads(dataList.size());
+  bool hasFailed = false;
+  ErrorCallBack onError = [&] (const ErrorCode& code, const std::string& msg) {
+    if (!hasFailed)
+      errorCallback(code, msg);
+    hasFailed = true;
+  };
+
+  for (const auto& batch : batches) {
+    const Buffer& cKeyBits = m_cKeyMap[batch.first];
+
+    // contents not encrypted with AES-CBC are decrypted one by one
+    std::vector<size_t> indexes;
+    for (size_t index : batch.second) {
+      if (EncryptedContent(encryptedBlocks[index]).getAlgorithmType() == tlv::AlgorithmAesCbc)
+        indexes.push_back(index);
+      else
+        decrypt(encryptedBlocks[index], cKeyBits,
+                [&] (const Buffer& payload) { payloads[index] = payload; },
+                onError);
+    }
+    if (indexes.empty())
+      continue;
+
+    // large batches are split into contiguous ranges decrypted on several threads
+    size_t nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    nThreads = std::min(nThreads, (indexes.size() + MIN_BATCH_SIZE - 1) / MIN_BATCH_SIZE);
+    size_t rangeSize = (indexes.size() + nThreads - 1) / nThreads;
+
+    auto decryptRange = [&] (size_t begin, size_t end) {
+      std::vector<EncryptedContent> contents;
+      std::vector<algo::Aes::CbcPayload> cbcPayloads;
+      contents.reserve(end - begin);
+      for (size_t i = begin; i < end; i++) {
+        contents.push_back(EncryptedContent(encryptedBlocks[indexes[i]]));
+        const EncryptedContent& content = contents.back();
+        if (content.getInitialVector().size() != 16)
+          BOOST_THROW_EXCEPTION(algo::Error("incorrect initial vector size"));
+        cbcPayloads.push_back({content.getInitialVector().buf(),
+                               content.getPayload().buf(),
+                               content.getPayload().size()});
+      }
+
+      std::vector<Buffer> results = algo::Aes::decryptBatch(cKeyBits.buf(), cKeyBits.size(),
+                                                            cbcPayloads);
+      for (size_t i = begin; i < end; i++)
+        payloads[indexes[i]] = std::move(results[i - begin]);
     };
-    sendInterest(*interest, 1, m_cKeyLink, 0, validationCallback, errorCallback);
+
+    std::vector<std::future<void>> workers;
+    for (size_t begin = 0; begin < indexes.size(); begin += rangeSize) {
+      workers.push_back(std::async(nThreads > 1 ? std::launch::async : std::launch::deferred,
+                                   decryptRange, begin,
+                                   std::min(begin + rangeSize, indexes.size())));
+    }
+    for (auto& worker : workers) {
+      try {
+        worker.get();
+      }
+      catch (const std::exception& e) {
+        onError(ErrorCode::InvalidEncryptedFormat, e.what());
+      }
+    }
+
+    if (hasFailed)
+      return;
+
+    for (size_t index : indexes) {
+      EncryptedContent content(encryptedBlocks[index]);
+      if (!decompress(content.getCompressionAlgorithm(), payloads[index], onError))
+        return;
+    }
+
+    if (m_isPrefetchEnabled)
+      schedulePrefetch(batch.first);
+  }
+
+  if (!hasFailed)
+    callback(payloads);
+}
+
+void
+Consumer::fetchCKey(const Name& cKeyName,
+                    const PlainTextCallBack& plainTextCallBack,
+                    const ErrorCallBack& errorCallback)
+{
+  // get the C-KEY directly from the producer in the same process if possible
+  Buffer cKeyBits;
+  if (m_localKeys != nullptr && m_localKeys->getCKey(cKeyName, m_consumerName, cKeyBits)) {
+    m_cKeyMap.insert(std::make_pair(cKeyName, cKeyBits));
+    plainTextCallBack(cKeyBits);
+    return;
+  }
+
+  if (m_trace != nullptr)
+    m_trace->record(trace::CKeyRequest, cKeyName, m_consumerName);
+
+  Name interestName = cKeyName;
+  interestName.append(NAME_COMPONENT_FOR).append(m_groupName);
+  shared_ptr<Interest> interest = make_shared<Interest>(interestName);
+
+  // prepare callback functions
+  auto validationCallback =
+    [=] (const shared_ptr<const Data>& validCKeyData) {
+    // decrypt content
+    decryptCKey(*validCKeyData,
+                [=] (const Buffer& cKeyBits) {
+                  this->m_cKeyMap.insert(std::make_pair(cKeyName, cKeyBits));
+                  plainTextCallBack(cKeyBits);
+                },
+                errorCallback);
+  };
+  sendInterest(*interest, 1, m_cKeyLink, 0, validationCallback, errorCallback);
+}
+
+void
+Consumer::schedulePrefetch(const Name& cKeyName)
+{
+  // C-KEY name convention: /<prefix>/SAMPLE/<data_type>/C-KEY/[hour]
+  time::system_clock::TimePoint hourSlot;
+  try {
+    hourSlot = decodeTimestamp(cKeyName.get(-1));
+  }
+  catch (const std::exception&) {
+    // the C-KEY is not named by hour, so the next one cannot be predicted
+    return;
   }
+
+  Name cKeyPrefix = cKeyName.getPrefix(-1);
+  time::system_clock::TimePoint nextHourSlot = hourSlot + time::hours(1);
+  auto it = m_prefetches.find(cKeyPrefix);
+  if (it != m_prefetches.end() && it->second >= nextHourSlot)
+    return;
+
+  Name nextCKeyName = cKeyPrefix;
+  // the producer names the next C-KEY the same way
+  nextCKeyName.append(encodeTimestamp(nextHourSlot, getTimestampNaming(cKeyName.get(-1))));
+  m_prefetches[cKeyPrefix] = nextHourSlot;
+  if (m_cKeyMap.find(nextCKeyName) != m_cKeyMap.end())
+    return;
+
+  time::nanoseconds delay = nextHourSlot - m_prefetchLeadTime - time::system_clock::now();
+  if (delay < time::nanoseconds::zero())
+    delay = time::nanoseconds::zero();
+
+  m_scheduler.scheduleEvent(delay, [=] {
+      prefetchCKey(nextCKeyName, nextHourSlot, PREFETCH_RETRY_DELAY);
+    });
+}
+
+void
+Consumer::prefetchCKey(const Name& cKeyName, const time::system_clock::TimePoint& boundary,
+                       const time::nanoseconds& retryDelay)
+{
+  if (m_cKeyMap.find(cKeyName) != m_cKeyMap.end())
+    return;
+
+  // decrypting the C-KEY retrieves the D-KEY it is encrypted for, if it is not known yet
+  fetchCKey(cKeyName, [] (const Buffer&) {},
+            [=] (const ErrorCode& code, const std::string& msg) {
+              bool isRetriable = code == ErrorCode::Timeout ||
+                                 code == ErrorCode::DataRetrievalFailure;
+              if (isRetriable && m_isPrefetchEnabled &&
+                  time::system_clock::now() + retryDelay < boundary) {
+                // the producer may not have created the C-KEY yet
+                m_scheduler.scheduleEvent(retryDelay, [=] {
+                    prefetchCKey(cKeyName, boundary, retryDelay * 2);
+                  });
+                return;
+              }
+
+              if (m_prefetchErrorCallback)
+                m_prefetchErrorCallback(code, msg);
+            });
 }
 
 void
@@ -171,11 +747,24 @@ Consumer::decryptCKey(const Data& cKeyData,
   // check if decryption key already in store
   auto it = m_dKeyMap.find(dKeyName);
 
+  NDN_GEP_SPAN(span, "decryptCKey");
+  Buffer dKeyBits;
   if (it != m_dKeyMap.end()) { // decrypt C-Key directly
+    NDN_GEP_SPAN_DETAIL(span, "D-KEY hit");
     decrypt(cKeyContent, it->second, plainTextCallBack, errorCallback);
   }
+  else if (m_localKeys != nullptr && m_localKeys->getDKey(dKeyName, m_consumerName, dKeyBits)) {
+    // get the D-Key directly from the group manager in the same process
+    NDN_GEP_SPAN_DETAIL(span, "D-KEY local");
+    m_dKeyMap.insert(std::make_pair(dKeyName, dKeyBits));
+    decrypt(cKeyContent, dKeyBits, plainTextCallBack, errorCallback);
+  }
   else {
     // get the D-Key Data
+    NDN_GEP_SPAN_DETAIL(span, "D-KEY miss");
+    if (m_trace != nullptr)
+      m_trace->record(trace::DKeyRequest, dKeyName, m_consumerName);
+
     Name interestName = dKeyName;
     interestName.append(NAME_COMPONENT_FOR).append(m_consumerName);
 
@@ -202,6 +791,7 @@ Consumer::decryptDKey(const Data& dKeyData,
                       const PlainTextCallBack& plainTextCallBack,
                       const ErrorCallBack& errorCallback)
 {
+  NDN_GEP_SPAN(span, "decryptDKey");
   // get encrypted content
   Block dataContent = dKeyData.getContent();
   dataContent.parse();
@@ -236,6 +826,45 @@ Consumer::decryptDKey(const Data& dKeyData,
           errorCallback);
 }
 
+void
+Consumer::decryptDKeyBundle(const Data& bundleData,
+                            const function<void (size_t)>& callback,
+                            const ErrorCallBack& errorCallback)
+{
+  // the bundle is encrypted in the same way as a D-KEY
+  decryptDKey(bundleData,
+              [=] (const Buffer& bundleBits) {
+                std::list<std::pair<Name, Buffer>> dKeys;
+                try {
+                  Block bundle(bundleBits.buf(), bundleBits.size());
+                  if (bundle.type() != tlv::DKeyBundle)
+                    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV type when decoding D-KEY bundle"));
+                  bundle.parse();
+
+                  for (const Block& entry : bundle.elements()) {
+                    if (entry.type() != tlv::DKeyEntry)
+                      continue;
+                    entry.parse();
+
+                    Name dKeyName(entry.get(tlv::Name));
+                    const Block& dKeyBits = entry.get(tlv::DKeyBits);
+                    dKeys.push_back(std::make_pair(dKeyName, Buffer(dKeyBits.value(),
+                                                                    dKeyBits.value_size())));
+                  }
+                }
+                catch (const tlv::Error& e) {
+                  errorCallback(ErrorCode::InvalidEncryptedFormat,
+                                "Data packet does not satisfy D-KEY bundle format");
+                  return;
+                }
+
+                for (const auto& dKey : dKeys)
+                  this->m_dKeyMap[dKey.first] = dKey.second;
+                callback(dKeys.size());
+              },
+              errorCallback);
+}
+
 const Buffer
 Consumer::getDecryptionKey(const Name& decryptionKeyName)
 {
@@ -246,20 +875,37 @@ void
 Consumer::sendInterest(const Interest& interest, int nRetrials,
                        const Link& delegations, size_t delegationIndex,
                        const OnDataValidated& validationCallback,
-                       const ErrorCallBack& errorCallback)
+                       const ErrorCallBack& errorCallback,
+                       bool isRetransmission)
 {
+  Name measurementPrefix = RttEstimator::getMeasurementPrefix(interest.getName());
+  Interest newInterest(interest);
+  if (!isRetransmission)
+    newInterest.setInterestLifetime(m_rttEstimator.getRto(measurementPrefix));
+
+  // the segments after segment 0 are fetched in a window, and are not paced
+  const Name& interestName = interest.getName();
+  bool isWindowed = !interestName.empty() && interestName[-1].isSegment() &&
+                    interestName[-1].toSegment() > 0;
+  if (m_interestPacing > time::milliseconds::zero() && !isWindowed)
+    std::this_thread::sleep_for(std::chrono::milliseconds(m_interestPacing.count()));
+
+  time::steady_clock::TimePoint sendTime = time::steady_clock::now();
   auto dataCallback = [=] (const Interest& contentInterest, const Data& contentData) {
     if (!contentInterest.matchesData(contentData))
       return;
 
+    // only measure RTT of interests which are not retransmitted
+    if (!isRetransmission)
+      m_rttEstimator.addMeasurement(measurementPrefix, time::steady_clock::now() - sendTime);
+
     this->m_validator->validate(contentData, validationCallback,
                                 [=] (const shared_ptr<const Data>& d, const std::string& e) {
                                   errorCallback(ErrorCode::Validation, e);
                                 });
   };
 
-  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-  m_face.expressInterest(interest, dataCallback,
+  m_face.expressInterest(newInterest, dataCallback,
                          std::bind(&Consumer::handleNack, this, _1, _2,
                                    delegations, delegationIndex, validationCallback, errorCallback),
                          std::bind(&Consumer::handleTimeout, this, _1, nRetrials,
@@ -271,8 +917,29 @@ Consumer::handleNack(const Interest& interest, const lp::Nack& nack,
                      const Link& delegations, size_t delegationIndex,
                      const OnDataValidated& callback, const ErrorCallBack& errorCallback)
 {
+  NDN_GEP_INSTANT("nack", interest.getName().toUri());
   if (!delegations.getDelegations().empty()) {
-    if (!interest.hasSelectedDelegation()) {
+    if (!interest.hasSelectedDelegation() && m_delegationRacer.getFanout() > 1) {
+      // race the best delegations of the link, report failure if all of them fail.
+      auto dataCallback = [=] (const Interest& contentInterest, const Data& contentData) {
+        if (!contentInterest.matchesData(contentData)) {
+          errorCallback(ErrorCode::DataRetrievalFailure, contentInterest.getName().toUri());
+          return;
+        }
+
+        this->m_validator->validate(contentData, callback,
+                                    [=] (const shared_ptr<const Data>& d, const std::string& e) {
+                                      errorCallback(ErrorCode::Validation, e);
+                                    });
+      };
+      Name interestName = interest.getName();
+      m_delegationRacer.fetch(interest, delegations, dataCallback,
+                              [=] {
+                                errorCallback(ErrorCode::DataRetrievalFailure, interestName.toUri());
+                              });
+      return;
+    }
+    else if (!interest.hasSelectedDelegation()) {
       // if link is not used in first interest, use it now.
       Interest newInterest(interest);
       newInterest.setLink(delegations.wireEncode());
@@ -301,8 +968,17 @@ Consumer::handleTimeout(const Interest& interest, int nRetrials,
                         const Link& delegations, size_t delegationIndex,
                         const OnDataValidated& callback, const ErrorCallBack& errorCallback)
 {
-  if (nRetrials > 0)
-    sendInterest(interest, nRetrials - 1, delegations, delegationIndex, callback, errorCallback);
+  Name measurementPrefix = RttEstimator::getMeasurementPrefix(interest.getName());
+  m_rttEstimator.addTimeout(measurementPrefix);
+  NDN_GEP_INSTANT("timeout", interest.getName().toUri());
+
+  if (nRetrials > 0) {
+    Interest newInterest(interest);
+    newInterest.setInterestLifetime(m_rttEstimator.backoff(measurementPrefix,
+                                                           interest.getInterestLifetime()));
+    sendInterest(newInterest, nRetrials - 1, delegations, delegationIndex,
+                 callback, errorCallback, true);
+  }
   else
     handleNack(interest, lp::Nack(), delegations, delegationIndex, callback, errorCallback);
 }
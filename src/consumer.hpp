@@ -26,16 +26,27 @@
 #include "algo/rsa.hpp"
 #include "algo/aes.hpp"
 #include "consumer-db.hpp"
+#include "local-key-registry.hpp"
+#include "trace-recorder.hpp"
+#include "interval.hpp"
+#include "rtt-estimator.hpp"
+#include "delegation-racer.hpp"
 #include "error-code.hpp"
+#include "future.hpp"
+#include "timestamp-name.hpp"
 
 #include <ndn-cxx/security/validator-null.hpp>
 #include <ndn-cxx/face.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
 
 namespace ndn {
 namespace gep {
 
 typedef function<void (const Data&, const Buffer&)> ConsumptionCallBack;
 
+// @brief Content Data and its decrypted payload
+typedef std::pair<Data, Buffer> ConsumedData;
+
 /**
  * @brief Consumer in group-based encryption protocol
  */
@@ -70,7 +81,51 @@ public:
   consume(const Name& dataName,
           const ConsumptionCallBack& consumptionCallBack,
           const ErrorCallBack& errorCallback,
-          const Link delegations = NO_LINK);
+          const Link& delegations = NO_LINK);
+
+  /**
+   * @brief Retrieve and decrypt content packet with @p dataName.
+   *
+   * @param dataName The name of data to retrieve
+   * @param delegations The link object for data retrieval
+   * @return The future of the content packet and its decrypted payload
+   */
+  Future<ConsumedData>
+  consumeAsync(const Name& dataName, const Link& delegations = NO_LINK);
+
+  /**
+   * @brief Retrieve and decrypt the segmented content with @p dataName.
+   *
+   * The segment 0 is retrieved first to learn the FinalBlockId, then at most @p window
+   * interests for the remaining segments are kept outstanding. Once all segments are
+   * received, they are decrypted in parallel and @p consumptionCallBack is invoked with
+   * the reassembled payload, otherwise @p errorCallback.
+   *
+   * @param dataName The name of the content, without segment number
+   * @param consumptionCallBack The callback when the content is decrypted
+   * @param errorCallback The callback when error happens in consumption
+   * @param window The maximum number of outstanding segment interests
+   * @param delegations The link object for data retrieval
+   */
+  void
+  consumeSegments(const Name& dataName,
+                  const function<void (const Buffer&)>& consumptionCallBack,
+                  const ErrorCallBack& errorCallback,
+                  size_t window = 8,
+                  const Link& delegations = NO_LINK);
+
+  /**
+   * @brief Decrypt the content packets @p dataList in a batch.
+   *
+   * The C-KEYs missing in C-KEY store are retrieved first. The contents encrypted with the
+   * same C-KEY are then decrypted together, reusing the AES key schedule, and large batches
+   * are split across several threads. Invoke @p callback with the payloads in the order of
+   * @p dataList, otherwise @p errorCallback.
+   */
+  void
+  decryptContentBatch(const std::vector<Data>& dataList,
+                      const function<void (const std::vector<Buffer>&)>& callback,
+                      const ErrorCallBack& errorCallback);
 
   /**
    * @brief Set the group name to @p groupName.
@@ -84,6 +139,120 @@ public:
   void
   addDecryptionKey(const Name& keyName, const Buffer& keyBuf);
 
+  /**
+   * @brief Retrieve the D-KEY bundle of the consumer covering the time from @p from to @p to
+   *
+   * All the D-KEYs in the bundle are saved in D-KEY store, so C-KEYs encrypted with them can
+   * be decrypted without retrieving D-KEYs one by one. The segments of the bundle are
+   * retrieved in parallel once the first one tells their number. Invoke @p callback with
+   * the number of D-KEYs in the bundle, otherwise @p errorCallback.
+   */
+  void
+  fetchDKeyBundle(const TimeStamp& from, const TimeStamp& to,
+                  const function<void (size_t)>& callback,
+                  const ErrorCallBack& errorCallback);
+
+  /**
+   * @brief Retrieve the D-KEY bundle of the consumer covering the time from @p from to @p to
+   *
+   * @return The future of the number of D-KEYs in the bundle
+   */
+  Future<size_t>
+  fetchDKeyBundleAsync(const TimeStamp& from, const TimeStamp& to);
+
+  /**
+   * @brief Validate the content, C-KEY and D-KEY packets with @p validator
+   *
+   * The packets are not validated by default. Wrap the validator in a CachingValidator
+   * to avoid validating the certificate chain of the same signer for every packet.
+   */
+  void
+  setValidator(unique_ptr<Validator> validator);
+
+  /**
+   * @brief Look up C-KEYs and D-KEYs in @p localKeys before retrieving them from the network
+   */
+  void
+  setLocalKeyRegistry(const shared_ptr<LocalKeyRegistry>& localKeys);
+
+  /**
+   * @brief Record the calls and key events afterwards in @p traceRecorder
+   *
+   * @p traceRecorder of nullptr (default) disables recording.
+   */
+  void
+  setTraceRecorder(const shared_ptr<TraceRecorder>& traceRecorder);
+
+  /**
+   * @brief Encode the timestamps in the D-KEY bundle names requested afterwards with @p naming
+   *
+   * The naming must match the one of the group manager. The timestamps in C-KEY names are
+   * decoded in either naming. TimestampNaming::Iso is the default.
+   */
+  void
+  setTimestampNaming(TimestampNaming naming);
+
+  /**
+   * @brief Enable prefetching of the C-KEY for the next hour
+   *
+   * Once content encrypted with the C-KEY of an hour is consumed, the C-KEY of the
+   * next hour from the same producer, and the D-KEY needed to decrypt it, are retrieved
+   * @p leadTime before the hour boundary. Decryption of the content of the next hour
+   * can then use the C-KEY directly. The producer may not have created the C-KEY yet, so
+   * a timeout or Nack is retried with exponential backoff until the boundary; the last
+   * error, and any other prefetching error, is reported to @p errorCallback.
+   */
+  void
+  enablePrefetch(const time::milliseconds& leadTime,
+                 const ErrorCallBack& errorCallback = ErrorCallBack());
+
+  /**
+   * @brief Disable prefetching and cancel the scheduled prefetches
+   */
+  void
+  disablePrefetch();
+
+  /**
+   * @brief Enable hedged retrieval through @p fanout delegations of a link at once
+   *
+   * When retrieval falls back to a link, the interest is sent to the @p fanout best
+   * delegations in parallel rather than one by one. The first Data received is used
+   * and the other interests are cancelled. @p fanout of 1 (default) keeps trying
+   * the delegations one by one.
+   */
+  void
+  setDelegationFanout(size_t fanout);
+
+  /**
+   * @brief Wait @p interval before sending each interest afterwards
+   *
+   * The wait blocks the thread of the face. The interests of the segments after segment 0
+   * in consumeSegments() are not paced, so that the whole window is in flight at once.
+   * @p interval of zero disables pacing. The default is 100 milliseconds.
+   */
+  void
+  setInterestPacing(const time::milliseconds& interval);
+
+  /**
+   * @brief Retrieve segmented content of at most @p maxSegments segments afterwards
+   *
+   * Content whose FinalBlockId announces more segments fails with
+   * ErrorCode::InvalidEncryptedFormat before any further segment is requested. The default
+   * is 4096 segments, the largest content the producer compresses with the default segment
+   * size.
+   */
+  void
+  setMaxSegments(uint64_t maxSegments);
+
+  /**
+   * @brief Get the RTT estimator of content and key retrieval
+   */
+  const RttEstimator&
+  getRttEstimator() const
+  {
+    return m_rttEstimator;
+  }
+
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
 
   /**
@@ -107,6 +276,45 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
                  const PlainTextCallBack& plainTextCallBack,
                  const ErrorCallBack& errorCallback);
 
+  /**
+   * @brief Decrypt @p segments of a content and concatenate their payload.
+   *
+   * Invoke @p plainTextCallBack when all segments are decrypted, otherwise @p errorCallback.
+   */
+  void
+  decryptSegments(const std::vector<Data>& segments,
+                  const PlainTextCallBack& plainTextCallBack,
+                  const ErrorCallBack& errorCallback);
+
+  /**
+   * @brief Retrieve and decrypt the C-KEY with @p cKeyName.
+   *
+   * The C-KEY is saved in C-KEY store. Invoke @p plainTextCallBack when C-KEY is decrypted,
+   * otherwise @p errorCallback.
+   */
+  void
+  fetchCKey(const Name& cKeyName,
+            const PlainTextCallBack& plainTextCallBack,
+            const ErrorCallBack& errorCallback);
+
+  /**
+   * @brief Schedule the retrieval of the C-KEY following @p cKeyName
+   *
+   * Nothing is done if the next C-KEY is known or its retrieval has been scheduled.
+   */
+  void
+  schedulePrefetch(const Name& cKeyName);
+
+  /**
+   * @brief Retrieve the C-KEY @p cKeyName, and the D-KEY it is encrypted for
+   *
+   * A failed retrieval is retried after @p retryDelay, doubled at each retry, as long as
+   * the retry starts before @p boundary.
+   */
+  void
+  prefetchCKey(const Name& cKeyName, const time::system_clock::TimePoint& boundary,
+               const time::nanoseconds& retryDelay);
+
   /**
    * @brief Decrypt @p cKeyData.
    *
@@ -128,6 +336,17 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
               const ErrorCallBack& errorCallback);
 
 
+  /**
+   * @brief Decrypt @p bundleData and save the D-KEYs it carries in D-KEY store.
+   *
+   * Invoke @p callback with the number of D-KEYs when bundle is decrypted,
+   * otherwise @p errorCallback.
+   */
+  void
+  decryptDKeyBundle(const Data& bundleData,
+                    const function<void (size_t)>& callback,
+                    const ErrorCallBack& errorCallback);
+
   /**
    * @brief Get the buffer of decryption key with @p decryptionKeyName from database.
    *
@@ -140,7 +359,8 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
    * @brief Helper method for sending interest
    *
    * This method prepare the three callbacks: DataCallbak, NackCallback, TimeoutCallback
-   * for the @p interest.
+   * for the @p interest. Unless @p interest is a retransmission, its InterestLifetime is
+   * set to the RTO estimated for its prefix.
    *
    * @param interest The interes to send out
    * @param nRetrials The number of retrials left (if timeout)
@@ -148,17 +368,20 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
    * @param delegationIndex Current selected delegation
    * @param validationCallback The callback when data is validated
    * @param errorCallback The callback when error happens
+   * @param isRetransmission Whether @p interest is a retransmission of a timed out interest
    */
   void
   sendInterest(const Interest& interest, int nRetrials,
                const Link& delegations, size_t delegationIndex,
                const OnDataValidated& validationCallback,
-               const ErrorCallBack& errorCallback);
+               const ErrorCallBack& errorCallback,
+               bool isRetransmission = false);
 
   /**
    * @brief Callback to handle NACK
    *
-   * This method will check if there is another delegation to use. Otherwise report error
+   * This method will check if there is another delegation to use. Otherwise report error.
+   * If hedged retrieval is enabled, the delegations are raced instead.
    *
    * @param interest The interes got NACKed
    * @param nack The nack object
@@ -176,7 +399,8 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   /**
    * @brief Callback to handle timeout
    *
-   * This method will check if a retrial is allowed. Otherwise retreat the interest as NACKed
+   * This method will check if a retrial is allowed. Otherwise retreat the interest as NACKed.
+   * The InterestLifetime of the retrial is backed off exponentially.
    *
    * @param interest The interes timed out
    * @param nRetrials The number of retrials left
@@ -205,6 +429,22 @@ private:
   std::map<Name, Buffer> m_cKeyMap;
   Link m_dKeyLink;
   std::map<Name, Buffer> m_dKeyMap;
+  TimestampNaming m_timestampNaming;
+
+  shared_ptr<LocalKeyRegistry> m_localKeys;
+  shared_ptr<TraceRecorder> m_trace;
+
+  RttEstimator m_rttEstimator;
+  DelegationRacer m_delegationRacer;
+  time::milliseconds m_interestPacing;
+  uint64_t m_maxSegments;
+
+  bool m_isPrefetchEnabled;
+  time::milliseconds m_prefetchLeadTime;
+  ErrorCallBack m_prefetchErrorCallback;
+  // C-KEY name prefix => start of the latest hour whose C-KEY is prefetched
+  std::map<Name, time::system_clock::TimePoint> m_prefetches;
+  util::scheduler::Scheduler m_scheduler;
 };
 
 } // namespace gep
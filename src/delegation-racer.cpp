@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "delegation-racer.hpp"
+
+#include <ndn-cxx/util/random.hpp>
+
+namespace ndn {
+namespace gep {
+
+static const size_t MAX_FAILURE_PENALTY = 6;
+
+struct DelegationRacer::Race
+{
+  uint64_t id;
+  Interest interest;
+  Block linkBlock;
+  std::vector<Name> delegations;
+  std::vector<size_t> order;
+  size_t nextPosition;
+  size_t nOutstanding;
+  bool isSatisfied;
+  std::map<size_t, const PendingInterestId*> pendingInterests;
+  DataCallback dataCallback;
+  FailureCallback failureCallback;
+};
+
+DelegationRacer::DelegationRacer(Face& face, size_t fanout)
+  : m_face(face)
+  , m_fanout(std::max<size_t>(fanout, 1))
+  , m_nextRaceId(1)
+{
+}
+
+void
+DelegationRacer::setFanout(size_t fanout)
+{
+  m_fanout = std::max<size_t>(fanout, 1);
+}
+
+uint64_t
+DelegationRacer::fetch(const Interest& interest, const Link& link,
+                       const DataCallback& dataCallback, const FailureCallback& failureCallback)
+{
+  auto race = make_shared<Race>();
+  race->id = m_nextRaceId++;
+  race->interest = interest;
+  race->linkBlock = link.wireEncode();
+  for (const auto& delegation : link.getDelegations())
+    race->delegations.push_back(delegation.second);
+  race->order = rankDelegations(link);
+  race->nextPosition = 0;
+  race->nOutstanding = 0;
+  race->isSatisfied = false;
+  race->dataCallback = dataCallback;
+  race->failureCallback = failureCallback;
+  m_races[race->id] = race;
+
+  startRound(race);
+  return race->id;
+}
+
+void
+DelegationRacer::cancel(uint64_t raceId)
+{
+  auto it = m_races.find(raceId);
+  if (it == m_races.end())
+    return;
+
+  shared_ptr<Race> race = it->second;
+  m_races.erase(it);
+  race->isSatisfied = true;
+  for (const auto& pendingInterest : race->pendingInterests)
+    m_face.removePendingInterest(pendingInterest.second);
+  race->pendingInterests.clear();
+}
+
+std::vector<size_t>
+DelegationRacer::rankDelegations(const Link& link) const
+{
+  std::vector<std::pair<time::milliseconds, size_t>> scores;
+  size_t index = 0;
+  for (const auto& delegation : link.getDelegations()) {
+    // double the RTO for each recent failure of the delegation
+    time::milliseconds score = m_rttEstimator.getRto(delegation.second);
+    auto it = m_nFailures.find(delegation.second);
+    if (it != m_nFailures.end())
+      score *= 1 << std::min(it->second, MAX_FAILURE_PENALTY);
+
+    scores.push_back(std::make_pair(score, index++));
+  }
+
+  // keep the order of preference for delegations with the same score
+  std::stable_sort(scores.begin(), scores.end(),
+                   [] (const std::pair<time::milliseconds, size_t>& a,
+                       const std::pair<time::milliseconds, size_t>& b) {
+                     return a.first < b.first;
+                   });
+
+  std::vector<size_t> order;
+  for (const auto& score : scores)
+    order.push_back(score.second);
+  return order;
+}
+
+void
+DelegationRacer::startRound(const shared_ptr<Race>& race)
+{
+  if (race->nextPosition >= race->order.size()) {
+    // we run out of delegations
+    m_races.erase(race->id);
+    race->failureCallback();
+    return;
+  }
+
+  size_t end = std::min(race->nextPosition + m_fanout, race->order.size());
+  race->nOutstanding = end - race->nextPosition;
+  race->pendingInterests.clear();
+
+  for (; race->nextPosition < end; race->nextPosition++) {
+    size_t index = race->order[race->nextPosition];
+
+    Interest interest(race->interest);
+    interest.setLink(race->linkBlock);
+    interest.setSelectedDelegation(index);
+    interest.setInterestLifetime(m_rttEstimator.getRto(race->delegations[index]));
+    // parallel Interests must carry different nonces, otherwise they are dropped as loops
+    interest.setNonce(random::generateWord32());
+
+    time::steady_clock::TimePoint sendTime = time::steady_clock::now();
+    race->pendingInterests[index] =
+      m_face.expressInterest(interest,
+                             bind(&DelegationRacer::handleData, this, race, index, sendTime, _1, _2),
+                             bind(&DelegationRacer::handleFailure, this, race, index),
+                             bind(&DelegationRacer::handleFailure, this, race, index));
+  }
+}
+
+void
+DelegationRacer::handleData(const shared_ptr<Race>& race, size_t index,
+                            const time::steady_clock::TimePoint& sendTime,
+                            const Interest& interest, const Data& data)
+{
+  if (race->isSatisfied)
+    return;
+  race->isSatisfied = true;
+
+  const Name& delegation = race->delegations[index];
+  m_rttEstimator.addMeasurement(delegation, time::steady_clock::now() - sendTime);
+  m_nFailures.erase(delegation);
+
+  // cancel the Interests sent to the other delegations
+  for (const auto& pendingInterest : race->pendingInterests) {
+    if (pendingInterest.first != index)
+      m_face.removePendingInterest(pendingInterest.second);
+  }
+  race->pendingInterests.clear();
+  m_races.erase(race->id);
+
+  race->dataCallback(interest, data);
+}
+
+void
+DelegationRacer::handleFailure(const shared_ptr<Race>& race, size_t index)
+{
+  if (race->isSatisfied)
+    return;
+
+  const Name& delegation = race->delegations[index];
+  m_rttEstimator.addTimeout(delegation);
+  // the penalty does not grow beyond the cap, so the counter does not either
+  size_t& nFailures = m_nFailures[delegation];
+  nFailures = std::min(nFailures + 1, MAX_FAILURE_PENALTY);
+
+  race->nOutstanding--;
+  if (race->nOutstanding == 0)
+    startRound(race);
+}
+
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_DELEGATION_RACER_HPP
+#define NDN_GEP_DELEGATION_RACER_HPP
+
+#include "rtt-estimator.hpp"
+
+#include <ndn-cxx/face.hpp>
+
+namespace ndn {
+namespace gep {
+
+/**
+ * @brief DelegationRacer retrieves Data through the delegations of a Link in parallel
+ *
+ * Instead of trying the delegations of a Link one by one, the racer expresses the same
+ * Interest to the top-ranked delegations at once (hedged requests). The first Data received
+ * wins, and the Interests sent to the other delegations are cancelled. When all Interests of
+ * a round fail, the next round is started with the following delegations.
+ *
+ * The delegations are ranked by their RTO learnt from previous races, penalized by recent
+ * failures. Delegations without any measurement keep the order of preference in the Link.
+ */
+class DelegationRacer
+{
+public:
+  typedef function<void()> FailureCallback;
+
+public:
+  /**
+   * @brief Create a racer expressing Interests through @p face to @p fanout delegations at once
+   */
+  DelegationRacer(Face& face, size_t fanout = 1);
+
+  void
+  setFanout(size_t fanout);
+
+  size_t
+  getFanout() const
+  {
+    return m_fanout;
+  }
+
+  /**
+   * @brief Retrieve Data for @p interest through the delegations of @p link
+   *
+   * Invoke @p dataCallback for the first Data received, or @p failureCallback when all
+   * delegations have failed. The InterestLifetime of the Interest sent to each delegation is
+   * the RTO of the delegation.
+   *
+   * @return The id of the race, which can be passed to cancel()
+   */
+  uint64_t
+  fetch(const Interest& interest, const Link& link,
+        const DataCallback& dataCallback, const FailureCallback& failureCallback);
+
+  /**
+   * @brief Withdraw the Interests of the race with @p raceId
+   *
+   * None of the callbacks of the race is invoked afterwards. Cancelling a race which has
+   * ended does nothing.
+   */
+  void
+  cancel(uint64_t raceId);
+
+  /**
+   * @brief Get the indexes of the delegations of @p link, from the best to the worst
+   */
+  std::vector<size_t>
+  rankDelegations(const Link& link) const;
+
+  /**
+   * @brief Get the RTT estimator of the delegations
+   */
+  const RttEstimator&
+  getRttEstimator() const
+  {
+    return m_rttEstimator;
+  }
+
+private:
+  struct Race;
+
+  void
+  startRound(const shared_ptr<Race>& race);
+
+  void
+  handleData(const shared_ptr<Race>& race, size_t index,
+             const time::steady_clock::TimePoint& sendTime,
+             const Interest& interest, const Data& data);
+
+  void
+  handleFailure(const shared_ptr<Race>& race, size_t index);
+
+private:
+  Face& m_face;
+  size_t m_fanout;
+  RttEstimator m_rttEstimator;
+  std::map<Name, size_t> m_nFailures;
+  /// @brief The races which have not ended, by id
+  std::map<uint64_t, shared_ptr<Race>> m_races;
+  uint64_t m_nextRaceId;
+};
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_DELEGATION_RACER_HPP
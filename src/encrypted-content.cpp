@@ -15,6 +15,7 @@ static_assert(std::is_base_of<ndn::tlv::Error, EncryptedContent::Error>::value,
 
 EncryptedContent::EncryptedContent()
   : m_type(-1)
+  , m_compression(tlv::CompressionNone)
   , m_hasKeyLocator(false)
 {
 }
@@ -23,6 +24,7 @@ EncryptedContent::EncryptedContent(tlv::AlgorithmTypeValue type, const KeyLocato
                                    const uint8_t* payload, size_t payloadLen,
                                    const uint8_t* iv, size_t ivLen)
   : m_type(type)
+  , m_compression(tlv::CompressionNone)
   , m_hasKeyLocator(true)
   , m_keyLocator(keyLocator)
   , m_payload(payload, payloadLen)
@@ -43,6 +45,13 @@ EncryptedContent::setAlgorithmType(tlv::AlgorithmTypeValue type)
   m_type = type;
 }
 
+void
+EncryptedContent::setCompressionAlgorithm(tlv::CompressionTypeValue type)
+{
+  m_wire.reset();
+  m_compression = type;
+}
+
 void
 EncryptedContent::setKeyLocator(const KeyLocator& keyLocator)
 {
@@ -101,6 +110,9 @@ EncryptedContent::wireEncode(EncodingImpl<TAG>& block) const
     totalLength += block.prependByteArrayBlock(tlv::InitialVector, m_iv.buf(), m_iv.size());
   }
 
+  if (m_compression != tlv::CompressionNone)
+    totalLength += prependNonNegativeIntegerBlock(block, tlv::CompressionAlgorithm, m_compression);
+
   if (m_type != -1)
     totalLength += prependNonNegativeIntegerBlock(block, tlv::EncryptionAlgorithm, m_type);
   else
@@ -164,6 +176,13 @@ EncryptedContent::wireDecode(const Block& wire)
   else
     throw Error("EncryptedContent does not have encryption algorithm");
 
+  if (it != m_wire.elements_end() && it->type() == tlv::CompressionAlgorithm) {
+    m_compression = static_cast<tlv::CompressionTypeValue>(readNonNegativeInteger(*it));
+    it++;
+  }
+  else
+    m_compression = tlv::CompressionNone;
+
   if (it != m_wire.elements_end() && it->type() == tlv::InitialVector) {
     m_iv = Buffer(it->value_begin(), it->value_end());
     it++;
@@ -42,6 +42,16 @@ public:
     return m_type;
   }
 
+  void
+  setCompressionAlgorithm(tlv::CompressionTypeValue type);
+
+  /// @brief Get the compression applied to the payload before encryption
+  tlv::CompressionTypeValue
+  getCompressionAlgorithm() const
+  {
+    return m_compression;
+  }
+
   bool
   hasKeyLocator() const
   {
@@ -87,6 +97,7 @@ public:
 
 private:
   int32_t m_type;
+  tlv::CompressionTypeValue m_compression;
   bool m_hasKeyLocator;
   KeyLocator m_keyLocator;
   Buffer m_payload;
@@ -30,6 +30,7 @@ namespace gep {
 enum class ErrorCode {
   Timeout = 1,
   Validation = 2,
+  Cancelled = 3,
   UnsupportedEncryptionScheme = 32,
   InvalidEncryptedFormat = 33,
   NoDecryptKey = 34,
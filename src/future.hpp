@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_FUTURE_HPP
+#define NDN_GEP_FUTURE_HPP
+
+#include "error-code.hpp"
+
+#include <boost/optional.hpp>
+#include <boost/throw_exception.hpp>
+
+namespace ndn {
+namespace gep {
+
+template<typename T>
+class Future;
+
+namespace detail {
+
+/**
+ * @brief State shared by a Promise and its Future
+ *
+ * The state holds either the value or the error, and a single continuation. It is allocated
+ * once per operation, so passing a Promise through the retrieval steps only copies a pointer
+ * instead of the callbacks.
+ */
+template<typename T>
+struct FutureState
+{
+  FutureState()
+    : isReady(false)
+    , errorCode(ErrorCode::DataRetrievalFailure)
+  {
+  }
+
+  void
+  runContinuation()
+  {
+    if (value) {
+      if (onValue)
+        onValue(*value);
+    }
+    else if (onError) {
+      onError(errorCode, errorMsg);
+    }
+    onValue = nullptr;
+    onError = nullptr;
+  }
+
+  bool isReady;
+  boost::optional<T> value;
+  ErrorCode errorCode;
+  std::string errorMsg;
+
+  function<void(const T&)> onValue;
+  ErrorCallBack onError;
+};
+
+} // namespace detail
+
+/**
+ * @brief The producing side of an asynchronous operation
+ *
+ * A promise is set at most once. The value or error set later is ignored, so a promise can
+ * be handed to callbacks which may be invoked more than once. Promises and futures are
+ * meant to be used on the thread processing the face events, and are not thread-safe.
+ */
+template<typename T>
+class Promise
+{
+public:
+  Promise()
+    : m_state(make_shared<detail::FutureState<T>>())
+  {
+  }
+
+  Future<T>
+  getFuture() const
+  {
+    return Future<T>(m_state);
+  }
+
+  /**
+   * @brief Fulfill the promise with @p value
+   *
+   * @return false if the promise has already been set
+   */
+  bool
+  setValue(const T& value) const
+  {
+    if (m_state->isReady)
+      return false;
+
+    m_state->isReady = true;
+    m_state->value = value;
+    m_state->runContinuation();
+    return true;
+  }
+
+  /**
+   * @brief Fail the promise with @p code and @p msg
+   *
+   * @return false if the promise has already been set
+   */
+  bool
+  setError(const ErrorCode& code, const std::string& msg) const
+  {
+    if (m_state->isReady)
+      return false;
+
+    m_state->isReady = true;
+    m_state->errorCode = code;
+    m_state->errorMsg = msg;
+    m_state->runContinuation();
+    return true;
+  }
+
+private:
+  shared_ptr<detail::FutureState<T>> m_state;
+};
+
+/**
+ * @brief The consuming side of an asynchronous operation
+ *
+ * The result is delivered to the continuation registered with then(). If the operation
+ * has already completed, the continuation is invoked immediately.
+ */
+template<typename T>
+class Future
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+public:
+  bool
+  isReady() const
+  {
+    return m_state->isReady;
+  }
+
+  bool
+  hasValue() const
+  {
+    return static_cast<bool>(m_state->value);
+  }
+
+  /**
+   * @brief Get the value of a completed operation
+   *
+   * @throw Error the operation is not completed or failed
+   */
+  const T&
+  get() const
+  {
+    if (!m_state->value) {
+      if (m_state->isReady)
+        BOOST_THROW_EXCEPTION(Error("Operation failed: " + m_state->errorMsg));
+      else
+        BOOST_THROW_EXCEPTION(Error("Operation is not completed"));
+    }
+    return *m_state->value;
+  }
+
+  ErrorCode
+  getErrorCode() const
+  {
+    return m_state->errorCode;
+  }
+
+  const std::string&
+  getErrorMessage() const
+  {
+    return m_state->errorMsg;
+  }
+
+  /**
+   * @brief Register the continuation of the operation
+   *
+   * Invoke @p onValue with the result of the operation, otherwise @p onError.
+   * Only one continuation is kept; registering another one replaces it.
+   */
+  const Future&
+  then(const function<void(const T&)>& onValue, const ErrorCallBack& onError = nullptr) const
+  {
+    m_state->onValue = onValue;
+    m_state->onError = onError;
+    if (m_state->isReady)
+      m_state->runContinuation();
+    return *this;
+  }
+
+private:
+  explicit
+  Future(const shared_ptr<detail::FutureState<T>>& state)
+    : m_state(state)
+  {
+  }
+
+private:
+  shared_ptr<detail::FutureState<T>> m_state;
+
+  friend class Promise<T>;
+};
+
+/**
+ * @brief Compose @p futures into one future of all their values
+ *
+ * The returned future completes with the values in the order of @p futures when all of
+ * them succeed, or fails with the first error.
+ */
+template<typename T>
+Future<std::vector<T>>
+whenAll(const std::vector<Future<T>>& futures)
+{
+  Promise<std::vector<T>> promise;
+  if (futures.empty()) {
+    promise.setValue(std::vector<T>());
+    return promise.getFuture();
+  }
+
+  struct Collector
+  {
+    std::vector<boost::optional<T>> values;
+    size_t nPending;
+  };
+  auto collector = make_shared<Collector>();
+  collector->values.resize(futures.size());
+  collector->nPending = futures.size();
+
+  for (size_t i = 0; i < futures.size(); i++) {
+    futures[i].then([=] (const T& value) {
+        collector->values[i] = value;
+        if (--collector->nPending > 0)
+          return;
+
+        std::vector<T> values;
+        values.reserve(collector->values.size());
+        for (const auto& v : collector->values)
+          values.push_back(*v);
+        promise.setValue(values);
+      },
+      [=] (const ErrorCode& code, const std::string& msg) {
+        promise.setError(code, msg);
+      });
+  }
+  return promise.getFuture();
+}
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_FUTURE_HPP
@@ -24,14 +24,23 @@
 
 #include <sqlite3.h>
 #include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <ndn-cxx/encoding/block-helpers.hpp>
 #include <ndn-cxx/util/sqlite3-statement.hpp>
 #include <ndn-cxx/security/identity-certificate.hpp>
 
+#include <fstream>
+
 namespace ndn {
 namespace gep {
 
 using util::Sqlite3Statement;
 
+static const char SNAPSHOT_MAGIC[] = {'G', 'E', 'P', 'S'};
+static const size_t SNAPSHOT_HEADER_SIZE = sizeof(SNAPSHOT_MAGIC) + 1;
+
+const uint8_t GroupManagerDB::SNAPSHOT_VERSION = 1;
+
 static const std::string INITIALIZATION =
   "CREATE TABLE IF NOT EXISTS                         \n"
   "  schedules(                                       \n"
@@ -55,7 +64,67 @@ static const std::string INITIALIZATION =
   "      ON UPDATE CASCADE                            \n"
   "  );                                               \n"
   "CREATE UNIQUE INDEX IF NOT EXISTS                  \n"
-  "   memNameIndex ON members(member_name);           \n";
+  "   memNameIndex ON members(member_name);           \n"
+  "                                                   \n"
+  "CREATE TABLE IF NOT EXISTS                         \n"
+  "  generation(                                      \n"
+  "    id                  INTEGER PRIMARY KEY,       \n"
+  "    value               INTEGER NOT NULL           \n"
+  "  );                                               \n"
+  "INSERT OR IGNORE INTO generation (id, value)       \n"
+  "  VALUES (0, 0);                                   \n"
+  "                                                   \n"
+  "CREATE TABLE IF NOT EXISTS                         \n"
+  "  group_keys(                                      \n"
+  "    ekey_name           BLOB NOT NULL,             \n"
+  "    generation          INTEGER NOT NULL,          \n"
+  "    end_time            INTEGER NOT NULL,          \n"
+  "    pri_key             BLOB NOT NULL,             \n"
+  "    pub_key             BLOB NOT NULL,             \n"
+  "    PRIMARY KEY(ekey_name, generation)             \n"
+  "  );                                               \n"
+  "CREATE INDEX IF NOT EXISTS                         \n"
+  "   groupKeyEndTimeIndex ON group_keys(end_time);   \n";
+
+// the generation is increased by any change of the schedules or the members
+static const std::string GENERATION_TRIGGERS =
+  "CREATE TRIGGER IF NOT EXISTS                       \n"
+  "  schedules_insert AFTER INSERT ON schedules       \n"
+  "  BEGIN UPDATE generation SET value=value+1; END;  \n"
+  "CREATE TRIGGER IF NOT EXISTS                       \n"
+  "  schedules_update AFTER UPDATE ON schedules       \n"
+  "  BEGIN UPDATE generation SET value=value+1; END;  \n"
+  "CREATE TRIGGER IF NOT EXISTS                       \n"
+  "  schedules_delete AFTER DELETE ON schedules       \n"
+  "  BEGIN UPDATE generation SET value=value+1; END;  \n"
+  "CREATE TRIGGER IF NOT EXISTS                       \n"
+  "  members_insert AFTER INSERT ON members           \n"
+  "  BEGIN UPDATE generation SET value=value+1; END;  \n"
+  "CREATE TRIGGER IF NOT EXISTS                       \n"
+  "  members_update AFTER UPDATE ON members           \n"
+  "  BEGIN UPDATE generation SET value=value+1; END;  \n"
+  "CREATE TRIGGER IF NOT EXISTS                       \n"
+  "  members_delete AFTER DELETE ON members           \n"
+  "  BEGIN UPDATE generation SET value=value+1; END;  \n";
+
+static const char DROP_GENERATION_TRIGGERS[] =
+  "DROP TRIGGER IF EXISTS schedules_insert;           \n"
+  "DROP TRIGGER IF EXISTS schedules_update;           \n"
+  "DROP TRIGGER IF EXISTS schedules_delete;           \n"
+  "DROP TRIGGER IF EXISTS members_insert;             \n"
+  "DROP TRIGGER IF EXISTS members_update;             \n"
+  "DROP TRIGGER IF EXISTS members_delete;             \n";
+
+// time to wait for the lock of another group manager sharing the database
+static const int BUSY_TIMEOUT = 10000;
+
+/// @brief Get the seconds since the epoch of @p timestamp, as stored in the database
+static sqlite3_int64
+toSeconds(const TimeStamp& timestamp)
+{
+  static const TimeStamp epoch(boost::gregorian::date(1970, 1, 1));
+  return (timestamp - epoch).total_seconds();
+}
 
 class GroupManagerDB::Impl
 {
@@ -79,9 +148,13 @@ public:
     // enable foreign key
     sqlite3_exec(m_database, "PRAGMA foreign_keys = ON", nullptr, nullptr, nullptr);
 
+    // several group manager processes may share the database
+    sqlite3_busy_timeout(m_database, BUSY_TIMEOUT);
+
     // initialize database specific tables
     char* errorMessage = nullptr;
-    result = sqlite3_exec(m_database, INITIALIZATION.c_str(), nullptr, nullptr, &errorMessage);
+    result = sqlite3_exec(m_database, (INITIALIZATION + GENERATION_TRIGGERS).c_str(),
+                          nullptr, nullptr, &errorMessage);
     if (result != SQLITE_OK && errorMessage != nullptr) {
       sqlite3_free(errorMessage);
       BOOST_THROW_EXCEPTION(Error("GroupManager DB cannot be initialized"));
@@ -110,6 +183,44 @@ public:
   sqlite3* m_database;
 };
 
+/**
+ * @brief Transaction of the database, rolled back unless committed
+ */
+class Transaction : noncopyable
+{
+public:
+  Transaction(sqlite3* database, const char* begin = "BEGIN")
+    : m_database(database)
+    , m_isCommitted(false)
+  {
+    exec(begin);
+  }
+
+  ~Transaction()
+  {
+    if (!m_isCommitted)
+      sqlite3_exec(m_database, "ROLLBACK", nullptr, nullptr, nullptr);
+  }
+
+  void
+  exec(const char* sql)
+  {
+    if (sqlite3_exec(m_database, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+      BOOST_THROW_EXCEPTION(GroupManagerDB::Error(std::string("Cannot execute: ") + sql));
+  }
+
+  void
+  commit()
+  {
+    exec("COMMIT");
+    m_isCommitted = true;
+  }
+
+private:
+  sqlite3* m_database;
+  bool m_isCommitted;
+};
+
 GroupManagerDB::GroupManagerDB(const std::string& dbPath)
   : m_impl(new Impl(dbPath))
 {
@@ -140,6 +251,17 @@ GroupManagerDB::listAllScheduleNames() const
   return result;
 }
 
+void
+GroupManagerDB::visitSchedules(const ScheduleVisitor& visitor) const
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "SELECT schedule_name, schedule FROM schedules");
+  while (statement.step() == SQLITE_ROW) {
+    if (!visitor(statement.getString(0), statement.getBlock(1)))
+      return;
+  }
+}
+
 Schedule
 GroupManagerDB::getSchedule(const std::string& name) const
 {
@@ -161,22 +283,27 @@ std::map<Name, Buffer>
 GroupManagerDB::getScheduleMembers(const std::string& name) const
 {
   std::map<Name, Buffer> result;
+  visitScheduleMembers(name, [&result] (const Name& keyName, const uint8_t* key, size_t keySize) {
+      result.insert(std::make_pair(keyName, Buffer(key, keySize)));
+      return true;
+    });
+  return result;
+}
+
+void
+GroupManagerDB::visitScheduleMembers(const std::string& name, const MemberVisitor& visitor) const
+{
   Sqlite3Statement statement(m_impl->m_database,
                              "SELECT key_name, pubkey\
                               FROM members JOIN schedules\
                               ON members.schedule_id=schedules.schedule_id\
                               WHERE schedule_name=?");
   statement.bind(1, name, SQLITE_TRANSIENT);
-  result.clear();
 
-  const uint8_t* keyBytes = nullptr;
   while (statement.step() == SQLITE_ROW) {
-    keyBytes = statement.getBlob(1);
-    const int& keyBytesSize = statement.getSize(1);
-    result.insert(std::pair<Name, Buffer>(Name(statement.getBlock(0)),
-                                          Buffer(keyBytes, keyBytesSize)));
+    if (!visitor(Name(statement.getBlock(0)), statement.getBlob(1), statement.getSize(1)))
+      return;
   }
-  return result;
 }
 
 void
@@ -253,6 +380,17 @@ GroupManagerDB::listAllMembers() const
   return result;
 }
 
+void
+GroupManagerDB::visitMembers(const MemberVisitor& visitor) const
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "SELECT key_name, pubkey FROM members");
+  while (statement.step() == SQLITE_ROW) {
+    if (!visitor(Name(statement.getBlock(0)), statement.getBlob(1), statement.getSize(1)))
+      return;
+  }
+}
+
 std::string
 GroupManagerDB::getMemberSchedule(const Name& identity) const
 {
@@ -319,5 +457,207 @@ GroupManagerDB::deleteMember(const Name& identity)
   statement.step();
 }
 
+uint64_t
+GroupManagerDB::getGeneration() const
+{
+  // the generation is increased by the triggers on the schedules and members
+  Sqlite3Statement statement(m_impl->m_database, "SELECT value FROM generation WHERE id=0");
+  if (statement.step() != SQLITE_ROW)
+    BOOST_THROW_EXCEPTION(Error("Cannot read the generation of the database"));
+  return static_cast<uint64_t>(sqlite3_column_int64(statement, 0));
+}
+
+bool
+GroupManagerDB::getGroupKey(const Name& eKeyName, uint64_t generation,
+                            Buffer& priKey, Buffer& pubKey) const
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "SELECT pri_key, pub_key FROM group_keys\
+                              WHERE ekey_name=? AND generation=?");
+  statement.bind(1, eKeyName.wireEncode(), SQLITE_TRANSIENT);
+  sqlite3_bind_int64(statement, 2, static_cast<sqlite3_int64>(generation));
+  if (statement.step() != SQLITE_ROW)
+    return false;
+
+  priKey = Buffer(statement.getBlob(0), statement.getSize(0));
+  pubKey = Buffer(statement.getBlob(1), statement.getSize(1));
+  return true;
+}
+
+void
+GroupManagerDB::addGroupKey(const Name& eKeyName, uint64_t generation, const TimeStamp& endTime,
+                            const Buffer& priKey, const Buffer& pubKey)
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "INSERT OR IGNORE INTO group_keys\
+                              (ekey_name, generation, end_time, pri_key, pub_key)\
+                              values (?, ?, ?, ?, ?)");
+  statement.bind(1, eKeyName.wireEncode(), SQLITE_TRANSIENT);
+  sqlite3_bind_int64(statement, 2, static_cast<sqlite3_int64>(generation));
+  sqlite3_bind_int64(statement, 3, toSeconds(endTime));
+  statement.bind(4, priKey.buf(), priKey.size(), SQLITE_TRANSIENT);
+  statement.bind(5, pubKey.buf(), pubKey.size(), SQLITE_TRANSIENT);
+  if (statement.step() != SQLITE_DONE)
+    BOOST_THROW_EXCEPTION(Error("Cannot add the group key to database"));
+}
+
+void
+GroupManagerDB::pruneGroupKeys(const TimeStamp& timeslot, uint64_t generation)
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "DELETE FROM group_keys WHERE end_time<=? OR generation<?");
+  sqlite3_bind_int64(statement, 1, toSeconds(timeslot));
+  sqlite3_bind_int64(statement, 2, static_cast<sqlite3_int64>(generation));
+  statement.step();
+}
+
+void
+GroupManagerDB::exportSnapshot(const std::string& path) const
+{
+  // write to a temporary file first, so that the previous snapshot survives a failure
+  std::string tmpPath = path + ".tmp";
+  try {
+    std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!os)
+      BOOST_THROW_EXCEPTION(Error("Snapshot cannot be created: " + path));
+
+    os.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    os.put(static_cast<char>(SNAPSHOT_VERSION));
+
+    // read the schedules and the members in one transaction for a consistent snapshot
+    Transaction transaction(m_impl->m_database);
+
+    // members refer to the schedules by their index in the snapshot
+    std::map<int, size_t> scheduleIndexes;
+    Sqlite3Statement scheduleStatement(m_impl->m_database,
+                                       "SELECT schedule_id, schedule_name, schedule\
+                                        FROM schedules ORDER BY schedule_id");
+    while (scheduleStatement.step() == SQLITE_ROW) {
+      size_t index = scheduleIndexes.size();
+      scheduleIndexes[scheduleStatement.getInt(0)] = index;
+
+      Block entry(tlv::SnapshotSchedule);
+      entry.push_back(makeStringBlock(tlv::ScheduleName, scheduleStatement.getString(1)));
+      entry.push_back(scheduleStatement.getBlock(2));
+      entry.encode();
+      os.write(reinterpret_cast<const char*>(entry.wire()), entry.size());
+    }
+
+    Sqlite3Statement memberStatement(m_impl->m_database,
+                                     "SELECT schedule_id, key_name, pubkey FROM members");
+    while (memberStatement.step() == SQLITE_ROW) {
+      Block entry(tlv::SnapshotMember);
+      entry.push_back(makeNonNegativeIntegerBlock(tlv::ScheduleIndex,
+                                                  scheduleIndexes.at(memberStatement.getInt(0))));
+      entry.push_back(memberStatement.getBlock(1));
+      entry.push_back(makeBinaryBlock(tlv::MemberKey, memberStatement.getBlob(2),
+                                      memberStatement.getSize(2)));
+      entry.encode();
+      os.write(reinterpret_cast<const char*>(entry.wire()), entry.size());
+    }
+    transaction.commit();
+
+    os.close();
+    if (!os)
+      BOOST_THROW_EXCEPTION(Error("Snapshot cannot be written: " + path));
+
+    boost::filesystem::rename(tmpPath, path);
+  }
+  catch (const boost::filesystem::filesystem_error& e) {
+    boost::system::error_code ec;
+    boost::filesystem::remove(tmpPath, ec);
+    BOOST_THROW_EXCEPTION(Error("Snapshot cannot be written: " + path));
+  }
+  catch (...) {
+    boost::system::error_code ec;
+    boost::filesystem::remove(tmpPath, ec);
+    throw;
+  }
+}
+
+void
+GroupManagerDB::importSnapshot(const std::string& path)
+{
+  boost::iostreams::mapped_file_source file;
+  try {
+    file.open(path);
+  }
+  catch (const std::exception& e) {
+    BOOST_THROW_EXCEPTION(Error("Snapshot cannot be opened: " + path));
+  }
+
+  const uint8_t* buffer = reinterpret_cast<const uint8_t*>(file.data());
+  size_t size = file.size();
+  if (size < SNAPSHOT_HEADER_SIZE ||
+      !std::equal(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC), buffer))
+    BOOST_THROW_EXCEPTION(Error("Not a snapshot: " + path));
+  if (buffer[sizeof(SNAPSHOT_MAGIC)] != SNAPSHOT_VERSION)
+    BOOST_THROW_EXCEPTION(Error("Unsupported snapshot version: " +
+                                std::to_string(buffer[sizeof(SNAPSHOT_MAGIC)])));
+
+  // replace the whole content at once, so that a failure leaves the database unchanged
+  Transaction transaction(m_impl->m_database, "BEGIN IMMEDIATE");
+  // the triggers would increase the generation once per row, they are created again
+  // after a single increase for the whole import, all within the transaction
+  transaction.exec(DROP_GENERATION_TRIGGERS);
+  transaction.exec("DELETE FROM members");
+  transaction.exec("DELETE FROM schedules");
+
+  Sqlite3Statement scheduleStatement(m_impl->m_database,
+                                     "INSERT INTO schedules (schedule_name, schedule)\
+                                      values (?, ?)");
+  Sqlite3Statement memberStatement(m_impl->m_database,
+                                   "INSERT INTO members(schedule_id, member_name, key_name, pubkey)\
+                                    values (?, ?, ?, ?)");
+  std::vector<int> scheduleIds;
+  try {
+    size_t offset = SNAPSHOT_HEADER_SIZE;
+    while (offset < size) {
+      Block entry(buffer + offset, size - offset);
+      offset += entry.size();
+      entry.parse();
+
+      if (entry.type() == tlv::SnapshotSchedule) {
+        std::string scheduleName = readString(entry.get(tlv::ScheduleName));
+        const Block& schedule = entry.get(tlv::Schedule);
+        // reject a malformed schedule now rather than when a group key is created
+        Schedule decodedSchedule(schedule);
+
+        scheduleStatement.bind(1, scheduleName, SQLITE_TRANSIENT);
+        scheduleStatement.bind(2, schedule, SQLITE_TRANSIENT);
+        if (scheduleStatement.step() != SQLITE_DONE)
+          BOOST_THROW_EXCEPTION(Error("Cannot import the schedule " + scheduleName));
+        sqlite3_reset(scheduleStatement);
+        scheduleIds.push_back(static_cast<int>(sqlite3_last_insert_rowid(m_impl->m_database)));
+      }
+      else if (entry.type() == tlv::SnapshotMember) {
+        uint64_t scheduleIndex = readNonNegativeInteger(entry.get(tlv::ScheduleIndex));
+        if (scheduleIndex >= scheduleIds.size())
+          BOOST_THROW_EXCEPTION(Error("Snapshot member refers to an unknown schedule"));
+        const Block& keyName = entry.get(tlv::Name);
+        const Block& key = entry.get(tlv::MemberKey);
+
+        // need to be changed in the future, as in addMember
+        Name memberName = Name(keyName).getPrefix(-1);
+
+        memberStatement.bind(1, scheduleIds[scheduleIndex]);
+        memberStatement.bind(2, memberName.wireEncode(), SQLITE_TRANSIENT);
+        memberStatement.bind(3, keyName, SQLITE_TRANSIENT);
+        memberStatement.bind(4, key.value(), key.value_size(), SQLITE_TRANSIENT);
+        if (memberStatement.step() != SQLITE_DONE)
+          BOOST_THROW_EXCEPTION(Error("Cannot import the member " + memberName.toUri()));
+        sqlite3_reset(memberStatement);
+      }
+      // entries of unknown types are ignored, newer snapshots may add them
+    }
+  }
+  catch (const tlv::Error& e) {
+    BOOST_THROW_EXCEPTION(Error(std::string("Malformed snapshot: ") + e.what()));
+  }
+  transaction.exec("UPDATE generation SET value=value+1");
+  transaction.exec(GENERATION_TRIGGERS.c_str());
+  transaction.commit();
+}
+
 } // namespace gep
 } // namespace ndn
@@ -45,6 +45,23 @@ public:
     }
   };
 
+  /**
+   * @brief Visitor of a schedule, given its name and encoded Schedule
+   *
+   * @return false to stop the iteration
+   */
+  typedef function<bool (const std::string& name, const Block& schedule)> ScheduleVisitor;
+
+  /**
+   * @brief Visitor of a member, given its key name and public key
+   *
+   * The public key points into the current row of the database and is valid during the
+   * call only.
+   *
+   * @return false to stop the iteration
+   */
+  typedef function<bool (const Name& keyName, const uint8_t* key, size_t keySize)> MemberVisitor;
+
 public:
   /**
    * @brief Create the database of group manager at path @p dbPath.
@@ -83,6 +100,22 @@ public:
   std::map<Name, Buffer>
   getScheduleMembers(const std::string& name) const;
 
+  /**
+   * @brief Invoke @p visitor for each schedule, one row at a time
+   *
+   * The database must not be modified by @p visitor.
+   */
+  void
+  visitSchedules(const ScheduleVisitor& visitor) const;
+
+  /**
+   * @brief Invoke @p visitor for each member of the schedule with @p name, one row at a time
+   *
+   * The database must not be modified by @p visitor.
+   */
+  void
+  visitScheduleMembers(const std::string& name, const MemberVisitor& visitor) const;
+
   /**
    * @brief Add a @p schedule with @p name
    * @pre Name.length() != 0
@@ -131,6 +164,14 @@ public:
   std::list<Name>
   listAllMembers() const;
 
+  /**
+   * @brief Invoke @p visitor for each member, one row at a time
+   *
+   * The database must not be modified by @p visitor.
+   */
+  void
+  visitMembers(const MemberVisitor& visitor) const;
+
   /**
    * @brief Get the schedule name of a member with name @p identity
    *
@@ -164,6 +205,80 @@ public:
   void
   deleteMember(const Name& identity);
 
+  /**
+   * @brief Get the generation of the schedules and members
+   *
+   * The generation is stored in the database and increased by every change of a schedule
+   * or a member, so all the connections to the database share it.
+   */
+  uint64_t
+  getGeneration() const;
+
+  ////////////////////////////////////////////////////// group key management
+
+  /**
+   * @brief Get the key pair of the group key with E-KEY name @p eKeyName created at
+   *        @p generation of the schedules and members
+   *
+   * @return false if the database has no such group key
+   */
+  bool
+  getGroupKey(const Name& eKeyName, uint64_t generation, Buffer& priKey, Buffer& pubKey) const;
+
+  /**
+   * @brief Add the key pair @p priKey and @p pubKey of the group key with E-KEY name @p eKeyName
+   *        created at @p generation of the schedules and members, for an interval ending at
+   *        @p endTime
+   *
+   * The group key already in the database for the same generation is kept, so that the group
+   * managers sharing the database agree on the key pair added first. A change of the
+   * schedules or members starts a new generation, which gets a new key pair.
+   *
+   * @note The private key is stored unencrypted.
+   */
+  void
+  addGroupKey(const Name& eKeyName, uint64_t generation, const TimeStamp& endTime,
+              const Buffer& priKey, const Buffer& pubKey);
+
+  /**
+   * @brief Delete the group keys of the intervals ending at or before @p timeslot, and the
+   *        group keys created before @p generation
+   */
+  void
+  pruneGroupKeys(const TimeStamp& timeslot, uint64_t generation);
+
+  ////////////////////////////////////////////////////// snapshot
+
+  /**
+   * @brief Write all the schedules and members to a snapshot file at @p path
+   *
+   * The snapshot starts with the magic "GEPS" and a version octet, followed by a
+   * SnapshotSchedule TLV for each schedule, then a SnapshotMember TLV for each member
+   * referring to its schedule by index.
+   *
+   * The snapshot is written to "<path>.tmp" and renamed to @p path once complete, so an
+   * existing snapshot at @p path is kept if the export fails.
+   *
+   * @throw Error if the snapshot cannot be written
+   */
+  void
+  exportSnapshot(const std::string& path) const;
+
+  /**
+   * @brief Replace all the schedules and members with those of the snapshot at @p path
+   *
+   * The snapshot is mapped in memory and loaded in a single transaction, so the database
+   * is left unchanged if the snapshot is invalid. The generation is increased once for the
+   * whole import, not for each schedule and member.
+   *
+   * @throw Error if the snapshot cannot be read or is malformed
+   */
+  void
+  importSnapshot(const std::string& path);
+
+public:
+  static const uint8_t SNAPSHOT_VERSION;
+
 private:
   class Impl;
   unique_ptr<Impl> m_impl;
@@ -22,39 +22,78 @@
 #include "group-manager.hpp"
 #include "algo/encryptor.hpp"
 #include "encrypted-content.hpp"
+#include "span-tracer.hpp"
 
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+#include <algorithm>
 #include <map>
 
 namespace ndn {
 namespace gep {
 
+// bound of the intervals kept, which are dropped all at once when it is reached
+static const size_t MAX_CACHED_INTERVALS = 1024;
+
+// bound of the D-KEY entries carried by a D-KEY bundle packet, which keeps the packet with
+// the encrypted nonce, the name and the signature within MAX_NDN_PACKET_SIZE
+static const size_t MAX_BUNDLE_SEGMENT_SIZE = 4096;
+
 GroupManager::GroupManager(const Name& prefix, const Name& dataType, const std::string& dbPath,
                            const int paramLength, const int freshPeriod)
-  : m_namespace(prefix)
+  : GroupManager(prefix, dataType, dbPath, paramLength, freshPeriod, nullptr)
+{
+}
+
+GroupManager::GroupManager(const Name& prefix, const Name& dataType, const std::string& dbPath,
+                           const int paramLength, const int freshPeriod, KeyChain& keyChain)
+  : GroupManager(prefix, dataType, dbPath, paramLength, freshPeriod, &keyChain)
+{
+}
+
+GroupManager::GroupManager(const Name& prefix, const Name& dataType, const std::string& dbPath,
+                           const int paramLength, const int freshPeriod, KeyChain* keyChain)
+  : m_prefix(prefix)
   , m_db(dbPath)
   , m_paramLength(paramLength)
   , m_freshPeriod(freshPeriod)
+  , m_ownedKeyChain(keyChain == nullptr ? new KeyChain : nullptr)
+  , m_keyChain(keyChain == nullptr ? *m_ownedKeyChain : *keyChain)
+  , m_shardIndex(0)
+  , m_nShards(1)
+  , m_keyRetention(24)
+  , m_timestampNaming(TimestampNaming::Iso)
+  , m_intervalGeneration(m_db.getGeneration())
 {
-  m_namespace.append(NAME_COMPONENT_READ).append(dataType);
+  m_prefix.append(NAME_COMPONENT_READ);
+  m_namespace = m_prefix;
+  m_namespace.append(dataType);
+  m_dataTypes.push_back(dataType);
 }
 
 std::list<Data>
 GroupManager::getGroupKey(const TimeStamp& timeslot)
 {
-  std::map<Name, Buffer> memberKeys;
+  NDN_GEP_SPAN(span, "getGroupKey");
+  std::vector<std::string> scheduleNames;
   std::list<Data> result;
+  // the generation of the schedules and members the group key is created for
+  uint64_t generation = m_db.getGeneration();
+  pruneGroupKeys(timeslot, generation);
 
   // get time interval
-  Interval finalInterval = calculateInterval(timeslot, memberKeys);
-  if (finalInterval.isValid() == false)
+  Interval finalInterval = calculateInterval(timeslot, scheduleNames);
+  if (finalInterval.isValid() == false) {
+    recordGroupKey(timeslot, result.size());
     return result;
+  }
 
-  std::string startTs = boost::posix_time::to_iso_string(finalInterval.getStartTime());
-  std::string endTs = boost::posix_time::to_iso_string(finalInterval.getEndTime());
+  name::Component startTs = encodeTimestamp(finalInterval.getStartTime(), m_timestampNaming);
+  name::Component endTs = encodeTimestamp(finalInterval.getEndTime(), m_timestampNaming);
 
   // generate the pri key and pub key
   Buffer priKeyBuf, pubKeyBuf;
-  generateKeyPairs(priKeyBuf, pubKeyBuf);
+  getKeyPairs(m_namespace, finalInterval, startTs, endTs, generation, priKeyBuf, pubKeyBuf);
 
   // add the first element to the result
   // E-KEY (public key) data packet name convention:
@@ -62,20 +101,181 @@ GroupManager::getGroupKey(const TimeStamp& timeslot)
   Data data = createEKeyData(startTs, endTs, pubKeyBuf);
   result.push_back(data);
 
-  // encrypt pri key with pub key from certificate
-  for (const auto& entry : memberKeys) {
-    const Name& keyName = entry.first;
-    const Buffer& certKey = entry.second;
+  // encrypt pri key with pub key from certificate, reading one member at a time
+  std::set<Name> memberKeyNames;
+  visitMembers(scheduleNames, [&] (const Name& keyName, const uint8_t* key, size_t keySize) {
+      // generate the name of the packet
+      // D-KEY (private key) data packet name convention:
+      // /<data_type>/D-KEY/[start-ts]/[end-ts]/[member-name]
+      result.push_back(createDKeyData(startTs, endTs, keyName, priKeyBuf, Buffer(key, keySize)));
+      if (m_localKeys != nullptr)
+        memberKeyNames.insert(keyName);
+      return true;
+    });
+  NDN_GEP_SPAN_DETAIL(span, std::to_string(result.size() - 1) + " members");
+
+  if (m_localKeys != nullptr)
+    m_localKeys->addGroupKey(data.getName(), pubKeyBuf, priKeyBuf, memberKeyNames);
+  recordGroupKey(timeslot, result.size());
+  return result;
+}
+
+void
+GroupManager::addDataType(const Name& dataType)
+{
+  if (std::find(m_dataTypes.begin(), m_dataTypes.end(), dataType) == m_dataTypes.end())
+    m_dataTypes.push_back(dataType);
+}
+
+std::map<Name, std::list<Data>>
+GroupManager::getGroupKeys(const TimeStamp& timeslot)
+{
+  std::vector<std::string> scheduleNames;
+  std::map<Name, std::list<Data>> result;
+  uint64_t generation = m_db.getGeneration();
+  pruneGroupKeys(timeslot, generation);
+
+  // get time interval, once for all data types
+  Interval finalInterval = calculateInterval(timeslot, scheduleNames);
+  if (finalInterval.isValid() == false)
+    return result;
+
+  name::Component startTs = encodeTimestamp(finalInterval.getStartTime(), m_timestampNaming);
+  name::Component endTs = encodeTimestamp(finalInterval.getEndTime(), m_timestampNaming);
+
+  // encrypt one nonce key for each member, shared by the D-KEYs of all data types
+  algo::EncryptParams eparams(tlv::AlgorithmRsaOaep);
+  std::map<Name, std::pair<Buffer, Block>> memberNonces;
+  std::set<Name> memberKeyNames;
+  visitMembers(scheduleNames, [&] (const Name& keyName, const uint8_t* key, size_t keySize) {
+      auto& nonce = memberNonces[keyName];
+      nonce.second = algo::encryptNonce(nonce.first, keyName, key, keySize, eparams);
+      memberKeyNames.insert(keyName);
+      return true;
+    });
+
+  for (const Name& dataType : m_dataTypes) {
+    Name dataNamespace = m_prefix;
+    dataNamespace.append(dataType);
+    std::list<Data>& groupKey = result[dataType];
+
+    // generate the pri key and pub key
+    Buffer priKeyBuf, pubKeyBuf;
+    getKeyPairs(dataNamespace, finalInterval, startTs, endTs, generation, priKeyBuf, pubKeyBuf);
+
+    Data eKeyData = createEKeyData(dataNamespace, startTs, endTs, pubKeyBuf);
+    groupKey.push_back(eKeyData);
+    if (m_localKeys != nullptr)
+      m_localKeys->addGroupKey(eKeyData.getName(), pubKeyBuf, priKeyBuf, memberKeyNames);
 
-    // generate the name of the packet
     // D-KEY (private key) data packet name convention:
     // /<data_type>/D-KEY/[start-ts]/[end-ts]/[member-name]
-    data = createDKeyData(startTs, endTs, keyName, priKeyBuf, certKey);
-    result.push_back(data);
+    Name dKeyName = dataNamespace;
+    dKeyName.append(NAME_COMPONENT_D_KEY).append(startTs).append(endTs);
+    for (const auto& entry : memberNonces) {
+      Data dKeyData(dKeyName);
+      dKeyData.setFreshnessPeriod(time::hours(m_freshPeriod));
+      algo::encryptDataWithNonce(dKeyData, priKeyBuf.buf(), priKeyBuf.size(), entry.first,
+                                 entry.second.first, entry.second.second);
+      m_keyChain.sign(dKeyData);
+      groupKey.push_back(dKeyData);
+    }
+  }
+  return result;
+}
+
+std::list<Data>
+GroupManager::getGroupKeyBundle(const TimeStamp& from, const TimeStamp& to)
+{
+  std::list<Data> result;
+  uint64_t generation = m_db.getGeneration();
+  pruneGroupKeys(from, generation);
+
+  // member key name => (public key of member, D-KEYs that member can access)
+  std::map<Name, std::pair<Buffer, std::list<std::pair<Name, Buffer>>>> bundles;
+
+  TimeStamp timeslot = from;
+  while (timeslot < to) {
+    std::vector<std::string> scheduleNames;
+    Interval finalInterval = calculateInterval(timeslot, scheduleNames);
+    if (finalInterval.isValid() == false || finalInterval.getEndTime() <= timeslot) {
+      // no member can access the data in this hour, move on to the next one
+      timeslot += boost::posix_time::hours(1);
+      continue;
+    }
+
+    name::Component startTs = encodeTimestamp(finalInterval.getStartTime(), m_timestampNaming);
+    name::Component endTs = encodeTimestamp(finalInterval.getEndTime(), m_timestampNaming);
+
+    Buffer priKeyBuf, pubKeyBuf;
+    getKeyPairs(m_namespace, finalInterval, startTs, endTs, generation, priKeyBuf, pubKeyBuf);
+    Data eKeyData = createEKeyData(startTs, endTs, pubKeyBuf);
+    result.push_back(eKeyData);
+
+    Name dKeyName(m_namespace);
+    dKeyName.append(NAME_COMPONENT_D_KEY).append(startTs).append(endTs);
+    std::set<Name> memberKeyNames;
+    visitMembers(scheduleNames, [&] (const Name& keyName, const uint8_t* key, size_t keySize) {
+        auto& bundle = bundles[keyName];
+        if (bundle.first.empty())
+          bundle.first = Buffer(key, keySize);
+        bundle.second.push_back(std::make_pair(dKeyName, priKeyBuf));
+        memberKeyNames.insert(keyName);
+        return true;
+      });
+    if (m_localKeys != nullptr)
+      m_localKeys->addGroupKey(eKeyData.getName(), pubKeyBuf, priKeyBuf, memberKeyNames);
+
+    timeslot = finalInterval.getEndTime();
+  }
+
+  name::Component fromTs = encodeTimestamp(from, m_timestampNaming);
+  name::Component toTs = encodeTimestamp(to, m_timestampNaming);
+  for (const auto& entry : bundles) {
+    // D-KEY bundle data packet name convention:
+    // /<data_type>/D-KEY-BUNDLE/[from-ts]/[to-ts]/FOR/[member-name]/[segment]
+    result.splice(result.end(), createDKeyBundleData(fromTs, toTs, entry.first,
+                                                     entry.second.second, entry.second.first));
   }
   return result;
 }
 
+void
+GroupManager::setShard(size_t shardIndex, size_t nShards, const time::hours& keyRetention)
+{
+  BOOST_ASSERT(nShards > 0 && shardIndex < nShards);
+  m_shardIndex = shardIndex;
+  m_nShards = nShards;
+  m_keyRetention = keyRetention;
+}
+
+void
+GroupManager::setTimestampNaming(TimestampNaming naming)
+{
+  m_timestampNaming = naming;
+}
+
+void
+GroupManager::setLocalKeyRegistry(const shared_ptr<LocalKeyRegistry>& localKeys)
+{
+  m_localKeys = localKeys;
+}
+
+void
+GroupManager::setTraceRecorder(const shared_ptr<TraceRecorder>& traceRecorder)
+{
+  m_trace = traceRecorder;
+}
+
+void
+GroupManager::recordGroupKey(const TimeStamp& timeslot, size_t nPackets)
+{
+  if (m_trace == nullptr)
+    return;
+
+  m_trace->record(trace::GroupKey, m_namespace, Name(), toTimePoint(timeslot), nPackets);
+}
+
 void
 GroupManager::addSchedule(const std::string& scheduleName, const Schedule& schedule)
 {
@@ -113,39 +313,79 @@ GroupManager::updateMemberSchedule(const Name& identity, const std::string& sche
   m_db.updateMemberSchedule(identity, scheduleName);
 }
 
+void
+GroupManager::exportSnapshot(const std::string& path) const
+{
+  m_db.exportSnapshot(path);
+}
+
+void
+GroupManager::importSnapshot(const std::string& path)
+{
+  m_db.importSnapshot(path);
+}
+
 Interval
 GroupManager::calculateInterval(const TimeStamp& timeslot, std::map<Name, Buffer>& memberKeys)
 {
+  std::vector<std::string> scheduleNames;
+  Interval finalInterval = calculateInterval(timeslot, scheduleNames);
+
+  memberKeys.clear();
+  visitMembers(scheduleNames,
+               [&memberKeys] (const Name& keyName, const uint8_t* key, size_t keySize) {
+                 memberKeys.insert(std::make_pair(keyName, Buffer(key, keySize)));
+                 return true;
+               });
+  return finalInterval;
+}
+
+Interval
+GroupManager::calculateInterval(const TimeStamp& timeslot, std::vector<std::string>& scheduleNames)
+{
+  NDN_GEP_SPAN(span, "calculateInterval");
+  uint64_t generation = m_db.getGeneration();
+  if (generation != m_intervalGeneration) {
+    m_intervals.clear();
+    m_intervalGeneration = generation;
+  }
+
+  // reuse the interval calculated before if it covers the timeslot
+  auto cached = m_intervals.upper_bound(timeslot);
+  if (cached != m_intervals.begin() && (--cached)->second.first.covers(timeslot)) {
+    NDN_GEP_SPAN_DETAIL(span, "cached");
+    scheduleNames = cached->second.second;
+    return cached->second.first;
+  }
+
   // prepare
   Interval positiveResult;
   Interval negativeResult;
-  Interval tempInterval;
   Interval finalInterval;
-  bool isPositive;
-  memberKeys.clear();
-
-  // get the all intervals from schedules
-  for (const std::string& scheduleName : m_db.listAllScheduleNames()) {
-
-    const Schedule& schedule = m_db.getSchedule(scheduleName);
-    std::tie(isPositive, tempInterval) = schedule.getCoveringInterval(timeslot);
+  scheduleNames.clear();
 
-    if (isPositive) {
-      if (!positiveResult.isValid())
-        positiveResult = tempInterval;
-      positiveResult && tempInterval;
+  // get the all intervals from schedules, reading the schedules in one pass
+  m_db.visitSchedules([&] (const std::string& scheduleName, const Block& scheduleBlock) {
+      bool isPositive;
+      Interval tempInterval;
+      std::tie(isPositive, tempInterval) = Schedule(scheduleBlock).getCoveringInterval(timeslot);
 
-      std::map<Name, Buffer> m = m_db.getScheduleMembers(scheduleName);
-      memberKeys.insert(m.begin(), m.end());
-    }
-    else {
-      if (!negativeResult.isValid())
-        negativeResult = tempInterval;
-      negativeResult && tempInterval;
-    }
-  }
+      if (isPositive) {
+        if (!positiveResult.isValid())
+          positiveResult = tempInterval;
+        positiveResult && tempInterval;
+        scheduleNames.push_back(scheduleName);
+      }
+      else {
+        if (!negativeResult.isValid())
+          negativeResult = tempInterval;
+        negativeResult && tempInterval;
+      }
+      return true;
+    });
   if (!positiveResult.isValid()) {
     // return invalid interval when there is no member has interval covering the time slot
+    scheduleNames.clear();
     return Interval(false);
   }
 
@@ -155,12 +395,83 @@ GroupManager::calculateInterval(const TimeStamp& timeslot, std::map<Name, Buffer
   else
     finalInterval = positiveResult;
 
+  if (m_intervals.size() >= MAX_CACHED_INTERVALS)
+    m_intervals.clear();
+  m_intervals[finalInterval.getStartTime()] = std::make_pair(finalInterval, scheduleNames);
   return finalInterval;
 }
 
+void
+GroupManager::visitMembers(const std::vector<std::string>& scheduleNames,
+                           const GroupManagerDB::MemberVisitor& visitor) const
+{
+  bool isStopped = false;
+  for (const std::string& scheduleName : scheduleNames) {
+    m_db.visitScheduleMembers(scheduleName,
+                              [&] (const Name& keyName, const uint8_t* key, size_t keySize) {
+                                if (!isInShard(keyName))
+                                  return true;
+                                isStopped = !visitor(keyName, key, keySize);
+                                return !isStopped;
+                              });
+    if (isStopped)
+      return;
+  }
+}
+
+bool
+GroupManager::isInShard(const Name& keyName) const
+{
+  if (m_nShards <= 1)
+    return true;
+
+  // FNV-1a of the encoded name, which is the same in all the processes
+  const Block& wire = keyName.wireEncode();
+  uint64_t hash = 14695981039346656037ULL;
+  for (const uint8_t* it = wire.wire(); it != wire.wire() + wire.size(); it++) {
+    hash ^= *it;
+    hash *= 1099511628211ULL;
+  }
+  return hash % m_nShards == m_shardIndex;
+}
+
+void
+GroupManager::pruneGroupKeys(const TimeStamp& timeslot, uint64_t generation)
+{
+  if (m_nShards <= 1)
+    return;
+
+  // keep the key pairs of the intervals ended within the retention, which the shards still
+  // serving an earlier timeslot agree on
+  m_db.pruneGroupKeys(timeslot - boost::posix_time::hours(m_keyRetention.count()), generation);
+}
+
+void
+GroupManager::getKeyPairs(const Name& dataNamespace, const Interval& interval,
+                          const name::Component& startTs, const name::Component& endTs,
+                          uint64_t generation, Buffer& priKeyBuf, Buffer& pubKeyBuf)
+{
+  if (m_nShards <= 1) {
+    generateKeyPairs(priKeyBuf, pubKeyBuf);
+    return;
+  }
+
+  // the shards use the key pair stored first in the database they share, until the
+  // schedules or members change and a new generation gets a new key pair
+  Name eKeyName(dataNamespace);
+  eKeyName.append(NAME_COMPONENT_E_KEY).append(startTs).append(endTs);
+  if (m_db.getGroupKey(eKeyName, generation, priKeyBuf, pubKeyBuf))
+    return;
+
+  generateKeyPairs(priKeyBuf, pubKeyBuf);
+  m_db.addGroupKey(eKeyName, generation, interval.getEndTime(), priKeyBuf, pubKeyBuf);
+  m_db.getGroupKey(eKeyName, generation, priKeyBuf, pubKeyBuf);
+}
+
 void
 GroupManager::generateKeyPairs(Buffer& priKeyBuf, Buffer& pubKeyBuf) const
 {
+  NDN_GEP_SPAN(span, "generateKeyPairs");
   RandomNumberGenerator rng;
   RsaKeyParams params(m_paramLength);
   DecryptKey<algo::Rsa> privateKey = algo::Rsa::generateKey(rng, params);
@@ -171,10 +482,18 @@ GroupManager::generateKeyPairs(Buffer& priKeyBuf, Buffer& pubKeyBuf) const
 
 
 Data
-GroupManager::createEKeyData(const std::string& startTs, const std::string& endTs,
+GroupManager::createEKeyData(const name::Component& startTs, const name::Component& endTs,
                              const Buffer& pubKeyBuf)
 {
-  Name name(m_namespace);
+  return createEKeyData(m_namespace, startTs, endTs, pubKeyBuf);
+}
+
+Data
+GroupManager::createEKeyData(const Name& dataNamespace, const name::Component& startTs,
+                             const name::Component& endTs, const Buffer& pubKeyBuf)
+{
+  NDN_GEP_SPAN(span, "createEKeyData");
+  Name name(dataNamespace);
   name.append(NAME_COMPONENT_E_KEY).append(startTs).append(endTs);
   Data data(name);
   data.setFreshnessPeriod(time::hours(m_freshPeriod));
@@ -184,10 +503,11 @@ GroupManager::createEKeyData(const std::string& startTs, const std::string& endT
 }
 
 Data
-GroupManager::createDKeyData(const std::string& startTs, const std::string& endTs,
+GroupManager::createDKeyData(const name::Component& startTs, const name::Component& endTs,
                              const Name& keyName, const Buffer& priKeyBuf,
                              const Buffer& certKey)
 {
+  NDN_GEP_SPAN(span, "createDKeyData");
   Name name(m_namespace);
   name.append(NAME_COMPONENT_D_KEY);
   name.append(startTs).append(endTs);
@@ -200,5 +520,56 @@ GroupManager::createDKeyData(const std::string& startTs, const std::string& endT
   return data;
 }
 
+std::list<Data>
+GroupManager::createDKeyBundleData(const name::Component& fromTs, const name::Component& toTs,
+                                   const Name& keyName,
+                                   const std::list<std::pair<Name, Buffer>>& dKeys,
+                                   const Buffer& certKey)
+{
+  // split the D-KEYs into segments, each of which is a bundle of its own
+  std::vector<Block> segments;
+  Block bundle(tlv::DKeyBundle);
+  size_t bundleSize = 0;
+  for (const auto& dKey : dKeys) {
+    Block entry(tlv::DKeyEntry);
+    entry.push_back(dKey.first.wireEncode());
+    entry.push_back(makeBinaryBlock(tlv::DKeyBits, dKey.second.buf(), dKey.second.size()));
+    entry.encode();
+
+    if (bundleSize > 0 && bundleSize + entry.size() > MAX_BUNDLE_SEGMENT_SIZE) {
+      bundle.encode();
+      segments.push_back(bundle);
+      bundle = Block(tlv::DKeyBundle);
+      bundleSize = 0;
+    }
+    bundle.push_back(entry);
+    bundleSize += entry.size();
+  }
+  bundle.encode();
+  segments.push_back(bundle);
+
+  // the nonce key is encrypted once using public key of the member, for all the segments
+  algo::EncryptParams eparams(tlv::AlgorithmRsaOaep);
+  Buffer nonceKey;
+  Block encryptedNonce = algo::encryptNonce(nonceKey, keyName, certKey.buf(), certKey.size(),
+                                            eparams);
+
+  Name name(m_namespace);
+  name.append(NAME_COMPONENT_D_KEY_BUNDLE);
+  name.append(fromTs).append(toTs);
+  std::list<Data> result;
+  for (size_t segmentNo = 0; segmentNo < segments.size(); segmentNo++) {
+    Data data = Data(name);
+    data.setFreshnessPeriod(time::hours(m_freshPeriod));
+    algo::encryptDataWithNonce(data, segments[segmentNo].wire(), segments[segmentNo].size(),
+                               keyName, nonceKey, encryptedNonce);
+    data.setName(Name(data.getName()).appendSegment(segmentNo));
+    data.setFinalBlockId(name::Component::fromSegment(segments.size() - 1));
+    m_keyChain.sign(data);
+    result.push_back(data);
+  }
+  return result;
+}
+
 } // namespace ndn
 } // namespace ndn
@@ -23,6 +23,9 @@
 #define NDN_GEP_GROUP_MANAGER_HPP
 
 #include "group-manager-db.hpp"
+#include "local-key-registry.hpp"
+#include "trace-recorder.hpp"
+#include "timestamp-name.hpp"
 #include "algo/rsa.hpp"
 
 #include <ndn-cxx/security/key-chain.hpp>
@@ -56,13 +59,23 @@ public:
   GroupManager(const Name& prefix, const Name& dataType, const std::string& dbPath,
                const int paramLength, const int freshPeriod);
 
+  /**
+   * @brief Create group manager signing packets with @p keyChain
+   *
+   * @p keyChain can be shared with other instances in the process, and must outlive the
+   * group manager.
+   */
+  GroupManager(const Name& prefix, const Name& dataType, const std::string& dbPath,
+               const int paramLength, const int freshPeriod, KeyChain& keyChain);
+
   /**
    * @brief Create a group key for interval which
    *        @p timeslot falls into
    *
    * This method creates a group key if it does not
    * exist, and encrypts the key using public key of
-   * all eligible members
+   * all eligible members. The key pair is not shared with getGroupKeyBundle(), unless the
+   * group manager is sharded.
    *
    * @returns The group key (the first one is the
    *          public key, and the rest are encrypted
@@ -71,6 +84,97 @@ public:
   std::list<Data>
   getGroupKey(const TimeStamp& timeslot);
 
+  /**
+   * @brief Serve the group keys of @p dataType under the same prefix as well
+   *
+   * All the data types share the members and schedules of the group manager.
+   */
+  void
+  addDataType(const Name& dataType);
+
+  /**
+   * @brief Create the group keys of all data types for interval which
+   *        @p timeslot falls into
+   *
+   * The interval and the eligible members are calculated once for all
+   * data types. A nonce key is encrypted once using public key of each
+   * member, and shared by the D-KEYs of all data types for the member.
+   *
+   * @returns The group keys of each data type, in the same order as
+   *          getGroupKey() returns them.
+   */
+  std::map<Name, std::list<Data>>
+  getGroupKeys(const TimeStamp& timeslot);
+
+  /**
+   * @brief Create group keys for all intervals between @p from and @p to, and bundle the
+   *        D-KEYs of each member
+   *
+   * A group key is created for each interval in which at least one member is allowed to
+   * access the data. The private keys of all the intervals that a member can access are
+   * encrypted together using the public key of the member. The bundle of a member is split
+   * into segments that fit in a packet each, named by segment number and carrying the
+   * FinalBlockId of the bundle.
+   *
+   * The E-KEYs returned are the ones the D-KEYs of the bundles go with, and replace the
+   * E-KEYs getGroupKey() creates for the same intervals: unless the group manager is sharded,
+   * every call generates new key pairs, so the E-KEYs of one call do not match the D-KEYs of
+   * another. Publish the E-KEYs and the bundles of the same call together.
+   *
+   * @returns The group keys (the E-KEYs of the intervals, followed by the segments of the
+   *          D-KEY bundle of each member.)
+   */
+  std::list<Data>
+  getGroupKeyBundle(const TimeStamp& from, const TimeStamp& to);
+
+  /**
+   * @brief Make the group manager shard @p shardIndex of @p nShards sharing the database
+   *
+   * The shards agree on one group key per interval through the database, and each of them
+   * creates the D-KEYs of the members whose key name hashes to its index only. The E-KEY
+   * is created by every shard. A single shard (default) generates a new group key for
+   * every call.
+   *
+   * The agreed key pairs, private keys included, are stored unencrypted in the database, so
+   * the database file must be protected as the group private keys are. The key pairs of the
+   * intervals ending more than @p keyRetention before the timeslot of a call, and those
+   * agreed on before a change of the schedules or members, are deleted by every call. A
+   * shard serving a timeslot earlier than the others by less than @p keyRetention still
+   * finds the key pair they agreed on.
+   *
+   * @pre shardIndex < nShards
+   */
+  void
+  setShard(size_t shardIndex, size_t nShards,
+           const time::hours& keyRetention = time::hours(24));
+
+  /**
+   * @brief Encode the timestamps in the E-KEY, D-KEY and D-KEY bundle names with @p naming
+   *
+   * Binary timestamps make the names shorter and cheaper to encode and parse. Producers
+   * and consumers of the group should use the same naming. TimestampNaming::Iso is the
+   * default.
+   */
+  void
+  setTimestampNaming(TimestampNaming naming);
+
+  /**
+   * @brief Register the group keys created afterwards in @p localKeys
+   *
+   * Producers and consumers in the same process then get the keys from @p localKeys
+   * without retrieving them from the network.
+   */
+  void
+  setLocalKeyRegistry(const shared_ptr<LocalKeyRegistry>& localKeys);
+
+  /**
+   * @brief Record the calls and key events afterwards in @p traceRecorder
+   *
+   * @p traceRecorder of nullptr (default) disables recording.
+   */
+  void
+  setTraceRecorder(const shared_ptr<TraceRecorder>& traceRecorder);
+
   /// @brief Add @p schedule with @p scheduleName
   void
   addSchedule(const std::string& scheduleName, const Schedule& schedule);
@@ -95,6 +199,49 @@ public:
   void
   updateMemberSchedule(const Name& identity, const std::string& scheduleName);
 
+  /// @brief Write the schedules and members of the group to a snapshot at @p path
+  void
+  exportSnapshot(const std::string& path) const;
+
+  /**
+   * @brief Replace the schedules and members of the group with the snapshot at @p path
+   *
+   * @throw GroupManagerDB::Error if the snapshot cannot be read or is malformed
+   */
+  void
+  importSnapshot(const std::string& path);
+
+private:
+  GroupManager(const Name& prefix, const Name& dataType, const std::string& dbPath,
+               const int paramLength, const int freshPeriod, KeyChain* keyChain);
+
+  /// @brief Record the group key of @p timeslot made of @p nPackets in the trace, if any
+  void
+  recordGroupKey(const TimeStamp& timeslot, size_t nPackets);
+
+  /**
+   * @brief Delete the key pairs shared by the shards of the intervals ending more than the
+   *        retention before @p timeslot, and those created before @p generation
+   */
+  void
+  pruneGroupKeys(const TimeStamp& timeslot, uint64_t generation);
+
+  /// @brief Check if the D-KEY of the member with @p keyName is created by this shard
+  bool
+  isInShard(const Name& keyName) const;
+
+  /**
+   * @brief Get the key pair of the group key of @p interval under @p dataNamespace, from
+   *        @p startTs to @p endTs
+   *
+   * The key pair is shared through the database when the group manager is sharded, as long
+   * as the schedules and members stay at @p generation, otherwise a new one is generated.
+   */
+  void
+  getKeyPairs(const Name& dataNamespace, const Interval& interval,
+              const name::Component& startTs, const name::Component& endTs,
+              uint64_t generation, Buffer& priKeyBuf, Buffer& pubKeyBuf);
+
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   /**
    * @brief Calculate interval that covers @p timeslot
@@ -103,6 +250,25 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   Interval
   calculateInterval(const TimeStamp& timeslot, std::map<Name, Buffer>& certMap);
 
+  /**
+   * @brief Calculate interval that covers @p timeslot
+   * and fill @p scheduleNames with the schedules whose members are allowed to access it.
+   *
+   * The result is kept until the schedules or members in the database change, and is
+   * returned for any timeslot the interval covers.
+   */
+  Interval
+  calculateInterval(const TimeStamp& timeslot, std::vector<std::string>& scheduleNames);
+
+  /**
+   * @brief Invoke @p visitor for each member of the schedules @p scheduleNames
+   *
+   * The members are read from the database one at a time.
+   */
+  void
+  visitMembers(const std::vector<std::string>& scheduleNames,
+               const GroupManagerDB::MemberVisitor& visitor) const;
+
   /**
    * @brief Generate rsa key pairs according to the member variable m_paramLength.
    * @p priKeyBuf The generated private key buffer
@@ -113,21 +279,51 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
 
   /// @brief Create E-KEY data.
   Data
-  createEKeyData(const std::string& startTs, const std::string& endTs,
+  createEKeyData(const name::Component& startTs, const name::Component& endTs,
+                 const Buffer& pubKeyBuf);
+
+  /// @brief Create E-KEY data under @p dataNamespace.
+  Data
+  createEKeyData(const Name& dataNamespace, const name::Component& startTs, const name::Component& endTs,
                  const Buffer& pubKeyBuf);
 
   /// @brief Create D-KEY data.
   Data
-  createDKeyData(const std::string& startTs, const std::string& endTs, const Name& keyName,
+  createDKeyData(const name::Component& startTs, const name::Component& endTs, const Name& keyName,
                  const Buffer& priKeyBuf, const Buffer& certKey);
 
+  /**
+   * @brief Create D-KEY bundle data.
+   *
+   * @p dKeys contains the names and private key bits of the D-KEYs in the bundle. The bundle
+   * is split into segments, each carrying the D-KEYs that fit in one packet and decrypting
+   * on its own.
+   */
+  std::list<Data>
+  createDKeyBundleData(const name::Component& fromTs, const name::Component& toTs, const Name& keyName,
+                       const std::list<std::pair<Name, Buffer>>& dKeys, const Buffer& certKey);
+
 private:
+  Name m_prefix;
   Name m_namespace;
+  std::vector<Name> m_dataTypes;
   GroupManagerDB m_db;
   int m_paramLength;
   int m_freshPeriod;
 
-  KeyChain m_keyChain;
+  unique_ptr<KeyChain> m_ownedKeyChain;
+  KeyChain& m_keyChain;
+  size_t m_shardIndex;
+  size_t m_nShards;
+  time::hours m_keyRetention;
+  TimestampNaming m_timestampNaming;
+
+  /// @brief Calculated intervals by start time, with the schedules allowed to access them
+  std::map<TimeStamp, std::pair<Interval, std::vector<std::string>>> m_intervals;
+  /// @brief The generation of the database when m_intervals were calculated
+  uint64_t m_intervalGeneration;
+  shared_ptr<LocalKeyRegistry> m_localKeys;
+  shared_ptr<TraceRecorder> m_trace;
 };
 
 } // namespace gep
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "local-key-registry.hpp"
+#include "timestamp-name.hpp"
+
+namespace ndn {
+namespace gep {
+
+static const int START_TS_INDEX = -2;
+static const int END_TS_INDEX = -1;
+
+void
+LocalKeyRegistry::addGroupKey(const Name& eKeyName, const Buffer& eKeyBits,
+                              const Buffer& dKeyBits, const std::set<Name>& memberKeyNames)
+{
+  GroupKey groupKey;
+  groupKey.beginTimeslot = decodeTimestamp(eKeyName.get(START_TS_INDEX));
+  groupKey.endTimeslot = decodeTimestamp(eKeyName.get(END_TS_INDEX));
+  groupKey.eKeyBits = eKeyBits;
+  groupKey.dKeyBits = dKeyBits;
+  // the identity of a member is its key name without the last component, as
+  // GroupManagerDB::addMember derives it
+  for (const Name& memberKeyName : memberKeyNames)
+    groupKey.memberIdentities.insert(memberKeyName.getPrefix(-1));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_groupKeys[eKeyName] = std::move(groupKey);
+}
+
+void
+LocalKeyRegistry::addContentKey(const Name& cKeyName, const Name& eKeyName,
+                                const Buffer& cKeyBits)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ContentKey& contentKey = m_contentKeys[cKeyName];
+  contentKey.keyBits = cKeyBits;
+  contentKey.eKeyNames.insert(eKeyName);
+}
+
+bool
+LocalKeyRegistry::getEKey(const Name& nodeName, const time::system_clock::TimePoint& timeslot,
+                          Name& eKeyName, Buffer& eKeyBits) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // the E-KEYs of the node are stored consecutively, ordered by their start time
+  for (auto it = m_groupKeys.lower_bound(nodeName);
+       it != m_groupKeys.end() && nodeName.isPrefixOf(it->first); ++it) {
+    if (it->first.size() != nodeName.size() + 2)
+      continue;
+
+    const GroupKey& groupKey = it->second;
+    if (timeslot >= groupKey.beginTimeslot && timeslot < groupKey.endTimeslot) {
+      eKeyName = it->first;
+      eKeyBits = groupKey.eKeyBits;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+LocalKeyRegistry::getDKey(const Name& dKeyName, const Name& consumerName,
+                          Buffer& dKeyBits) const
+{
+  // D-KEY name convention: /<data_type>/D-KEY/[start-ts]/[end-ts]
+  Name eKeyName = dKeyName.getPrefix(-3);
+  eKeyName.append(NAME_COMPONENT_E_KEY).append(dKeyName.getSubName(-2));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_groupKeys.find(eKeyName);
+  if (it == m_groupKeys.end() || !isMember(it->second, consumerName))
+    return false;
+
+  dKeyBits = it->second.dKeyBits;
+  return true;
+}
+
+bool
+LocalKeyRegistry::getCKey(const Name& cKeyName, const Name& consumerName,
+                          Buffer& cKeyBits) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_contentKeys.find(cKeyName);
+  if (it == m_contentKeys.end())
+    return false;
+
+  for (const Name& eKeyName : it->second.eKeyNames) {
+    auto groupKey = m_groupKeys.find(eKeyName);
+    if (groupKey != m_groupKeys.end() && isMember(groupKey->second, consumerName)) {
+      cKeyBits = it->second.keyBits;
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+LocalKeyRegistry::removeBefore(const time::system_clock::TimePoint& timeslot)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_groupKeys.begin(); it != m_groupKeys.end();) {
+    if (it->second.endTimeslot <= timeslot)
+      it = m_groupKeys.erase(it);
+    else
+      ++it;
+  }
+
+  for (auto it = m_contentKeys.begin(); it != m_contentKeys.end();) {
+    std::set<Name>& eKeyNames = it->second.eKeyNames;
+    for (auto eKeyName = eKeyNames.begin(); eKeyName != eKeyNames.end();) {
+      if (m_groupKeys.count(*eKeyName) == 0)
+        eKeyName = eKeyNames.erase(eKeyName);
+      else
+        ++eKeyName;
+    }
+    if (eKeyNames.empty())
+      it = m_contentKeys.erase(it);
+    else
+      ++it;
+  }
+}
+
+void
+LocalKeyRegistry::removeContentKeysBefore(const Name& cKeyPrefix,
+                                          const time::system_clock::TimePoint& timeslot)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // the C-KEYs of the producer are stored consecutively, ordered by their timeslot
+  for (auto it = m_contentKeys.lower_bound(cKeyPrefix);
+       it != m_contentKeys.end() && cKeyPrefix.isPrefixOf(it->first);) {
+    if (it->first.size() > cKeyPrefix.size() &&
+        decodeTimestamp(it->first.get(cKeyPrefix.size())) < timeslot)
+      it = m_contentKeys.erase(it);
+    else
+      ++it;
+  }
+}
+
+void
+LocalKeyRegistry::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_groupKeys.clear();
+  m_contentKeys.clear();
+}
+
+bool
+LocalKeyRegistry::isMember(const GroupKey& groupKey, const Name& consumerName) const
+{
+  // exact match: a shorter prefix of the identity of a member is not the member
+  return groupKey.memberIdentities.count(consumerName) > 0;
+}
+
+} // namespace gep
+} // namespace ndn
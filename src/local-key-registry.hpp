@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_LOCAL_KEY_REGISTRY_HPP
+#define NDN_GEP_LOCAL_KEY_REGISTRY_HPP
+
+#include "common.hpp"
+
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <mutex>
+
+namespace ndn {
+namespace gep {
+
+/**
+ * @brief Registry of the keys of group managers, producers and consumers in one process
+ *
+ * A group manager registers its group keys together with the members allowed to access
+ * them, and a producer registers the content keys it encrypts with the E-KEYs. Producers
+ * and consumers in the same process look up the registry before retrieving a key from
+ * the network, and get the key bits directly without packet encoding, signing, validation
+ * or decryption. The access control of the network is kept: a consumer gets a D-KEY only
+ * if it is a member of the group, and a C-KEY only if it can get one of the D-KEYs that
+ * the C-KEY is encrypted for.
+ *
+ * The registry can be shared by instances running in different threads.
+ */
+class LocalKeyRegistry : noncopyable
+{
+public:
+  /**
+   * @brief Register the group key with E-KEY @p eKeyName
+   *
+   * @p eKeyName follows the convention /<data_type>/E-KEY/[start-ts]/[end-ts].
+   * @p memberKeyNames are the names of the keys of the members allowed to get the D-KEY.
+   */
+  void
+  addGroupKey(const Name& eKeyName, const Buffer& eKeyBits, const Buffer& dKeyBits,
+              const std::set<Name>& memberKeyNames);
+
+  /**
+   * @brief Register the C-KEY @p cKeyName encrypted with E-KEY @p eKeyName
+   */
+  void
+  addContentKey(const Name& cKeyName, const Name& eKeyName, const Buffer& cKeyBits);
+
+  /**
+   * @brief Get the E-KEY of node @p nodeName covering @p timeslot
+   *
+   * @p nodeName follows the convention /<data_type>/E-KEY.
+   * @return false if no registered E-KEY of the node covers @p timeslot, otherwise set
+   *         @p eKeyName and @p eKeyBits and return true.
+   */
+  bool
+  getEKey(const Name& nodeName, const time::system_clock::TimePoint& timeslot,
+          Name& eKeyName, Buffer& eKeyBits) const;
+
+  /**
+   * @brief Get the D-KEY @p dKeyName for consumer @p consumerName
+   *
+   * @return false if the D-KEY is unknown or @p consumerName is not a member of the group,
+   *         otherwise set @p dKeyBits and return true.
+   */
+  bool
+  getDKey(const Name& dKeyName, const Name& consumerName, Buffer& dKeyBits) const;
+
+  /**
+   * @brief Get the C-KEY @p cKeyName for consumer @p consumerName
+   *
+   * @return false if the C-KEY is unknown or @p consumerName cannot get any D-KEY that the
+   *         C-KEY is encrypted for, otherwise set @p cKeyBits and return true.
+   */
+  bool
+  getCKey(const Name& cKeyName, const Name& consumerName, Buffer& cKeyBits) const;
+
+  /**
+   * @brief Remove the group keys of the intervals ending at or before @p timeslot
+   *
+   * The C-KEYs left without any registered E-KEY they are encrypted with, which no consumer
+   * can get anymore, are removed as well.
+   */
+  void
+  removeBefore(const time::system_clock::TimePoint& timeslot);
+
+  /**
+   * @brief Remove the C-KEYs under @p cKeyPrefix of the timeslots before @p timeslot
+   *
+   * @p cKeyPrefix follows the convention /<producer-prefix>/SAMPLE/<data_type>/C-KEY. The
+   * group keys and the C-KEYs of other producers are kept, so that a producer pruning its
+   * own keys does not evict the keys that other users of the registry still need; those
+   * are removed by the owner of the registry with removeBefore.
+   */
+  void
+  removeContentKeysBefore(const Name& cKeyPrefix,
+                          const time::system_clock::TimePoint& timeslot);
+
+  /// @brief Remove all the registered keys
+  void
+  clear();
+
+private:
+  struct GroupKey
+  {
+    time::system_clock::TimePoint beginTimeslot;
+    time::system_clock::TimePoint endTimeslot;
+    Buffer eKeyBits;
+    Buffer dKeyBits;
+    // the identities of the members, their key names without the last component
+    std::set<Name> memberIdentities;
+  };
+
+  struct ContentKey
+  {
+    Buffer keyBits;
+    std::set<Name> eKeyNames;
+  };
+
+  bool
+  isMember(const GroupKey& groupKey, const Name& consumerName) const;
+
+private:
+  mutable std::mutex m_mutex;
+  // E-KEY name => group key
+  std::map<Name, GroupKey> m_groupKeys;
+  // C-KEY name => content key
+  std::map<Name, ContentKey> m_contentKeys;
+};
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_LOCAL_KEY_REGISTRY_HPP
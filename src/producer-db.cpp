@@ -40,7 +40,17 @@ static const std::string INITIALIZATION =
   "    key              BLOB NOT NULL                 \n"
   "  );                                               \n"
   "CREATE UNIQUE INDEX IF NOT EXISTS                  \n"
-  "   timeslotIndex ON contentkeys(timeslot);         \n";
+  "   timeslotIndex ON contentkeys(timeslot);         \n"
+  "CREATE TABLE IF NOT EXISTS                         \n"
+  "  ekeys(                                           \n"
+  "    rowId            INTEGER PRIMARY KEY,          \n"
+  "    node_name        BLOB NOT NULL,                \n"
+  "    begin_timeslot   INTEGER NOT NULL,             \n"
+  "    end_timeslot     INTEGER NOT NULL,             \n"
+  "    key              BLOB NOT NULL                 \n"
+  "  );                                               \n"
+  "CREATE UNIQUE INDEX IF NOT EXISTS                  \n"
+  "   nodeNameIndex ON ekeys(node_name);              \n";
 
 class ProducerDB::Impl
 {
@@ -64,6 +74,10 @@ public:
     // enable foreign key
     sqlite3_exec(m_database, "PRAGMA foreign_keys = ON", nullptr, nullptr, nullptr);
 
+    // let the pages freed by pruned content keys be released incrementally, this only takes
+    // effect on a new database
+    sqlite3_exec(m_database, "PRAGMA auto_vacuum = INCREMENTAL", nullptr, nullptr, nullptr);
+
     // initialize database specific tables
     char* errorMessage = nullptr;
     result = sqlite3_exec(m_database, INITIALIZATION.c_str(), nullptr, nullptr, &errorMessage);
@@ -147,5 +161,92 @@ ProducerDB::deleteContentKey(const system_clock::TimePoint& timeslot)
   statement.step();
 }
 
+size_t
+ProducerDB::deleteContentKeysBefore(const system_clock::TimePoint& timeslot, size_t limit)
+{
+  int32_t fixedTimeslot = getFixedTimeslot(timeslot);
+  // a negative LIMIT means no limit
+  Sqlite3Statement statement(m_impl->m_database,
+                             "DELETE FROM contentkeys WHERE rowId IN\
+                              (SELECT rowId FROM contentkeys WHERE timeslot<?\
+                               ORDER BY timeslot LIMIT ?)");
+  statement.bind(1, fixedTimeslot);
+  sqlite3_bind_int64(statement, 2, limit == 0 ? -1 : static_cast<sqlite3_int64>(limit));
+  if (statement.step() != SQLITE_DONE)
+    BOOST_THROW_EXCEPTION(Error("Cannot delete the keys from database"));
+  return sqlite3_changes(m_impl->m_database);
+}
+
+size_t
+ProducerDB::getContentKeyCount() const
+{
+  Sqlite3Statement statement(m_impl->m_database, "SELECT count(*) FROM contentkeys");
+  return statement.step() == SQLITE_ROW ? statement.getInt(0) : 0;
+}
+
+void
+ProducerDB::compact(size_t nPages)
+{
+  std::string sql = "PRAGMA incremental_vacuum";
+  if (nPages > 0)
+    sql += "(" + std::to_string(nPages) + ")";
+  sqlite3_exec(m_impl->m_database, sql.c_str(), nullptr, nullptr, nullptr);
+}
+
+bool
+ProducerDB::hasEKey(const Name& nodeName) const
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "SELECT rowId FROM ekeys WHERE node_name=?");
+  statement.bind(1, nodeName.wireEncode(), SQLITE_TRANSIENT);
+  return (statement.step() == SQLITE_ROW);
+}
+
+std::tuple<system_clock::TimePoint, system_clock::TimePoint, Buffer>
+ProducerDB::getEKey(const Name& nodeName) const
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "SELECT begin_timeslot, end_timeslot, key\
+                              FROM ekeys WHERE node_name=?");
+  statement.bind(1, nodeName.wireEncode(), SQLITE_TRANSIENT);
+
+  if (statement.step() != SQLITE_ROW)
+    BOOST_THROW_EXCEPTION(Error("Cannot get the E-KEY from database"));
+
+  // timeslots are stored as milliseconds since the unix epoch
+  system_clock::TimePoint begin =
+    time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64(statement, 0)));
+  system_clock::TimePoint end =
+    time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64(statement, 1)));
+  return std::make_tuple(begin, end, Buffer(statement.getBlob(2), statement.getSize(2)));
+}
+
+void
+ProducerDB::addEKey(const Name& nodeName,
+                    const system_clock::TimePoint& beginTimeslot,
+                    const system_clock::TimePoint& endTimeslot,
+                    const Buffer& key)
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "INSERT OR REPLACE INTO ekeys\
+                              (node_name, begin_timeslot, end_timeslot, key)\
+                              values (?, ?, ?, ?)");
+  statement.bind(1, nodeName.wireEncode(), SQLITE_TRANSIENT);
+  sqlite3_bind_int64(statement, 2, time::toUnixTimestamp(beginTimeslot).count());
+  sqlite3_bind_int64(statement, 3, time::toUnixTimestamp(endTimeslot).count());
+  statement.bind(4, key.buf(), key.size(), SQLITE_TRANSIENT);
+  if (statement.step() != SQLITE_DONE)
+    BOOST_THROW_EXCEPTION(Error("Cannot add the E-KEY to database"));
+}
+
+void
+ProducerDB::deleteEKey(const Name& nodeName)
+{
+  Sqlite3Statement statement(m_impl->m_database,
+                             "DELETE FROM ekeys WHERE node_name=?");
+  statement.bind(1, nodeName.wireEncode(), SQLITE_TRANSIENT);
+  statement.step();
+}
+
 } // namespace gep
 } // namespace ndn
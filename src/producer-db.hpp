@@ -30,7 +30,8 @@ namespace gep {
 /**
  * @brief ProducerDB is a class to manage the database of data producer.
  * It contains one table that maps timeslots (to the nearest hour) to the
- * content key created for that timeslot.
+ * content key created for that timeslot, and one table that keeps the
+ * latest E-KEY retrieved for each node of the producer's namespace.
  */
 class ProducerDB
 {
@@ -78,6 +79,67 @@ public:
   void
   deleteContentKey(const time::system_clock::TimePoint& timeslot);
 
+  /**
+   * @brief Delete at most @p limit content keys of the hours before the one covering
+   *        @p timeslot, oldest first
+   *
+   * The keys are found through the timeslot index, so the rows kept are not scanned.
+   *
+   * @param limit The maximum number of keys to delete, 0 for no limit
+   * @return The number of keys deleted
+   */
+  size_t
+  deleteContentKeysBefore(const time::system_clock::TimePoint& timeslot, size_t limit = 0);
+
+  /**
+   * @brief Get the number of content keys in the database
+   */
+  size_t
+  getContentKeyCount() const;
+
+  /**
+   * @brief Return at most @p nPages free pages of the database file to the file system
+   *
+   * Pages are released only from a database created by ProducerDB. A database created
+   * before keeps its size, unless it is converted offline by a full VACUUM.
+   *
+   * @param nPages The maximum number of pages to release, 0 for all free pages
+   */
+  void
+  compact(size_t nPages = 0);
+
+  /**
+   * @brief Check if an E-KEY of the node @p nodeName exists
+   */
+  bool
+  hasEKey(const Name& nodeName) const;
+
+  /**
+   * @brief Get the E-KEY of the node @p nodeName
+   *
+   * @return A tuple of the begin timeslot, the end timeslot and the key bits of the E-KEY
+   * @throws Error if the key does not exist
+   */
+  std::tuple<time::system_clock::TimePoint, time::system_clock::TimePoint, Buffer>
+  getEKey(const Name& nodeName) const;
+
+  /**
+   * @brief Save @p key covering [@p beginTimeslot, @p endTimeslot) as the E-KEY of @p nodeName
+   *
+   * The E-KEY previously saved for the same node, if any, is replaced.
+   */
+  void
+  addEKey(const Name& nodeName,
+          const time::system_clock::TimePoint& beginTimeslot,
+          const time::system_clock::TimePoint& endTimeslot,
+          const Buffer& key);
+
+  /**
+   * @brief Delete the E-KEY of the node @p nodeName
+   */
+  void
+  deleteEKey(const Name& nodeName);
+
 private:
   class Impl;
   unique_ptr<Impl> m_impl;
@@ -22,10 +22,16 @@
 
 #include "producer.hpp"
 #include "random-number-generator.hpp"
+#include "span-tracer.hpp"
 #include "algo/encryptor.hpp"
 #include "algo/aes.hpp"
+#include "algo/compression.hpp"
 #include "algo/error.hpp"
 
+#include <boost/asio/io_service.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
 namespace ndn {
 namespace gep {
 
@@ -35,6 +41,8 @@ static const int START_TS_INDEX = -2;
 static const int END_TS_INDEX = -1;
 
 const Link Producer::NO_LINK = Link();
+const size_t Producer::DEFAULT_SEGMENT_SIZE = 4096;
+const size_t Producer::PRUNE_BATCH_SIZE = 1000;
 
 /**
   @brief Method to round the provided @p timeslot to the nearest whole
@@ -50,12 +58,44 @@ Producer::Producer(const Name& prefix, const Name& dataType,
                    Face& face, const std::string& dbPath,
                    uint8_t repeatAttempts,
                    const Link& keyRetrievalLink)
+  : Producer(prefix, dataType, face, dbPath, repeatAttempts, keyRetrievalLink, nullptr)
+{
+}
+
+Producer::Producer(const Name& prefix, const Name& dataType,
+                   Face& face, const std::string& dbPath,
+                   KeyChain& keyChain,
+                   uint8_t repeatAttempts,
+                   const Link& keyRetrievalLink)
+  : Producer(prefix, dataType, face, dbPath, repeatAttempts, keyRetrievalLink, &keyChain)
+{
+}
+
+Producer::Producer(const Name& prefix, const Name& dataType,
+                   Face& face, const std::string& dbPath,
+                   uint8_t repeatAttempts,
+                   const Link& keyRetrievalLink,
+                   KeyChain* keyChain)
   : m_face(face)
+  , m_ownedKeyChain(keyChain == nullptr ? new KeyChain : nullptr)
+  , m_keychain(keyChain == nullptr ? *m_ownedKeyChain : *keyChain)
+  , m_keyRequestDeadline(0)
+  , m_maxKeyRequests(0)
+  , m_interestPacing(time::milliseconds(100))
+  , m_keyRequestMetrics()
   , m_db(dbPath)
   , m_maxRepeatAttempts(repeatAttempts)
+  , m_compression(tlv::CompressionNone)
+  , m_timestampNaming(TimestampNaming::Iso)
+  , m_isAlive(make_shared<bool>(true))
+  , m_scheduler(face.getIoService())
+  , m_retention(0)
+  , m_pruneInterval(0)
+  , m_nPruned(0)
   , m_keyRetrievalLink(keyRetrievalLink)
   , m_linkSize(m_keyRetrievalLink.getDelegations().size())
   , m_useLink(m_linkSize > 0)
+  , m_delegationRacer(face)
 {
   Name fixedPrefix = prefix;
   Name fixedDataType = dataType;
@@ -72,6 +112,13 @@ Producer::Producer(const Name& prefix, const Name& dataType,
     nodeName.append(NAME_COMPONENT_E_KEY);
 
     m_ekeyInfo[nodeName] = keyInfo;
+    // reload the E-KEY saved before restart, so that it can be used without retrieval
+    if (m_db.hasEKey(nodeName)) {
+      KeyInfo& savedKeyInfo = m_ekeyInfo[nodeName];
+      std::tie(savedKeyInfo.beginTimeslot, savedKeyInfo.endTimeslot, savedKeyInfo.keyBits) =
+        m_db.getEKey(nodeName);
+    }
+
     fixedDataType = fixedDataType.getPrefix(-1);
   }
   fixedPrefix.append(dataType);
@@ -93,33 +140,83 @@ Producer::createContentKey(const system_clock::TimePoint& timeslot,
   // Create content key name.
   Name contentKeyName = m_namespace;
   contentKeyName.append(NAME_COMPONENT_C_KEY);
-  contentKeyName.append(time::toIsoString(hourSlot));
+  contentKeyName.append(encodeTimestamp(hourSlot, m_timestampNaming));
 
   Buffer contentKeyBits;
 
+  NDN_GEP_SPAN(span, "createContentKey");
   // Check if we have created the content key before.
   if (m_db.hasContentKey(timeslot)) {
     // We have created the content key, return its name directly.
+    NDN_GEP_SPAN_DETAIL(span, "C-KEY exists");
     return contentKeyName;
   }
+  NDN_GEP_SPAN_DETAIL(span, "C-KEY created");
 
   // We haven't created the content key, create one and add it into the database.
   RandomNumberGenerator rng;
   AesKeyParams aesParams(128);
   contentKeyBits = algo::Aes::generateKey(rng, aesParams).getKeyBits();
   m_db.addContentKey(timeslot, contentKeyBits);
+  if (m_trace != nullptr)
+    m_trace->record(trace::ContentKey, contentKeyName, Name(), hourSlot, m_ekeyInfo.size());
 
   // Now we need to retrieve the E-KEYs for content key encryption.
   uint64_t timeCount = toUnixTimestamp(timeslot).count();
-  m_keyRequests.insert({timeCount, KeyRequest(m_ekeyInfo.size())});
-  KeyRequest& keyRequest = m_keyRequests.at(timeCount);
+  if (m_ekeyInfo.empty())
+    return contentKeyName;
+
+  auto pendingRequest = m_keyRequests.find(timeCount);
+  if (pendingRequest != m_keyRequests.end()) {
+    // the E-KEYs are being retrieved for the timeslot already, report its end to the caller
+    pendingRequest->second.followers.emplace_back(callback, errorCallback);
+    return contentKeyName;
+  }
+
+  if (m_maxKeyRequests > 0 && m_keyRequests.size() >= m_maxKeyRequests) {
+    // make room by dropping the retrieval for the oldest timeslot
+    uint64_t oldestTimeCount = m_keyRequests.begin()->first;
+    for (const auto& request : m_keyRequests)
+      oldestTimeCount = std::min(oldestTimeCount, request.first);
+    m_keyRequestMetrics.nEvicted++;
+    abortKeyRequest(oldestTimeCount, ErrorCode::Cancelled, "Too many outstanding key requests");
+  }
+
+  KeyRequest& keyRequest = m_keyRequests.emplace(timeCount, KeyRequest(m_ekeyInfo.size()))
+                                        .first->second;
+  keyRequest.errorCallback = errorCallback;
+  if (m_keyRequestDeadline > time::milliseconds::zero()) {
+    keyRequest.deadlineEvent = m_scheduler.scheduleEvent(m_keyRequestDeadline, [=] {
+        m_keyRequestMetrics.nExpired++;
+        abortKeyRequest(timeCount, ErrorCode::Timeout, "Key request deadline expired");
+      });
+  }
+  m_keyRequestMetrics.nOutstanding = m_keyRequests.size();
+  m_keyRequestMetrics.maxOutstanding = std::max(m_keyRequestMetrics.maxOutstanding,
+                                                m_keyRequestMetrics.nOutstanding);
+  NDN_GEP_ASYNC_ID(spanId);
+  keyRequest.spanId = spanId;
+  NDN_GEP_ASYNC_BEGIN("keyRetrieval", spanId, contentKeyName.toUri());
 
   // Check if current E-KEYs can cover the content key.
   Exclude timeRange;
-  timeRange.excludeAfter(name::Component(time::toIsoString(timeslot)));
+  timeRange.excludeAfter(encodeTimestamp(timeslot, m_timestampNaming));
+  std::vector<std::pair<Name, Buffer>> cachedEKeys;
   std::unordered_map<Name, KeyInfo>::iterator it;
   for (it = m_ekeyInfo.begin(); it != m_ekeyInfo.end(); ++it) {
     // for each current E-KEY
+    Name localEKeyName;
+    Buffer localEKeyBits;
+    if ((timeslot < it->second.beginTimeslot || timeslot >= it->second.endTimeslot) &&
+        m_localKeys != nullptr &&
+        m_localKeys->getEKey(it->first, timeslot, localEKeyName, localEKeyBits)) {
+      // the group manager in the same process has the covering E-KEY, use it directly.
+      it->second.beginTimeslot = decodeTimestamp(localEKeyName.get(START_TS_INDEX));
+      it->second.endTimeslot = decodeTimestamp(localEKeyName.get(END_TS_INDEX));
+      it->second.keyBits = localEKeyBits;
+      m_db.addEKey(it->first, it->second.beginTimeslot, it->second.endTimeslot, localEKeyBits);
+    }
+
     if (timeslot < it->second.beginTimeslot || timeslot >= it->second.endTimeslot) {
       // current E-KEY cannot cover the content key, retrieve one.
       keyRequest.repeatAttempts[it->first] = 0;
@@ -129,15 +226,152 @@ Producer::createContentKey(const system_clock::TimePoint& timeslot,
     else {
       // current E-KEY can cover the content key, encrypt the content key directly.
       Name eKeyName(it->first);
-      eKeyName.append(time::toIsoString(it->second.beginTimeslot));
-      eKeyName.append(time::toIsoString(it->second.endTimeslot));
-      encryptContentKey(it->second.keyBits, eKeyName, timeslot, callback, errorCallback);
+      eKeyName.append(encodeTimestamp(it->second.beginTimeslot, m_timestampNaming));
+      eKeyName.append(encodeTimestamp(it->second.endTimeslot, m_timestampNaming));
+      if (m_workerPool != nullptr)
+        cachedEKeys.emplace_back(eKeyName, it->second.keyBits);
+      else
+        encryptContentKey(it->second.keyBits, eKeyName, timeslot, callback, errorCallback);
     }
   }
 
+  if (!cachedEKeys.empty())
+    encryptContentKeyOnPool(cachedEKeys, contentKeyBits, timeslot, callback, errorCallback);
+
   return contentKeyName;
 }
 
+Future<std::vector<Data>>
+Producer::createContentKeyAsync(const system_clock::TimePoint& timeslot)
+{
+  Promise<std::vector<Data>> promise;
+  if (m_db.hasContentKey(timeslot)) {
+    // no E-KEY retrieval happens for an existing content key
+    promise.setValue(std::vector<Data>());
+    return promise.getFuture();
+  }
+
+  createContentKey(timeslot,
+                   [=] (const std::vector<Data>& keys) { promise.setValue(keys); },
+                   [=] (const ErrorCode& code, const std::string& msg) {
+                     promise.setError(code, msg);
+                   });
+  if (m_ekeyInfo.empty()) {
+    // there is no E-KEY to encrypt the content key with
+    promise.setValue(std::vector<Data>());
+  }
+  return promise.getFuture();
+}
+
+bool
+Producer::cancelKeyRequest(const system_clock::TimePoint& timeslot)
+{
+  uint64_t timeCount = toUnixTimestamp(timeslot).count();
+  if (m_keyRequests.count(timeCount) == 0)
+    return false;
+
+  m_keyRequestMetrics.nCancelled++;
+  abortKeyRequest(timeCount, ErrorCode::Cancelled, "Key request cancelled");
+  return true;
+}
+
+void
+Producer::setKeyRequestDeadline(const time::milliseconds& deadline)
+{
+  m_keyRequestDeadline = deadline;
+}
+
+void
+Producer::setMaxKeyRequests(size_t maxRequests)
+{
+  m_maxKeyRequests = maxRequests;
+}
+
+void
+Producer::setInterestPacing(const time::milliseconds& interval)
+{
+  m_interestPacing = interval;
+}
+
+void
+Producer::setLocalKeyRegistry(const shared_ptr<LocalKeyRegistry>& localKeys)
+{
+  m_localKeys = localKeys;
+}
+
+void
+Producer::setTraceRecorder(const shared_ptr<TraceRecorder>& traceRecorder)
+{
+  m_trace = traceRecorder;
+}
+
+void
+Producer::setWorkerPool(const shared_ptr<WorkerPool>& workerPool)
+{
+  m_workerPool = workerPool;
+}
+
+void
+Producer::setCompression(tlv::CompressionTypeValue compression)
+{
+  if (!algo::Compression::isSupported(compression))
+    throw algo::Error("Unsupported compression method");
+
+  m_compression = compression;
+}
+
+void
+Producer::setTimestampNaming(TimestampNaming naming)
+{
+  m_timestampNaming = naming;
+}
+
+void
+Producer::setContentKeyRetention(const time::hours& retention,
+                                 const time::milliseconds& pruneInterval)
+{
+  m_retention = retention;
+  m_pruneInterval = pruneInterval;
+  m_scheduler.cancelEvent(m_pruneEvent);
+  m_nPruned = 0;
+
+  if (m_retention > time::hours::zero())
+    m_pruneEvent = m_scheduler.scheduleEvent(time::milliseconds(0),
+                                             bind(&Producer::pruneContentKeys, this));
+}
+
+void
+Producer::pruneContentKeys()
+{
+  system_clock::TimePoint windowStart = system_clock::now() - m_retention;
+  size_t nDeleted = m_db.deleteContentKeysBefore(windowStart, PRUNE_BATCH_SIZE);
+  m_nPruned += nDeleted;
+  if (nDeleted == PRUNE_BATCH_SIZE) {
+    // more keys may be out of the window, continue once pending events are processed
+    m_pruneEvent = m_scheduler.scheduleEvent(time::milliseconds(0),
+                                             bind(&Producer::pruneContentKeys, this));
+    return;
+  }
+
+  if (m_nPruned > 0) {
+    m_db.compact();
+    m_nPruned = 0;
+  }
+  if (m_localKeys != nullptr) {
+    Name cKeyPrefix = m_namespace;
+    cKeyPrefix.append(NAME_COMPONENT_C_KEY);
+    m_localKeys->removeContentKeysBefore(cKeyPrefix, windowStart);
+  }
+  m_pruneEvent = m_scheduler.scheduleEvent(m_pruneInterval,
+                                           bind(&Producer::pruneContentKeys, this));
+}
+
+void
+Producer::setDelegationFanout(size_t fanout)
+{
+  m_delegationRacer.setFanout(fanout);
+}
+
 void
 Producer::defaultErrorCallBack(const ErrorCode& code, const std::string& msg)
 {
@@ -149,20 +383,117 @@ Producer::produce(Data& data, const system_clock::TimePoint& timeslot,
                   const uint8_t* content, size_t contentLen,
                   const ErrorCallBack& errorCallBack)
 {
+  if (m_trace != nullptr)
+    m_trace->record(trace::Produce, m_namespace, Name(), timeslot, contentLen);
+  NDN_GEP_SPAN(span, "produce");
+
   // Get a content key
   Name contentKeyName = createContentKey(timeslot, nullptr, errorCallBack);
   Buffer contentKey = m_db.getContentKey(timeslot);
 
   // Produce data
   Name dataName = m_namespace;
-  dataName.append(time::toIsoString(timeslot));
+  dataName.append(encodeTimestamp(timeslot, m_timestampNaming));
   data.setName(dataName);
   algo::EncryptParams params(tlv::AlgorithmAesCbc, 16);
+  params.setCompressionType(m_compression);
   algo::encryptData(data, content, contentLen, contentKeyName,
                     contentKey.buf(), contentKey.size(), params);
   m_keychain.sign(data);
 }
 
+std::vector<Data>
+Producer::produceSegments(const system_clock::TimePoint& timeslot, std::istream& is,
+                          size_t segmentSize, const ErrorCallBack& errorCallBack)
+{
+  BOOST_ASSERT(segmentSize > 0);
+
+  // Get a content key, shared by all segments
+  Name contentKeyName = createContentKey(timeslot, nullptr, errorCallBack);
+  Buffer contentKey = m_db.getContentKey(timeslot);
+
+  Name dataName = m_namespace;
+  dataName.append(encodeTimestamp(timeslot, m_timestampNaming));
+
+  std::vector<Data> segments;
+  Buffer buffer(segmentSize);
+  do {
+    is.read(reinterpret_cast<char*>(buffer.buf()), buffer.size());
+    size_t nOctets = static_cast<size_t>(is.gcount());
+    // an empty content is still produced as one segment
+    if (nOctets == 0 && !segments.empty())
+      break;
+
+    segments.push_back(createSegment(dataName, segments.size(), buffer.buf(), nOctets,
+                                     contentKeyName, contentKey));
+  } while (is);
+
+  finalizeSegments(segments);
+  return segments;
+}
+
+std::vector<Data>
+Producer::produceSegments(const system_clock::TimePoint& timeslot, const std::string& filePath,
+                          size_t segmentSize, const ErrorCallBack& errorCallBack)
+{
+  BOOST_ASSERT(segmentSize > 0);
+
+  boost::iostreams::mapped_file_source file;
+  if (boost::filesystem::file_size(filePath) > 0)
+    file.open(filePath);
+
+  Name contentKeyName = createContentKey(timeslot, nullptr, errorCallBack);
+  Buffer contentKey = m_db.getContentKey(timeslot);
+
+  Name dataName = m_namespace;
+  dataName.append(encodeTimestamp(timeslot, m_timestampNaming));
+
+  // encrypt the segments directly from the mapped memory
+  const uint8_t* content = file.is_open() ? reinterpret_cast<const uint8_t*>(file.data()) : nullptr;
+  size_t contentLen = file.is_open() ? file.size() : 0;
+
+  std::vector<Data> segments;
+  segments.reserve(contentLen / segmentSize + 1);
+  size_t offset = 0;
+  do {
+    size_t nOctets = std::min(segmentSize, contentLen - offset);
+    segments.push_back(createSegment(dataName, segments.size(), content + offset, nOctets,
+                                     contentKeyName, contentKey));
+    offset += nOctets;
+  } while (offset < contentLen);
+
+  finalizeSegments(segments);
+  return segments;
+}
+
+Data
+Producer::createSegment(const Name& dataName, uint64_t segmentNo,
+                        const uint8_t* segment, size_t segmentLen,
+                        const Name& contentKeyName, const Buffer& contentKey)
+{
+  Data data(Name(dataName).appendSegment(segmentNo));
+
+  // a fresh initial vector for each segment
+  algo::EncryptParams params(tlv::AlgorithmAesCbc, 16);
+  params.setCompressionType(m_compression);
+  algo::encryptData(data, segment, segmentLen, contentKeyName,
+                    contentKey.buf(), contentKey.size(), params);
+
+  // encryptData appends the key name to the data name, keep the segment number last
+  data.setName(Name(dataName).appendSegment(segmentNo));
+  return data;
+}
+
+void
+Producer::finalizeSegments(std::vector<Data>& segments)
+{
+  name::Component finalBlockId = name::Component::fromSegment(segments.size() - 1);
+  for (Data& segment : segments) {
+    segment.setFinalBlockId(finalBlockId);
+    m_keychain.sign(segment);
+  }
+}
+
 void
 Producer::sendKeyInterest(const Interest& interest,
                           size_t delegationIndex,
@@ -170,14 +501,41 @@ Producer::sendKeyInterest(const Interest& interest,
                           const ProducerEKeyCallback& callback,
                           const ErrorCallBack& errorCallback)
 {
-  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-  m_face.expressInterest(interest,
-                         std::bind(&Producer::handleCoveringKey, this, _1, _2,
-                                   delegationIndex, timeslot, callback, errorCallback),
-                         std::bind(&Producer::handleNack, this, _1, _2,
-                                   delegationIndex, timeslot, callback, errorCallback),
-                         std::bind(&Producer::handleTimeout, this, _1,
-                                   delegationIndex, timeslot, callback, errorCallback));
+  uint64_t timeCount = toUnixTimestamp(timeslot).count();
+  auto request = m_keyRequests.find(timeCount);
+  if (request == m_keyRequests.end())
+    return;
+  KeyRequest& keyRequest = request->second;
+  size_t nRetrials = keyRequest.repeatAttempts[interest.getName()];
+
+  // back off the InterestLifetime exponentially for each retrial
+  Name measurementPrefix = RttEstimator::getMeasurementPrefix(interest.getName());
+  time::milliseconds lifetime = m_rttEstimator.getRto(measurementPrefix);
+  for (size_t i = 0; i < nRetrials; i++)
+    lifetime = m_rttEstimator.backoff(measurementPrefix, lifetime);
+
+  Interest keyInterest(interest);
+  keyInterest.setInterestLifetime(lifetime);
+  NDN_GEP_INSTANT("sendKeyInterest", interest.getName().toUri());
+
+  if (m_interestPacing > time::milliseconds::zero())
+    std::this_thread::sleep_for(std::chrono::milliseconds(m_interestPacing.count()));
+
+  time::steady_clock::TimePoint sendTime = time::steady_clock::now();
+  auto dataCallback = [=] (const Interest& expressedInterest, const Data& keyData) {
+    // only measure RTT of interests which are not retransmitted
+    if (nRetrials == 0)
+      m_rttEstimator.addMeasurement(measurementPrefix, time::steady_clock::now() - sendTime);
+
+    handleCoveringKey(expressedInterest, keyData, delegationIndex, timeslot, callback, errorCallback);
+  };
+
+  keyRequest.pendingInterests[interest.getName()] =
+    m_face.expressInterest(keyInterest, dataCallback,
+                           std::bind(&Producer::handleNack, this, _1, _2,
+                                     delegationIndex, timeslot, callback, errorCallback),
+                           std::bind(&Producer::handleTimeout, this, _1,
+                                     delegationIndex, timeslot, callback, errorCallback));
 }
 
 void
@@ -187,14 +545,19 @@ Producer::handleCoveringKey(const Interest& interest, const Data& data,
                             const ProducerEKeyCallback& callback,
                             const ErrorCallBack& errorCallback)
 {
+  NDN_GEP_SPAN(span, "handleCoveringKey");
   uint64_t timeCount = toUnixTimestamp(timeslot).count();
-  KeyRequest& keyRequest = m_keyRequests.at(timeCount);
+  auto request = m_keyRequests.find(timeCount);
+  if (request == m_keyRequests.end())
+    return;
+  KeyRequest& keyRequest = request->second;
 
   Name interestName = interest.getName();
+  keyRequest.pendingInterests.erase(interestName);
   Name keyName = data.getName();
 
-  system_clock::TimePoint begin = time::fromIsoString(keyName.get(START_TS_INDEX).toUri());
-  system_clock::TimePoint end = time::fromIsoString(keyName.get(END_TS_INDEX).toUri());
+  system_clock::TimePoint begin = decodeTimestamp(keyName.get(START_TS_INDEX));
+  system_clock::TimePoint end = decodeTimestamp(keyName.get(END_TS_INDEX));
 
   if (timeslot >= end) {
     // if received E-KEY covers some earlier period, try to retrieve an E-KEY covering later one.
@@ -214,6 +577,7 @@ Producer::handleCoveringKey(const Interest& interest, const Data& data,
       m_ekeyInfo[interestName].beginTimeslot = begin;
       m_ekeyInfo[interestName].endTimeslot = end;
       m_ekeyInfo[interestName].keyBits = encryptionKey;
+      m_db.addEKey(interestName, begin, end, encryptionKey);
     }
   }
 }
@@ -226,9 +590,16 @@ Producer::handleTimeout(const Interest& interest,
                         const ErrorCallBack& errorCallback)
 {
   uint64_t timeCount = toUnixTimestamp(timeslot).count();
-  KeyRequest& keyRequest = m_keyRequests.at(timeCount);
+  auto request = m_keyRequests.find(timeCount);
+  if (request == m_keyRequests.end())
+    return;
+  KeyRequest& keyRequest = request->second;
 
   Name interestName = interest.getName();
+  keyRequest.pendingInterests.erase(interestName);
+  m_rttEstimator.addTimeout(RttEstimator::getMeasurementPrefix(interestName));
+  NDN_GEP_INSTANT("timeout", interestName.toUri());
+
   if (keyRequest.repeatAttempts[interestName] < m_maxRepeatAttempts) {
     // increase retrial count
     keyRequest.repeatAttempts[interestName]++;
@@ -249,8 +620,41 @@ Producer::handleNack(const Interest& interest,
                      const ProducerEKeyCallback& callback,
                      const ErrorCallBack& errorCallback)
 {
+  NDN_GEP_INSTANT("nack", interest.getName().toUri());
+  uint64_t timeCount = toUnixTimestamp(timeslot).count();
+  auto request = m_keyRequests.find(timeCount);
+  if (request == m_keyRequests.end())
+    return;
+  request->second.pendingInterests.erase(interest.getName());
+
   if (m_useLink) {
-    if (!interest.hasSelectedDelegation()) {
+    if (!interest.hasSelectedDelegation() && m_delegationRacer.getFanout() > 1) {
+      // race the best delegations of the link, run out of options if all of them fail.
+      Name interestName = interest.getName();
+      uint64_t raceId =
+        m_delegationRacer.fetch(interest, m_keyRetrievalLink,
+                                [=] (const Interest& keyInterest, const Data& keyData) {
+                                  auto request = m_keyRequests.find(timeCount);
+                                  if (request == m_keyRequests.end())
+                                    return;
+                                  request->second.pendingRaces.erase(interestName);
+                                  handleCoveringKey(keyInterest, keyData, 0,
+                                                    timeslot, callback, errorCallback);
+                                },
+                                [=] {
+                                  auto request = m_keyRequests.find(timeCount);
+                                  if (request == m_keyRequests.end())
+                                    return;
+                                  request->second.pendingRaces.erase(interestName);
+                                  updateKeyRequest(request->second, timeCount, callback);
+                                });
+      // the race can end before fetch returns, so that the request may be gone already
+      request = m_keyRequests.find(timeCount);
+      if (request != m_keyRequests.end())
+        request->second.pendingRaces[interestName] = raceId;
+      return;
+    }
+    else if (!interest.hasSelectedDelegation()) {
       // if link is not used in first interest, use it now.
       Interest newInterest(interest);
       newInterest.setLink(m_linkBlock);
@@ -271,8 +675,7 @@ Producer::handleNack(const Interest& interest,
   }
 
   // in all the other cases, we run out of options...
-  uint64_t timeCount = toUnixTimestamp(timeslot).count();
-  updateKeyRequest(m_keyRequests.at(timeCount), timeCount, callback);
+  updateKeyRequest(request->second, timeCount, callback);
 }
 
 void
@@ -280,9 +683,50 @@ Producer::updateKeyRequest(KeyRequest& keyRequest, uint64_t timeCount,
                            const ProducerEKeyCallback& callback)
 {
   keyRequest.interestCount--;
-  if (keyRequest.interestCount == 0 && callback) {
-    callback(keyRequest.encryptedKeys);
-    m_keyRequests.erase(timeCount);
+  if (keyRequest.interestCount > 0)
+    return;
+
+  NDN_GEP_ASYNC_END("keyRetrieval", keyRequest.spanId, "");
+  m_scheduler.cancelEvent(keyRequest.deadlineEvent);
+  std::vector<Data> encryptedKeys;
+  encryptedKeys.swap(keyRequest.encryptedKeys);
+  auto followers = std::move(keyRequest.followers);
+  m_keyRequests.erase(timeCount);
+  m_keyRequestMetrics.nOutstanding = m_keyRequests.size();
+  m_keyRequestMetrics.nCompleted++;
+
+  if (callback)
+    callback(encryptedKeys);
+  for (const auto& follower : followers) {
+    if (follower.first)
+      follower.first(encryptedKeys);
+  }
+}
+
+void
+Producer::abortKeyRequest(uint64_t timeCount, ErrorCode code, const std::string& msg)
+{
+  auto request = m_keyRequests.find(timeCount);
+  if (request == m_keyRequests.end())
+    return;
+
+  KeyRequest& keyRequest = request->second;
+  NDN_GEP_ASYNC_END("keyRetrieval", keyRequest.spanId, msg);
+  m_scheduler.cancelEvent(keyRequest.deadlineEvent);
+  for (const auto& pendingInterest : keyRequest.pendingInterests)
+    m_face.removePendingInterest(pendingInterest.second);
+  for (const auto& pendingRace : keyRequest.pendingRaces)
+    m_delegationRacer.cancel(pendingRace.second);
+  ErrorCallBack errorCallback = keyRequest.errorCallback;
+  auto followers = std::move(keyRequest.followers);
+  m_keyRequests.erase(request);
+  m_keyRequestMetrics.nOutstanding = m_keyRequests.size();
+
+  if (errorCallback)
+    errorCallback(code, msg);
+  for (const auto& follower : followers) {
+    if (follower.second)
+      follower.second(code, msg);
   }
 }
 
@@ -292,12 +736,10 @@ Producer::encryptContentKey(const Buffer& encryptionKey, const Name& eKeyName,
                             const ProducerEKeyCallback& callback,
                             const ErrorCallBack& errorCallBack)
 {
-  uint64_t timeCount = toUnixTimestamp(timeslot).count();
-  KeyRequest& keyRequest = m_keyRequests.at(timeCount);
-
+  NDN_GEP_SPAN(span, "encryptContentKey");
   Name keyName = m_namespace;
   keyName.append(NAME_COMPONENT_C_KEY);
-  keyName.append(time::toIsoString(getRoundedTimeslot(timeslot)));
+  keyName.append(encodeTimestamp(getRoundedTimeslot(timeslot), m_timestampNaming));
 
   Buffer contentKey = m_db.getContentKey(timeslot);
 
@@ -310,12 +752,101 @@ Producer::encryptContentKey(const Buffer& encryptionKey, const Name& eKeyName,
   }
   catch (algo::Error& e) {
     errorCallBack(ErrorCode::EncryptionFailure, e.what());
+    // the request still completes without this key
+    auto request = m_keyRequests.find(toUnixTimestamp(timeslot).count());
+    if (request != m_keyRequests.end())
+      updateKeyRequest(request->second, request->first, callback);
     return false;
   }
+  finishContentKey(cKeyData, eKeyName, contentKey, timeslot, callback);
+  return true;
+}
+
+void
+Producer::encryptContentKeyOnPool(const std::vector<std::pair<Name, Buffer>>& eKeys,
+                                  const Buffer& contentKey,
+                                  const system_clock::TimePoint& timeslot,
+                                  const ProducerEKeyCallback& callback,
+                                  const ErrorCallBack& errorCallback)
+{
+  struct Wrap {
+    Name eKeyName;
+    Buffer eKeyBits;
+    Data cKeyData;
+    std::string error;
+  };
+
+  Name keyName = m_namespace;
+  keyName.append(NAME_COMPONENT_C_KEY);
+  keyName.append(encodeTimestamp(getRoundedTimeslot(timeslot), m_timestampNaming));
+
+  // split the wraps evenly across the workers
+  size_t chunkSize = (eKeys.size() + m_workerPool->size() - 1) / m_workerPool->size();
+  weak_ptr<bool> isAlive = m_isAlive;
+  boost::asio::io_service* ioService = &m_face.getIoService();
+  auto sharedContentKey = make_shared<Buffer>(contentKey);
+  for (size_t begin = 0; begin < eKeys.size(); begin += chunkSize) {
+    size_t end = std::min(begin + chunkSize, eKeys.size());
+    auto chunk = make_shared<std::vector<Wrap>>();
+    for (size_t i = begin; i < end; i++)
+      chunk->push_back(Wrap{eKeys[i].first, eKeys[i].second, Data(keyName), ""});
+    // keep the io_service running until the wrapped keys are handed back
+    auto work = make_shared<boost::asio::io_service::work>(*ioService);
+
+    m_workerPool->post([this, chunk, sharedContentKey, isAlive, ioService, work,
+                        timeslot, callback, errorCallback] {
+        algo::EncryptParams params(tlv::AlgorithmRsaOaep);
+        for (Wrap& wrap : *chunk) {
+          NDN_GEP_SPAN(span, "encryptContentKey");
+          try {
+            algo::encryptData(wrap.cKeyData, sharedContentKey->buf(), sharedContentKey->size(),
+                              wrap.eKeyName, wrap.eKeyBits.buf(), wrap.eKeyBits.size(), params);
+          }
+          catch (algo::Error& e) {
+            wrap.error = e.what();
+          }
+        }
+
+        // the KeyChain is not thread-safe, sign on the face thread
+        ioService->post([this, chunk, sharedContentKey, isAlive,
+                         timeslot, callback, errorCallback] {
+            if (isAlive.expired())
+              return;
+            for (Wrap& wrap : *chunk) {
+              if (wrap.error.empty()) {
+                finishContentKey(wrap.cKeyData, wrap.eKeyName, *sharedContentKey,
+                                 timeslot, callback);
+                continue;
+              }
+
+              errorCallback(ErrorCode::EncryptionFailure, wrap.error);
+              auto request = m_keyRequests.find(toUnixTimestamp(timeslot).count());
+              if (request != m_keyRequests.end())
+                updateKeyRequest(request->second, request->first, callback);
+            }
+          });
+      });
+  }
+}
+
+void
+Producer::finishContentKey(Data& cKeyData, const Name& eKeyName, const Buffer& contentKey,
+                           const system_clock::TimePoint& timeslot,
+                           const ProducerEKeyCallback& callback)
+{
+  uint64_t timeCount = toUnixTimestamp(timeslot).count();
+  auto request = m_keyRequests.find(timeCount);
+  if (request == m_keyRequests.end()) {
+    // the request has been cancelled while the key was wrapped
+    return;
+  }
+  KeyRequest& keyRequest = request->second;
+
   m_keychain.sign(cKeyData);
+  if (m_localKeys != nullptr)
+    m_localKeys->addContentKey(cKeyData.getName(), eKeyName, contentKey);
   keyRequest.encryptedKeys.push_back(cKeyData);
   updateKeyRequest(keyRequest, timeCount, callback);
-  return true;
 }
 
 } // namespace gep
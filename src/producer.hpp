@@ -24,10 +24,20 @@
 #define NDN_GEP_PRODUCER_HPP
 
 #include "producer-db.hpp"
+#include "local-key-registry.hpp"
+#include "trace-recorder.hpp"
+#include "rtt-estimator.hpp"
+#include "delegation-racer.hpp"
 #include "error-code.hpp"
+#include "future.hpp"
+#include "worker-pool.hpp"
+#include "timestamp-name.hpp"
 
 #include <ndn-cxx/security/key-chain.hpp>
 #include <ndn-cxx/face.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+
+#include <istream>
 
 namespace ndn {
 namespace gep {
@@ -50,10 +60,37 @@ public:
   struct KeyRequest {
     KeyRequest(size_t interests)
     : interestCount(interests)
+    , spanId(0)
     {}
     size_t interestCount;
+    uint64_t spanId;
     std::unordered_map<Name, size_t> repeatAttempts;
     std::vector<Data> encryptedKeys;
+    /// @brief The outstanding E-KEY interest of each node, removed when the request ends early
+    std::unordered_map<Name, const PendingInterestId*> pendingInterests;
+    /// @brief The outstanding race through the delegations of each node
+    std::unordered_map<Name, uint64_t> pendingRaces;
+    ErrorCallBack errorCallback;
+    /// @brief The callbacks of the later calls for the same timeslot, invoked when it ends
+    std::vector<std::pair<ProducerEKeyCallback, ErrorCallBack>> followers;
+    util::scheduler::EventId deadlineEvent;
+  };
+
+  /**
+   * @brief Counters of the E-KEY retrievals of content keys
+   */
+  struct KeyRequestMetrics {
+    /// @brief The number of requests still retrieving E-KEYs
+    size_t nOutstanding;
+    /// @brief The largest number of outstanding requests so far
+    size_t maxOutstanding;
+    uint64_t nCompleted;
+    /// @brief The number of requests which missed their deadline
+    uint64_t nExpired;
+    /// @brief The number of requests cancelled through cancelKeyRequest()
+    uint64_t nCancelled;
+    /// @brief The number of oldest requests dropped to stay under the limit
+    uint64_t nEvicted;
   };
 
 public:
@@ -61,7 +98,7 @@ public:
    * @brief Construct a producer
    *
    * A producer can produce data with a naming convention:
-   *   /<@p prefix>/SAMPLES/<@p dataType>/[timestamp]
+   *   /<@p prefix>/SAMPLE/<@p dataType>/[timestamp]
    *
    * The produced data packet is encrypted with a content key,
    * which is stored in a database at @p dbPath.
@@ -69,10 +106,24 @@ public:
    * A producer also need to produce data containing content key
    * encrypted with E-KEYs. A producer can retrieve E-KEYs through
    * @p face, and will re-try for at most @p repeatAttemps times when
-   * E-KEY retrieval fails.
+   * E-KEY retrieval fails. The latest E-KEY of each node is saved in the
+   * database as well, so that a restarted producer does not need to retrieve
+   * E-KEYs which still cover the current time.
+   */
+  Producer(const Name& prefix, const Name& dataType,
+           Face& face, const std::string& dbPath,
+           uint8_t repeatAttempts = 3,
+           const Link& keyRetrievalLink = NO_LINK);
+
+  /**
+   * @brief Construct a producer signing packets with @p keyChain
+   *
+   * Producers in one process can share @p keyChain instead of opening the PIB and TPM
+   * for each producer. @p keyChain must outlive the producer.
    */
   Producer(const Name& prefix, const Name& dataType,
            Face& face, const std::string& dbPath,
+           KeyChain& keyChain,
            uint8_t repeatAttempts = 3,
            const Link& keyRetrievalLink = NO_LINK);
 
@@ -84,13 +135,35 @@ public:
    * If the key does not exist, the method will create one and encrypt
    * it using corresponding E-KEY. The encrypted content keys will be
    * passed back through @p callback. In case of any error, @p errorCallBack
-   * will be invoked.
+   * will be invoked. If the E-KEYs of @p timeslot are still being retrieved for an earlier
+   * call, @p callback or @p errorCallBack is invoked when that retrieval ends.
    */
   Name
   createContentKey(const time::system_clock::TimePoint& timeslot,
                    const ProducerEKeyCallback& callback,
                    const ErrorCallBack& errorCallBack = Producer::defaultErrorCallBack);
 
+  /**
+   * @brief Create content key corresponding to @p timeslot
+   *
+   * Unlike createContentKey(), the returned future always completes: with the content keys
+   * encrypted by E-KEYs, with an empty vector if the content key has been created before or
+   * there is no E-KEY node to retrieve, or with the first error.
+   */
+  Future<std::vector<Data>>
+  createContentKeyAsync(const time::system_clock::TimePoint& timeslot);
+
+  /**
+   * @brief Stop the E-KEY retrieval of the content key for @p timeslot
+   *
+   * The outstanding E-KEY interests are removed from the face, and the error callback of
+   * the request is invoked with ErrorCode::Cancelled. The content key itself is kept.
+   *
+   * @return false if there is no outstanding retrieval for @p timeslot
+   */
+  bool
+  cancelKeyRequest(const time::system_clock::TimePoint& timeslot);
+
   /**
    * @brief Produce an data packet encrypted using the content key corresponding @p timeslot
    *
@@ -103,6 +176,156 @@ public:
           const uint8_t* content, size_t contentLen,
           const ErrorCallBack& errorCallBack = Producer::defaultErrorCallBack);
 
+  /**
+   * @brief Produce the content read from @p is as a sequence of segments
+   *
+   * The content is split into segments of @p segmentSize octets, named
+   *   /<prefix>/SAMPLE/<dataType>/[timestamp]/[segment]
+   * Each segment is encrypted with the content key corresponding @p timeslot and its own
+   * initial vector, and carries the FinalBlockId of the sequence. In case of any error,
+   * @p errorCallBack will be invoked.
+   *
+   * @return The signed segments
+   */
+  std::vector<Data>
+  produceSegments(const time::system_clock::TimePoint& timeslot, std::istream& is,
+                  size_t segmentSize = DEFAULT_SEGMENT_SIZE,
+                  const ErrorCallBack& errorCallBack = Producer::defaultErrorCallBack);
+
+  /**
+   * @brief Produce the content of file @p filePath as a sequence of segments
+   *
+   * The file is memory-mapped, so its content is encrypted without being copied first.
+   *
+   * @throw std::ios_base::failure the file cannot be mapped
+   */
+  std::vector<Data>
+  produceSegments(const time::system_clock::TimePoint& timeslot, const std::string& filePath,
+                  size_t segmentSize = DEFAULT_SEGMENT_SIZE,
+                  const ErrorCallBack& errorCallBack = Producer::defaultErrorCallBack);
+
+  /**
+   * @brief Compress the content produced afterwards with @p compression before encryption
+   *
+   * The compression is signaled in the EncryptedContent, and consumers decompress the
+   * content transparently. tlv::CompressionNone (default) disables compression. Once
+   * enabled, producing a content, or a segment, larger than
+   * algo::Compression::MAX_PAYLOAD_LENGTH throws algo::Error.
+   *
+   * @throw algo::Error @p compression is not available in this build
+   */
+  void
+  setCompression(tlv::CompressionTypeValue compression);
+
+  /**
+   * @brief Encode the timestamps in the C-KEY and data names created afterwards with @p naming
+   *
+   * The E-KEY names are given by the group manager, which should use the same naming so
+   * that E-KEY retrieval excludes the right keys. The timestamps in received E-KEY names
+   * are decoded in either naming. TimestampNaming::Iso is the default.
+   */
+  void
+  setTimestampNaming(TimestampNaming naming);
+
+  /**
+   * @brief Keep the content keys of the last @p retention only
+   *
+   * Every @p pruneInterval, the content keys of the hours before the retention window are
+   * deleted from the database in batches, each batch in its own event so that a large
+   * backlog does not block the face. Once a round deletes keys, the freed pages are
+   * returned to the file system. The first round runs right away, and costs a single
+   * index lookup when there is nothing to prune. The C-KEYs of this producer before the
+   * window are removed from the local key registry as well, if one is set; the group keys
+   * and the keys of other producers sharing the registry are left to its owner.
+   * @p retention of zero disables pruning.
+   */
+  void
+  setContentKeyRetention(const time::hours& retention,
+                         const time::milliseconds& pruneInterval = time::hours(1));
+
+  /**
+   * @brief Enable hedged E-KEY retrieval through @p fanout delegations of the link at once
+   *
+   * When E-KEY retrieval falls back to the key retrieval link, the E-KEY interest is sent
+   * to the @p fanout best delegations in parallel rather than one by one. The first E-KEY
+   * received is used and the other interests are cancelled. @p fanout of 1 (default) keeps
+   * trying the delegations one by one.
+   */
+  void
+  setDelegationFanout(size_t fanout);
+
+  /**
+   * @brief Give up the E-KEY retrieval of a content key @p deadline after it starts
+   *
+   * An expired request is ended as by cancelKeyRequest(), except that the error callback
+   * is invoked with ErrorCode::Timeout. @p deadline of zero (default) sets no deadline.
+   */
+  void
+  setKeyRequestDeadline(const time::milliseconds& deadline);
+
+  /**
+   * @brief Retrieve E-KEYs for at most @p maxRequests content keys at once
+   *
+   * When a new content key is created at the limit, the retrieval for the oldest timeslot
+   * is ended as by cancelKeyRequest(). @p maxRequests of zero (default) sets no limit.
+   */
+  void
+  setMaxKeyRequests(size_t maxRequests);
+
+  /**
+   * @brief Wait @p interval before sending each E-KEY interest afterwards
+   *
+   * The wait blocks the thread of the face. @p interval of zero disables pacing. The
+   * default is 100 milliseconds.
+   */
+  void
+  setInterestPacing(const time::milliseconds& interval);
+
+  const KeyRequestMetrics&
+  getKeyRequestMetrics() const
+  {
+    return m_keyRequestMetrics;
+  }
+
+  /**
+   * @brief Look up E-KEYs in @p localKeys before retrieving them from the network
+   *
+   * The content keys encrypted afterwards are registered in @p localKeys as well, so that
+   * consumers in the same process can get them directly.
+   */
+  void
+  setLocalKeyRegistry(const shared_ptr<LocalKeyRegistry>& localKeys);
+
+  /**
+   * @brief Record the calls and key events afterwards in @p traceRecorder
+   *
+   * @p traceRecorder of nullptr (default) disables recording.
+   */
+  void
+  setTraceRecorder(const shared_ptr<TraceRecorder>& traceRecorder);
+
+  /**
+   * @brief Wrap the content key with the cached E-KEYs on @p workerPool
+   *
+   * When createContentKey() finds the E-KEYs of several nodes cached, the RSA-OAEP wraps
+   * are split across the threads of @p workerPool. The wrapped keys are signed and passed
+   * to the callback on the face thread, so the callback is no longer invoked from within
+   * createContentKey(). @p workerPool of nullptr (default) wraps the keys in place.
+   */
+  void
+  setWorkerPool(const shared_ptr<WorkerPool>& workerPool);
+
+  /**
+   * @brief Get the RTT estimator of E-KEY retrieval
+   *
+   * The estimator keeps the RTT statistics of the E-KEY retrieval of each node.
+   */
+  const RttEstimator&
+  getRttEstimator() const
+  {
+    return m_rttEstimator;
+  }
+
 public:
   /**
    * @brief Default error callback
@@ -114,13 +337,23 @@ public:
   defaultErrorCallBack(const ErrorCode& code, const std::string& msg);
 
 private:
+  /**
+   * @brief Construct a producer signing with @p keyChain, or with its own KeyChain if
+   *        @p keyChain is nullptr
+   */
+  Producer(const Name& prefix, const Name& dataType,
+           Face& face, const std::string& dbPath,
+           uint8_t repeatAttempts,
+           const Link& keyRetrievalLink,
+           KeyChain* keyChain);
 
   /**
    * @brief Send interest for E-KEY
    *
    * This method simply construct DataCallback, NackCallback, TiemoutCallback using
    * @p timeslot, @p callback, and @p errorCallBack, and express @p interest with
-   * the created callbacks.
+   * the created callbacks. The InterestLifetime is set according to the estimated RTT
+   * of the E-KEY node and the number of retrials already made for @p interest.
    */
   void
   sendKeyInterest(const Interest& interest,
@@ -177,12 +410,19 @@ private:
   /**
    * @brief Decrease the count of outstanding E-KEY interests for C-KEY for @p timeCount
    *
-   * If the count decrease to 0, invoke @p callback.
+   * If the count decrease to 0, remove the request and invoke @p callback.
    */
   void
   updateKeyRequest(KeyRequest& keyRequest, uint64_t timeCount,
                    const ProducerEKeyCallback& callback);
 
+  /**
+   * @brief Remove the request for @p timeCount and its outstanding E-KEY interests, then
+   *        invoke its error callback with @p code
+   */
+  void
+  abortKeyRequest(uint64_t timeCount, ErrorCode code, const std::string& msg);
+
   /**
    * @brief Encrypts C-KEY for @p timeslot using @p encryptionKey of @p eKeyName
    *
@@ -197,22 +437,88 @@ private:
                     const ProducerEKeyCallback& callback,
                     const ErrorCallBack& errorCallback = Producer::defaultErrorCallBack);
 
+  /**
+   * @brief Encrypt the C-KEY @p contentKey for @p timeslot with each of @p eKeys on the
+   *        worker pool, then finish each encrypted C-KEY on the face thread
+   *
+   * @param eKeys Pairs of the E-KEY name and the E-KEY bits
+   */
+  void
+  encryptContentKeyOnPool(const std::vector<std::pair<Name, Buffer>>& eKeys,
+                          const Buffer& contentKey,
+                          const time::system_clock::TimePoint& timeslot,
+                          const ProducerEKeyCallback& callback,
+                          const ErrorCallBack& errorCallback);
+
+  /**
+   * @brief Sign @p cKeyData encrypted by @p eKeyName and add it to the request of @p timeslot
+   */
+  void
+  finishContentKey(Data& cKeyData, const Name& eKeyName, const Buffer& contentKey,
+                   const time::system_clock::TimePoint& timeslot,
+                   const ProducerEKeyCallback& callback);
+
+  /**
+   * @brief Delete a batch of content keys out of the retention window and schedule the next
+   */
+  void
+  pruneContentKeys();
+
+  /**
+   * @brief Encrypt @p segment of @p segmentLen as the segment @p segmentNo of @p dataName
+   */
+  Data
+  createSegment(const Name& dataName, uint64_t segmentNo,
+                const uint8_t* segment, size_t segmentLen,
+                const Name& contentKeyName, const Buffer& contentKey);
+
+  /**
+   * @brief Set the FinalBlockId of @p segments and sign them
+   */
+  void
+  finalizeSegments(std::vector<Data>& segments);
+
 public:
   static const Link NO_LINK;
 
+  /// @brief Default size of the content in a segment, leaving room for name and signature
+  static const size_t DEFAULT_SEGMENT_SIZE;
+
+  /// @brief Maximum number of content keys deleted in one pruning event
+  static const size_t PRUNE_BATCH_SIZE;
+
 private:
   Face& m_face;
+  unique_ptr<KeyChain> m_ownedKeyChain;
+  KeyChain& m_keychain;
   Name m_namespace;
-  KeyChain m_keychain;
   std::unordered_map<Name, KeyInfo> m_ekeyInfo;
   std::unordered_map<uint64_t, KeyRequest> m_keyRequests;
+  time::milliseconds m_keyRequestDeadline;
+  size_t m_maxKeyRequests;
+  time::milliseconds m_interestPacing;
+  KeyRequestMetrics m_keyRequestMetrics;
   ProducerDB m_db;
   uint8_t m_maxRepeatAttempts;
+  RttEstimator m_rttEstimator;
+  shared_ptr<LocalKeyRegistry> m_localKeys;
+  shared_ptr<TraceRecorder> m_trace;
+  tlv::CompressionTypeValue m_compression;
+  TimestampNaming m_timestampNaming;
+  shared_ptr<WorkerPool> m_workerPool;
+  shared_ptr<bool> m_isAlive;
+
+  util::scheduler::Scheduler m_scheduler;
+  time::hours m_retention;
+  time::milliseconds m_pruneInterval;
+  util::scheduler::EventId m_pruneEvent;
+  size_t m_nPruned;
 
   Link m_keyRetrievalLink;
   Block m_linkBlock;
   size_t m_linkSize;
   bool m_useLink;
+  DelegationRacer m_delegationRacer;
 };
 
 } // namespace gep
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rtt-estimator.hpp"
+
+#include <cmath>
+
+namespace ndn {
+namespace gep {
+
+RttEstimator::RttEstimator(const Options& options)
+  : m_options(options)
+{
+}
+
+void
+RttEstimator::addMeasurement(const Name& prefix, const time::nanoseconds& rtt)
+{
+  Statistics& record = m_records.insert({prefix, getStatistics(prefix)}).first->second;
+
+  if (record.nSamples == 0) {
+    record.srtt = rtt;
+    record.rttVar = rtt / 2;
+  }
+  else {
+    double delta = std::abs(static_cast<double>((record.srtt - rtt).count()));
+    record.rttVar = time::nanoseconds(static_cast<int64_t>(
+      (1 - m_options.beta) * record.rttVar.count() + m_options.beta * delta));
+    record.srtt = time::nanoseconds(static_cast<int64_t>(
+      (1 - m_options.alpha) * record.srtt.count() + m_options.alpha * rtt.count()));
+  }
+  record.nSamples++;
+
+  time::nanoseconds rto = record.srtt + std::max<time::nanoseconds>(time::milliseconds(1),
+                                                                    m_options.k * record.rttVar);
+  record.rto = time::duration_cast<time::milliseconds>(rto);
+  record.rto = std::min(std::max(record.rto, m_options.minRto), m_options.maxRto);
+}
+
+void
+RttEstimator::addTimeout(const Name& prefix)
+{
+  Statistics& record = m_records.insert({prefix, getStatistics(prefix)}).first->second;
+  record.nTimeouts++;
+}
+
+time::milliseconds
+RttEstimator::getRto(const Name& prefix) const
+{
+  auto it = m_records.find(prefix);
+  if (it == m_records.end())
+    return m_options.initialRto;
+  return it->second.rto;
+}
+
+time::milliseconds
+RttEstimator::backoff(const Name& prefix, const time::milliseconds& lifetime) const
+{
+  // an Interest without lifetime is backed off from the RTO
+  if (lifetime <= time::milliseconds::zero())
+    return std::min(getRto(prefix) * 2, m_options.maxRto);
+
+  return std::min(lifetime * 2, m_options.maxRto);
+}
+
+RttEstimator::Statistics
+RttEstimator::getStatistics(const Name& prefix) const
+{
+  auto it = m_records.find(prefix);
+  if (it != m_records.end())
+    return it->second;
+
+  Statistics statistics;
+  statistics.srtt = time::nanoseconds::zero();
+  statistics.rttVar = time::nanoseconds::zero();
+  statistics.rto = m_options.initialRto;
+  statistics.nSamples = 0;
+  statistics.nTimeouts = 0;
+  return statistics;
+}
+
+Name
+RttEstimator::getMeasurementPrefix(const Name& name)
+{
+  for (size_t i = 0; i < name.size(); i++) {
+    if (name.get(i) == NAME_COMPONENT_E_KEY ||
+        name.get(i) == NAME_COMPONENT_D_KEY ||
+        name.get(i) == NAME_COMPONENT_C_KEY)
+      return name.getPrefix(i + 1);
+  }
+  return name.getPrefix(-1);
+}
+
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_RTT_ESTIMATOR_HPP
+#define NDN_GEP_RTT_ESTIMATOR_HPP
+
+#include "common.hpp"
+
+namespace ndn {
+namespace gep {
+
+/**
+ * @brief RttEstimator estimates round trip time of key and content retrieval per name prefix
+ *
+ * The estimation follows RFC 6298: a smoothed RTT (SRTT) and an RTT variation (RTTVAR) are
+ * maintained for each prefix, from which a retransmission timeout (RTO) is derived. The RTO
+ * is used as the InterestLifetime of the first transmission, and doubled for each
+ * retransmission (exponential backoff) up to the maximum RTO.
+ */
+class RttEstimator
+{
+public:
+  class Options
+  {
+  public:
+    Options()
+      : initialRto(time::seconds(1))
+      , minRto(time::milliseconds(200))
+      , maxRto(time::seconds(4))
+      , alpha(0.125)
+      , beta(0.25)
+      , k(4)
+    {
+    }
+
+  public:
+    /// @brief RTO used before any measurement is taken for a prefix
+    time::milliseconds initialRto;
+    /// @brief lower bound of RTO
+    time::milliseconds minRto;
+    /// @brief upper bound of RTO, including backed-off RTO
+    time::milliseconds maxRto;
+    /// @brief weight of a new measurement in SRTT
+    double alpha;
+    /// @brief weight of a new measurement in RTTVAR
+    double beta;
+    /// @brief multiplier of RTTVAR in RTO
+    int k;
+  };
+
+  struct Statistics
+  {
+    time::nanoseconds srtt;
+    time::nanoseconds rttVar;
+    time::milliseconds rto;
+    size_t nSamples;
+    size_t nTimeouts;
+  };
+
+public:
+  explicit
+  RttEstimator(const Options& options = Options());
+
+  /**
+   * @brief Add an RTT measurement @p rtt of a retrieval under @p prefix
+   *
+   * Measurements should only be taken from Interests which were not retransmitted.
+   */
+  void
+  addMeasurement(const Name& prefix, const time::nanoseconds& rtt);
+
+  /**
+   * @brief Record a timeout of a retrieval under @p prefix
+   */
+  void
+  addTimeout(const Name& prefix);
+
+  /**
+   * @brief Get the retransmission timeout for the first transmission under @p prefix
+   */
+  time::milliseconds
+  getRto(const Name& prefix) const;
+
+  /**
+   * @brief Get the InterestLifetime of the retransmission of an Interest under @p prefix
+   *        that timed out with @p lifetime
+   */
+  time::milliseconds
+  backoff(const Name& prefix, const time::milliseconds& lifetime) const;
+
+  /**
+   * @brief Get the statistics of retrievals under @p prefix
+   */
+  Statistics
+  getStatistics(const Name& prefix) const;
+
+public:
+  /**
+   * @brief Get the prefix under which retrievals of @p name are measured
+   *
+   * Key names are measured under the prefix ending with E-KEY, D-KEY or C-KEY component,
+   * other names are measured under the prefix without the last (timestamp) component.
+   */
+  static Name
+  getMeasurementPrefix(const Name& name);
+
+private:
+  Options m_options;
+  std::map<Name, Statistics> m_records;
+};
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_RTT_ESTIMATOR_HPP
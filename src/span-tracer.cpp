@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "span-tracer.hpp"
+
+#include <functional>
+#include <thread>
+
+namespace ndn {
+namespace gep {
+
+static int64_t
+toMicroseconds(const time::steady_clock::TimePoint& timePoint)
+{
+  return time::duration_cast<time::microseconds>(timePoint.time_since_epoch()).count();
+}
+
+static uint64_t
+getThreadId()
+{
+  return std::hash<std::thread::id>()(std::this_thread::get_id()) % 100000;
+}
+
+static void
+writeJsonString(std::ostream& os, const std::string& str)
+{
+  os << '"';
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          os << ' ';
+        else
+          os << c;
+    }
+  }
+  os << '"';
+}
+
+SpanTracer&
+SpanTracer::get()
+{
+  static SpanTracer tracer;
+  return tracer;
+}
+
+SpanTracer::SpanTracer()
+  : m_isEnabled(false)
+  , m_lastAsyncId(0)
+{
+}
+
+void
+SpanTracer::enable()
+{
+  m_isEnabled.store(true, std::memory_order_relaxed);
+}
+
+void
+SpanTracer::disable()
+{
+  m_isEnabled.store(false, std::memory_order_relaxed);
+}
+
+void
+SpanTracer::addSpan(const char* name, const time::steady_clock::TimePoint& start,
+                    const std::string& detail)
+{
+  int64_t timestamp = toMicroseconds(start);
+  addEvent({'X', name, detail, timestamp,
+            toMicroseconds(time::steady_clock::now()) - timestamp, 0, getThreadId()});
+}
+
+void
+SpanTracer::addInstant(const char* name, const std::string& detail)
+{
+  addEvent({'i', name, detail, toMicroseconds(time::steady_clock::now()), 0, 0, getThreadId()});
+}
+
+void
+SpanTracer::beginAsync(const char* name, uint64_t id, const std::string& detail)
+{
+  addEvent({'b', name, detail, toMicroseconds(time::steady_clock::now()), 0, id, getThreadId()});
+}
+
+void
+SpanTracer::endAsync(const char* name, uint64_t id, const std::string& detail)
+{
+  addEvent({'e', name, detail, toMicroseconds(time::steady_clock::now()), 0, id, getThreadId()});
+}
+
+void
+SpanTracer::addEvent(Event&& event)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_events.push_back(std::move(event));
+}
+
+size_t
+SpanTracer::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_events.size();
+}
+
+void
+SpanTracer::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_events.clear();
+}
+
+void
+SpanTracer::writeChromeTrace(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (size_t i = 0; i < m_events.size(); i++) {
+    const Event& event = m_events[i];
+    os << (i == 0 ? "\n" : ",\n")
+       << "{\"name\":";
+    writeJsonString(os, event.name);
+    os << ",\"cat\":\"gep\",\"ph\":\"" << event.phase << "\""
+       << ",\"ts\":" << event.timestamp
+       << ",\"pid\":1,\"tid\":" << event.threadId;
+    if (event.phase == 'X')
+      os << ",\"dur\":" << event.duration;
+    else if (event.phase == 'i')
+      os << ",\"s\":\"t\"";
+    else
+      os << ",\"id\":" << event.id;
+    if (!event.detail.empty()) {
+      os << ",\"args\":{\"detail\":";
+      writeJsonString(os, event.detail);
+      os << "}";
+    }
+    os << "}";
+  }
+  os << "\n]}\n";
+}
+
+} // namespace gep
+} // namespace ndn
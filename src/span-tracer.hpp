@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_SPAN_TRACER_HPP
+#define NDN_GEP_SPAN_TRACER_HPP
+
+#include "common.hpp"
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+
+namespace ndn {
+namespace gep {
+
+/**
+ * @brief Process-wide collector of spans, exported in the Chrome trace event format
+ *
+ * The spans are recorded only once the tracer is enabled at runtime. The instrumentation
+ * macros below are compiled out unless the library is configured with --with-tracing, and
+ * cost one relaxed atomic load when the tracer is disabled. The trace can be loaded in
+ * chrome://tracing or Perfetto.
+ */
+class SpanTracer : noncopyable
+{
+public:
+  /// @brief Get the tracer of the process
+  static SpanTracer&
+  get();
+
+  void
+  enable();
+
+  void
+  disable();
+
+  bool
+  isEnabled() const
+  {
+    return m_isEnabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Record a span @p name of the current thread from @p start to now
+   *
+   * @p name must be a string literal. @p detail is shown as argument of the span.
+   */
+  void
+  addSpan(const char* name, const time::steady_clock::TimePoint& start,
+          const std::string& detail = "");
+
+  /// @brief Record an instant event @p name of the current thread
+  void
+  addInstant(const char* name, const std::string& detail = "");
+
+  /// @brief Record the beginning of the asynchronous operation @p name identified by @p id
+  void
+  beginAsync(const char* name, uint64_t id, const std::string& detail = "");
+
+  /// @brief Record the end of the asynchronous operation @p name identified by @p id
+  void
+  endAsync(const char* name, uint64_t id, const std::string& detail = "");
+
+  /// @brief Get a new identifier for an asynchronous operation
+  uint64_t
+  getNextAsyncId()
+  {
+    return ++m_lastAsyncId;
+  }
+
+  /// @brief Get the number of events recorded
+  size_t
+  size() const;
+
+  /// @brief Remove all the events recorded
+  void
+  clear();
+
+  /// @brief Write the events recorded as a Chrome trace JSON object to @p os
+  void
+  writeChromeTrace(std::ostream& os) const;
+
+PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  SpanTracer();
+
+private:
+  struct Event
+  {
+    char phase;
+    const char* name;
+    std::string detail;
+    int64_t timestamp;
+    int64_t duration;
+    uint64_t id;
+    uint64_t threadId;
+  };
+
+  void
+  addEvent(Event&& event);
+
+private:
+  std::atomic<bool> m_isEnabled;
+  std::atomic<uint64_t> m_lastAsyncId;
+  mutable std::mutex m_mutex;
+  std::vector<Event> m_events;
+};
+
+/**
+ * @brief Span covering the lifetime of the object, recorded if the tracer is enabled
+ */
+class ScopedSpan : noncopyable
+{
+public:
+  explicit
+  ScopedSpan(const char* name)
+    : m_name(SpanTracer::get().isEnabled() ? name : nullptr)
+  {
+    if (m_name != nullptr)
+      m_start = time::steady_clock::now();
+  }
+
+  ~ScopedSpan()
+  {
+    if (m_name != nullptr)
+      SpanTracer::get().addSpan(m_name, m_start, m_detail);
+  }
+
+  /// @brief Set the argument shown with the span
+  void
+  setDetail(const std::string& detail)
+  {
+    if (m_name != nullptr)
+      m_detail = detail;
+  }
+
+private:
+  const char* m_name;
+  time::steady_clock::TimePoint m_start;
+  std::string m_detail;
+};
+
+} // namespace gep
+} // namespace ndn
+
+#ifdef NDN_GEP_WITH_TRACING
+
+/// @brief Record the rest of the enclosing scope as span @p name, as variable @p var
+#define NDN_GEP_SPAN(var, name) ::ndn::gep::ScopedSpan var(name)
+/// @brief Set the detail of span variable @p var
+#define NDN_GEP_SPAN_DETAIL(var, detail) var.setDetail(detail)
+/// @brief Record instant event @p name with @p detail
+#define NDN_GEP_INSTANT(name, detail)                                  \
+  do {                                                                 \
+    if (::ndn::gep::SpanTracer::get().isEnabled())                     \
+      ::ndn::gep::SpanTracer::get().addInstant(name, detail);          \
+  } while (false)
+/// @brief Declare @p var as a new asynchronous operation identifier, 0 if not tracing
+#define NDN_GEP_ASYNC_ID(var)                                          \
+  uint64_t var = ::ndn::gep::SpanTracer::get().isEnabled() ?           \
+                 ::ndn::gep::SpanTracer::get().getNextAsyncId() : 0
+/// @brief Record the beginning of asynchronous operation @p name identified by @p id
+#define NDN_GEP_ASYNC_BEGIN(name, id, detail)                          \
+  do {                                                                 \
+    if ((id) != 0)                                                     \
+      ::ndn::gep::SpanTracer::get().beginAsync(name, id, detail);      \
+  } while (false)
+/// @brief Record the end of asynchronous operation @p name identified by @p id
+#define NDN_GEP_ASYNC_END(name, id, detail)                            \
+  do {                                                                 \
+    if ((id) != 0)                                                     \
+      ::ndn::gep::SpanTracer::get().endAsync(name, id, detail);        \
+  } while (false)
+
+#else
+
+#define NDN_GEP_SPAN(var, name) do {} while (false)
+#define NDN_GEP_SPAN_DETAIL(var, detail) do {} while (false)
+#define NDN_GEP_INSTANT(name, detail) do {} while (false)
+#define NDN_GEP_ASYNC_ID(var) const uint64_t var = 0; (void)var
+#define NDN_GEP_ASYNC_BEGIN(name, id, detail) do { (void)(id); } while (false)
+#define NDN_GEP_ASYNC_END(name, id, detail) do { (void)(id); } while (false)
+
+#endif // NDN_GEP_WITH_TRACING
+
+#endif // NDN_GEP_SPAN_TRACER_HPP
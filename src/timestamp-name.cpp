@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timestamp-name.hpp"
+
+namespace ndn {
+namespace gep {
+
+static const TimeStamp UNIX_EPOCH(boost::gregorian::date(1970, 1, 1));
+
+time::system_clock::TimePoint
+toTimePoint(const TimeStamp& timestamp)
+{
+  return time::getUnixEpoch() + time::microseconds((timestamp - UNIX_EPOCH).total_microseconds());
+}
+
+name::Component
+encodeTimestamp(const time::system_clock::TimePoint& timestamp, TimestampNaming naming)
+{
+  if (naming == TimestampNaming::Binary)
+    return name::Component::fromTimestamp(timestamp);
+  return name::Component(time::toIsoString(timestamp));
+}
+
+name::Component
+encodeTimestamp(const TimeStamp& timestamp, TimestampNaming naming)
+{
+  if (naming == TimestampNaming::Binary)
+    return name::Component::fromTimestamp(toTimePoint(timestamp));
+  return name::Component(boost::posix_time::to_iso_string(timestamp));
+}
+
+time::system_clock::TimePoint
+decodeTimestamp(const name::Component& component)
+{
+  // an ISO string starts with a digit, never with the timestamp marker
+  if (component.isTimestamp())
+    return component.toTimestamp();
+  return time::fromIsoString(component.toUri());
+}
+
+TimestampNaming
+getTimestampNaming(const name::Component& component)
+{
+  return component.isTimestamp() ? TimestampNaming::Binary : TimestampNaming::Iso;
+}
+
+} // namespace gep
+} // namespace ndn
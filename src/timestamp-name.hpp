@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_TIMESTAMP_NAME_HPP
+#define NDN_GEP_TIMESTAMP_NAME_HPP
+
+#include "common.hpp"
+#include "interval.hpp"
+
+namespace ndn {
+namespace gep {
+
+/**
+ * @brief Encoding of the timestamp components in E-KEY, D-KEY, C-KEY and data names
+ */
+enum class TimestampNaming {
+  /// @brief ISO string, e.g. 20150825T080000 (default)
+  Iso,
+  /// @brief Binary timestamp of the NDN naming conventions, in microseconds since the epoch
+  Binary
+};
+
+/**
+ * @brief Convert @p timestamp to a time point of the system clock
+ */
+time::system_clock::TimePoint
+toTimePoint(const TimeStamp& timestamp);
+
+/**
+ * @brief Encode @p timestamp as a name component with @p naming
+ */
+name::Component
+encodeTimestamp(const time::system_clock::TimePoint& timestamp, TimestampNaming naming);
+
+/**
+ * @brief Encode @p timestamp as a name component with @p naming
+ */
+name::Component
+encodeTimestamp(const TimeStamp& timestamp, TimestampNaming naming);
+
+/**
+ * @brief Decode the timestamp in @p component, in either naming
+ *
+ * @throw std::exception @p component is neither a binary timestamp nor an ISO string
+ */
+time::system_clock::TimePoint
+decodeTimestamp(const name::Component& component);
+
+/**
+ * @brief Get the naming of the timestamp in @p component
+ */
+TimestampNaming
+getTimestampNaming(const name::Component& component);
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_TIMESTAMP_NAME_HPP
@@ -44,7 +44,21 @@ enum {
   // for schedule
   WhiteIntervalList = 141,
   BlackIntervalList = 142,
-  Schedule = 143
+  Schedule = 143,
+
+  // for D-KEY bundle
+  DKeyBundle = 144,
+  DKeyEntry = 145,
+  DKeyBits = 146,
+
+  CompressionAlgorithm = 147,
+
+  // for group manager snapshot
+  SnapshotSchedule = 148,
+  ScheduleName = 149,
+  SnapshotMember = 150,
+  ScheduleIndex = 151,
+  MemberKey = 152
 };
 
 enum AlgorithmTypeValue {
@@ -54,6 +68,12 @@ enum AlgorithmTypeValue {
   AlgorithmRsaOaep = 3
 };
 
+enum CompressionTypeValue {
+  CompressionNone = 0,
+  CompressionLz4 = 1,
+  CompressionZstd = 2
+};
+
 } // namespace tlv
 } // namespace gep
 } // namespace ndn
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace-recorder.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+#include <iterator>
+
+namespace ndn {
+namespace gep {
+
+using time::system_clock;
+
+static const char MAGIC[] = {'G', 'E', 'P', 'T'};
+static const size_t HEADER_SIZE = sizeof(MAGIC) + 1 + 8;
+
+const uint8_t TraceRecorder::VERSION = 1;
+
+static uint64_t
+toMicroseconds(const system_clock::TimePoint& timePoint)
+{
+  return time::duration_cast<time::microseconds>(timePoint.time_since_epoch()).count();
+}
+
+TraceRecorder::TraceRecorder(const std::string& path)
+  : m_os(path, std::ios::binary | std::ios::trunc)
+  , m_lastTime(system_clock::now())
+  , m_nRecords(0)
+{
+  if (!m_os)
+    BOOST_THROW_EXCEPTION(Error("Trace cannot be created: " + path));
+
+  uint8_t header[HEADER_SIZE];
+  std::copy(MAGIC, MAGIC + sizeof(MAGIC), header);
+  header[sizeof(MAGIC)] = VERSION;
+  uint64_t startTime = toMicroseconds(m_lastTime);
+  for (size_t i = 0; i < 8; i++)
+    header[HEADER_SIZE - 1 - i] = static_cast<uint8_t>(startTime >> (8 * i));
+  m_os.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+TraceRecorder::~TraceRecorder()
+{
+  flush();
+}
+
+void
+TraceRecorder::record(trace::EventType type, const Name& name, const Name& actor,
+                      const system_clock::TimePoint& timeslot, uint64_t size)
+{
+  Block record(type);
+  record.push_back(name.wireEncode());
+  if (!actor.empty())
+    record.push_back(Block(trace::Actor, actor.wireEncode()));
+  if (timeslot != system_clock::TimePoint())
+    record.push_back(makeNonNegativeIntegerBlock(trace::Timeslot,
+                                                 time::toUnixTimestamp(timeslot).count()));
+  if (size > 0)
+    record.push_back(makeNonNegativeIntegerBlock(trace::Size, size));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // the time offset is taken under the lock, so that the records are in time order
+  system_clock::TimePoint now = system_clock::now();
+  uint64_t offset = now > m_lastTime ? toMicroseconds(now) - toMicroseconds(m_lastTime) : 0;
+  m_lastTime = std::max(now, m_lastTime);
+  record.push_back(makeNonNegativeIntegerBlock(trace::TimeOffset, offset));
+  record.encode();
+
+  m_os.write(reinterpret_cast<const char*>(record.wire()), record.size());
+  m_nRecords++;
+}
+
+void
+TraceRecorder::flush()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_os.flush();
+}
+
+size_t
+TraceRecorder::getNRecords() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nRecords;
+}
+
+TraceReader::TraceReader(const std::string& path)
+  : m_offset(HEADER_SIZE)
+{
+  std::ifstream is(path, std::ios::binary);
+  if (!is)
+    BOOST_THROW_EXCEPTION(Error("Trace cannot be opened: " + path));
+  m_buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+
+  if (m_buffer.size() < HEADER_SIZE ||
+      !std::equal(MAGIC, MAGIC + sizeof(MAGIC), m_buffer.begin()))
+    BOOST_THROW_EXCEPTION(Error("Not a trace: " + path));
+  if (m_buffer[sizeof(MAGIC)] != TraceRecorder::VERSION)
+    BOOST_THROW_EXCEPTION(Error("Unsupported trace version: " +
+                                std::to_string(m_buffer[sizeof(MAGIC)])));
+
+  uint64_t startTime = 0;
+  for (size_t i = sizeof(MAGIC) + 1; i < HEADER_SIZE; i++)
+    startTime = (startTime << 8) | m_buffer[i];
+  m_startTime = system_clock::TimePoint(time::microseconds(startTime));
+  m_lastTime = m_startTime;
+}
+
+bool
+TraceReader::read(TraceRecord& record)
+{
+  if (m_offset >= m_buffer.size())
+    return false;
+
+  try {
+    Block block(m_buffer.buf() + m_offset, m_buffer.size() - m_offset);
+    m_offset += block.size();
+    block.parse();
+
+    record = TraceRecord();
+    record.type = static_cast<trace::EventType>(block.type());
+    record.name.wireDecode(block.get(tlv::Name));
+
+    auto it = block.find(trace::Actor);
+    if (it != block.elements_end())
+      record.actor.wireDecode(it->blockFromValue());
+
+    it = block.find(trace::Timeslot);
+    if (it != block.elements_end())
+      record.timeslot = time::fromUnixTimestamp(time::milliseconds(readNonNegativeInteger(*it)));
+
+    it = block.find(trace::Size);
+    if (it != block.elements_end())
+      record.size = readNonNegativeInteger(*it);
+
+    m_lastTime += time::microseconds(readNonNegativeInteger(block.get(trace::TimeOffset)));
+    record.time = m_lastTime;
+  }
+  catch (const tlv::Error& e) {
+    BOOST_THROW_EXCEPTION(Error(std::string("Malformed trace record: ") + e.what()));
+  }
+  return true;
+}
+
+} // namespace gep
+} // namespace ndn
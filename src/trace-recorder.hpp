@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_TRACE_RECORDER_HPP
+#define NDN_GEP_TRACE_RECORDER_HPP
+
+#include "common.hpp"
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <fstream>
+#include <mutex>
+
+namespace ndn {
+namespace gep {
+
+namespace trace {
+
+/// @brief Types of the events in a workload trace
+enum EventType {
+  /// Producer::produce, with the namespace, the timeslot and the content size
+  Produce = 1,
+  /// A new C-KEY, with its name, its timeslot and the number of E-KEY nodes
+  ContentKey = 2,
+  /// Consumer::consume, with the data name and the consumer name
+  Consume = 3,
+  /// A consumption completed, with the data name, the consumer name and the payload size
+  Consumed = 4,
+  /// A consumption failed, with the data name, the consumer name and the error code
+  ConsumeError = 5,
+  /// A C-KEY retrieved from the network, with the C-KEY name and the consumer name
+  CKeyRequest = 6,
+  /// A D-KEY retrieved from the network, with the D-KEY name and the consumer name
+  DKeyRequest = 7,
+  /// GroupManager::getGroupKey, with the namespace, the timeslot and the number of packets
+  GroupKey = 8
+};
+
+/// @brief TLV types of the fields of a trace record
+enum FieldType {
+  TimeOffset = 128,
+  Actor = 129,
+  Timeslot = 130,
+  Size = 131
+};
+
+} // namespace trace
+
+/**
+ * @brief An event of a workload trace
+ */
+struct TraceRecord
+{
+  trace::EventType type;
+  /// @brief When the event happened
+  time::system_clock::TimePoint time;
+  Name name;
+  /// @brief The consumer involved, empty for the other events
+  Name actor;
+  /// @brief The timeslot of the event, the epoch if it has none
+  time::system_clock::TimePoint timeslot;
+  uint64_t size = 0;
+};
+
+/**
+ * @brief Recorder of the calls to the library into a compact binary trace
+ *
+ * The trace starts with the magic "GEPT", a version octet and the start time in
+ * microseconds since the epoch, as 8 octets in network order. It is followed by one TLV
+ * block per record, whose type is the event type. The block carries the time since the
+ * previous record in microseconds, the name, and the actor, timeslot and size unless
+ * they are empty.
+ *
+ * The recorder can be shared by instances running in different threads.
+ */
+class TraceRecorder : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+public:
+  /**
+   * @brief Create a trace at @p path
+   * @throw Error the trace cannot be created
+   */
+  explicit
+  TraceRecorder(const std::string& path);
+
+  ~TraceRecorder();
+
+  /**
+   * @brief Record an event of @p type at the current time
+   */
+  void
+  record(trace::EventType type, const Name& name, const Name& actor = Name(),
+         const time::system_clock::TimePoint& timeslot = time::system_clock::TimePoint(),
+         uint64_t size = 0);
+
+  /// @brief Write the buffered records to the trace
+  void
+  flush();
+
+  /// @brief Get the number of events recorded
+  size_t
+  getNRecords() const;
+
+public:
+  static const uint8_t VERSION;
+
+private:
+  mutable std::mutex m_mutex;
+  std::ofstream m_os;
+  time::system_clock::TimePoint m_lastTime;
+  size_t m_nRecords;
+};
+
+/**
+ * @brief Reader of the traces written by TraceRecorder
+ */
+class TraceReader : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+public:
+  /**
+   * @brief Open the trace at @p path
+   * @throw Error the trace cannot be read or has an unknown format
+   */
+  explicit
+  TraceReader(const std::string& path);
+
+  /**
+   * @brief Read the next record into @p record
+   *
+   * @return false at the end of the trace
+   * @throw Error the record is malformed
+   */
+  bool
+  read(TraceRecord& record);
+
+  /// @brief Get the time the trace was started
+  const time::system_clock::TimePoint&
+  getStartTime() const
+  {
+    return m_startTime;
+  }
+
+private:
+  Buffer m_buffer;
+  size_t m_offset;
+  time::system_clock::TimePoint m_startTime;
+  time::system_clock::TimePoint m_lastTime;
+};
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_TRACE_RECORDER_HPP
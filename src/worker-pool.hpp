@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_WORKER_POOL_HPP
+#define NDN_GEP_WORKER_POOL_HPP
+
+#include "common.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ndn {
+namespace gep {
+
+/**
+ * @brief Fixed set of threads running the tasks posted to it in FIFO order
+ *
+ * The tasks must not touch the state owned by the face thread; the results are handed
+ * back by posting to the io_service of the face.
+ */
+class WorkerPool : noncopyable
+{
+public:
+  typedef function<void()> Task;
+
+  /**
+   * @brief Start @p nThreads threads, the number of hardware threads if 0
+   */
+  explicit
+  WorkerPool(size_t nThreads = 0);
+
+  /**
+   * @brief Run the tasks already posted, then stop the threads
+   */
+  ~WorkerPool();
+
+  /**
+   * @brief Run @p task on one of the threads
+   */
+  void
+  post(const Task& task);
+
+  size_t
+  size() const
+  {
+    return m_threads.size();
+  }
+
+private:
+  void
+  run();
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_hasTask;
+  std::queue<Task> m_tasks;
+  bool m_isStopped;
+  std::vector<std::thread> m_threads;
+};
+
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_WORKER_POOL_HPP
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark of the decryption of many contents encrypted with the same C-KEY: throughput
+ * of decrypting them one by one with Aes::decrypt against one Aes::decryptBatch call,
+ * for several payload sizes.
+ *
+ * Usage: aes-batch [contents per batch] [iterations]
+ */
+
+#include "algo/aes.hpp"
+#include "random-number-generator.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+static double
+toMegabytesPerSecond(size_t nBytes, const time::nanoseconds& duration)
+{
+  return nBytes / 1e6 / (duration.count() / 1e9);
+}
+
+static void
+measure(size_t payloadSize, size_t batchSize, size_t nIterations,
+        const Buffer& key, RandomNumberGenerator& rng)
+{
+  std::vector<Buffer> ivs;
+  std::vector<Buffer> cipherTexts;
+  Buffer plainText(payloadSize);
+  rng.GenerateBlock(plainText.buf(), plainText.size());
+  for (size_t i = 0; i < batchSize; i++) {
+    algo::EncryptParams params(tlv::AlgorithmAesCbc, 16);
+    cipherTexts.push_back(algo::Aes::encrypt(key.buf(), key.size(),
+                                             plainText.buf(), plainText.size(), params));
+    ivs.push_back(params.getIV());
+  }
+
+  std::vector<algo::Aes::CbcPayload> payloads;
+  for (size_t i = 0; i < batchSize; i++)
+    payloads.push_back({ivs[i].buf(), cipherTexts[i].buf(), cipherTexts[i].size()});
+
+  size_t nBytes = 0;
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  for (size_t n = 0; n < nIterations; n++) {
+    for (size_t i = 0; i < batchSize; i++) {
+      algo::EncryptParams params(tlv::AlgorithmAesCbc);
+      params.setIV(ivs[i].buf(), ivs[i].size());
+      nBytes += algo::Aes::decrypt(key.buf(), key.size(), cipherTexts[i].buf(),
+                                   cipherTexts[i].size(), params).size();
+    }
+  }
+  time::nanoseconds perPacketTime = time::steady_clock::now() - start;
+
+  size_t nBatchBytes = 0;
+  start = time::steady_clock::now();
+  for (size_t n = 0; n < nIterations; n++) {
+    for (const auto& result : algo::Aes::decryptBatch(key.buf(), key.size(), payloads))
+      nBatchBytes += result.size();
+  }
+  time::nanoseconds batchTime = time::steady_clock::now() - start;
+
+  if (nBytes != nBatchBytes) {
+    std::cerr << "batch decryption mismatch" << std::endl;
+    std::exit(1);
+  }
+
+  std::cout << payloadSize << ", " << batchSize << ", "
+            << toMegabytesPerSecond(nBytes, perPacketTime) << ", "
+            << toMegabytesPerSecond(nBatchBytes, batchTime) << std::endl;
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t batchSize = argc > 1 ? std::stoul(argv[1]) : 1000;
+  size_t nIterations = argc > 2 ? std::stoul(argv[2]) : 20;
+
+  RandomNumberGenerator rng;
+  AesKeyParams aesParams;
+  ndn::Buffer key = algo::Aes::generateKey(rng, aesParams).getKeyBits();
+
+  std::cout << "payload size, contents per batch, "
+            << "per-packet throughput (MB/s), batch throughput (MB/s)" << std::endl;
+  for (size_t payloadSize : {32, 256, 1024, 4096, 8000})
+    measure(payloadSize, batchSize, nIterations, key, rng);
+  return 0;
+}
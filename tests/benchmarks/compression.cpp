@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark of content compression before encryption: bytes of the encrypted content
+ * against CPU time per sample to encrypt and decrypt it, for JSON and CSV sensor samples
+ * of several sizes.
+ *
+ * Usage: compression [iterations]
+ */
+
+#include "algo/aes.hpp"
+#include "algo/compression.hpp"
+#include "algo/encryptor.hpp"
+#include "encrypted-content.hpp"
+#include "random-number-generator.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+static std::string
+makeJsonSamples(size_t size, RandomNumberGenerator& rng)
+{
+  std::ostringstream os;
+  for (int i = 0; os.tellp() < static_cast<std::streamoff>(size); i++) {
+    os << "{\"ts\":" << 1445000000000 + i * 1000
+       << ",\"sensor\":\"building-4/floor-2/room-" << (i % 12) << "/temperature\""
+       << ",\"value\":" << 20 + rng.GenerateWord32(0, 500) / 100.0
+       << ",\"unit\":\"C\"}\n";
+  }
+  return os.str().substr(0, size);
+}
+
+static std::string
+makeCsvSamples(size_t size, RandomNumberGenerator& rng)
+{
+  std::ostringstream os;
+  os << "ts,sensor,value\n";
+  for (int i = 0; os.tellp() < static_cast<std::streamoff>(size); i++) {
+    os << 1445000000000 + i * 1000 << ",room-" << (i % 12) << ","
+       << 20 + rng.GenerateWord32(0, 500) / 100.0 << "\n";
+  }
+  return os.str().substr(0, size);
+}
+
+static const char*
+toString(tlv::CompressionTypeValue type)
+{
+  switch (type) {
+    case tlv::CompressionLz4:
+      return "lz4";
+    case tlv::CompressionZstd:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+static void
+measure(const std::string& format, const std::string& samples,
+        tlv::CompressionTypeValue type, size_t nIterations, const Buffer& key)
+{
+  size_t wireSize = 0;
+  time::nanoseconds encryptTime(0);
+  time::nanoseconds decryptTime(0);
+
+  for (size_t i = 0; i < nIterations; i++) {
+    Data data("/prefix/SAMPLE/data_type");
+    algo::EncryptParams params(tlv::AlgorithmAesCbc, 16);
+    params.setCompressionType(type);
+
+    time::steady_clock::TimePoint start = time::steady_clock::now();
+    algo::encryptData(data, reinterpret_cast<const uint8_t*>(samples.data()), samples.size(),
+                      Name("/prefix/SAMPLE/data_type/C-KEY/1"), key.buf(), key.size(), params);
+    encryptTime += time::steady_clock::now() - start;
+    wireSize = data.getContent().value_size();
+
+    start = time::steady_clock::now();
+    EncryptedContent content(data.getContent().blockFromValue());
+    Buffer plainText = algo::Aes::decrypt(key.buf(), key.size(), content.getPayload().buf(),
+                                          content.getPayload().size(), params);
+    if (content.getCompressionAlgorithm() != tlv::CompressionNone)
+      plainText = algo::Compression::decompress(content.getCompressionAlgorithm(),
+                                                plainText.buf(), plainText.size());
+    decryptTime += time::steady_clock::now() - start;
+
+    if (plainText.size() != samples.size()) {
+      std::cerr << "round trip failed" << std::endl;
+      std::exit(1);
+    }
+  }
+
+  std::cout << format << ", " << samples.size() << ", " << toString(type) << ", "
+            << wireSize << ", "
+            << time::duration_cast<time::nanoseconds>(encryptTime).count() / nIterations / 1000.0
+            << ", "
+            << time::duration_cast<time::nanoseconds>(decryptTime).count() / nIterations / 1000.0
+            << std::endl;
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t nIterations = argc > 1 ? std::stoul(argv[1]) : 1000;
+
+  RandomNumberGenerator rng;
+  AesKeyParams aesParams;
+  ndn::Buffer key = algo::Aes::generateKey(rng, aesParams).getKeyBits();
+
+  std::cout << "format, sample size, compression, encrypted content size, "
+            << "encrypt time (us), decrypt time (us)" << std::endl;
+  for (size_t size : {256, 1024, 4096, 8000}) {
+    std::string json = makeJsonSamples(size, rng);
+    std::string csv = makeCsvSamples(size, rng);
+    for (auto type : {tlv::CompressionNone, tlv::CompressionLz4, tlv::CompressionZstd}) {
+      if (!algo::Compression::isSupported(type))
+        continue;
+      measure("json", json, type, nIterations, key);
+      measure("csv", csv, type, nIterations, key);
+    }
+  }
+  return 0;
+}
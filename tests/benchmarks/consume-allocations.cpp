@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark of the heap allocations made by one consume, through the callback API and
+ * through the future API.
+ *
+ * The content, C-KEY and D-KEY are answered by a dummy face, so only the consumer side is
+ * measured. A cold consume retrieves the content and both keys; a warm consume retrieves
+ * the content only, decrypting it with the saved C-KEY.
+ */
+
+#include "consumer.hpp"
+#include "algo/encryptor.hpp"
+#include "random-number-generator.hpp"
+
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static size_t g_nAllocations = 0;
+
+void*
+operator new(std::size_t size)
+{
+  ++g_nAllocations;
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void*
+operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+static const size_t N_WARM_CONSUMES = 50;
+
+class ConsumeBenchmark
+{
+public:
+  ConsumeBenchmark()
+    : m_tmpPath(TMP_BENCHMARKS_PATH)
+    , m_face(util::makeDummyClientFace(m_io, {false, true}))
+    , m_contentName("/Prefix/SAMPLE/Content")
+    , m_groupName("/Prefix/READ")
+    , m_consumerName("/U")
+    , m_consumerKeyName("/U/Key")
+  {
+    boost::filesystem::create_directories(m_tmpPath);
+
+    RandomNumberGenerator rng;
+    RsaKeyParams rsaParams;
+    m_consumerDKey = algo::Rsa::generateKey(rng, rsaParams).getKeyBits();
+    Buffer consumerEKey = algo::Rsa::deriveEncryptKey(m_consumerDKey).getKeyBits();
+    Buffer groupDKey = algo::Rsa::generateKey(rng, rsaParams).getKeyBits();
+    Buffer groupEKey = algo::Rsa::deriveEncryptKey(groupDKey).getKeyBits();
+    AesKeyParams aesParams;
+    Buffer cKey = algo::Aes::generateKey(rng, aesParams).getKeyBits();
+
+    Name cKeyName("/Prefix/SAMPLE/Content/C-KEY/1");
+    Name dKeyName("/Prefix/READ/D-KEY/1/2");
+    std::vector<uint8_t> content(1024, 0xAB);
+
+    m_packets.push_back(createData(m_contentName, content.data(), content.size(),
+                                   cKeyName, cKey, tlv::AlgorithmAesCbc));
+    m_packets.push_back(createData(cKeyName, cKey.buf(), cKey.size(),
+                                   dKeyName, groupEKey, tlv::AlgorithmRsaOaep));
+    m_packets.push_back(createData(dKeyName, groupDKey.buf(), groupDKey.size(),
+                                   m_consumerKeyName, consumerEKey, tlv::AlgorithmRsaOaep));
+
+    // answer the interests of the consumer
+    m_face->onSendInterest.connect([this] (const Interest& interest) {
+        for (const auto& data : m_packets) {
+          if (interest.matchesData(*data)) {
+            m_io.post([this, data] { m_face->receive(*data); });
+            return;
+          }
+        }
+      });
+  }
+
+  ~ConsumeBenchmark()
+  {
+    boost::filesystem::remove_all(m_tmpPath);
+  }
+
+  void
+  run()
+  {
+    std::cout << "consume API, allocations of cold consume, allocations per warm consume"
+              << std::endl;
+    measure("callback", [this] (Consumer& consumer, bool& isDone) {
+        consumer.consume(m_contentName,
+                         [&isDone] (const Data&, const Buffer&) { isDone = true; },
+                         [] (const ErrorCode&, const std::string& msg) {
+                           std::cerr << "consume failed: " << msg << std::endl;
+                           std::exit(1);
+                         });
+      });
+    measure("future", [this] (Consumer& consumer, bool& isDone) {
+        consumer.consumeAsync(m_contentName)
+          .then([&isDone] (const ConsumedData&) { isDone = true; },
+                [] (const ErrorCode&, const std::string& msg) {
+                  std::cerr << "consume failed: " << msg << std::endl;
+                  std::exit(1);
+                });
+      });
+  }
+
+private:
+  shared_ptr<Data>
+  createData(const Name& name, const uint8_t* payload, size_t payloadLen,
+             const Name& keyName, const Buffer& key, tlv::AlgorithmTypeValue algorithm)
+  {
+    auto data = make_shared<Data>(name);
+    algo::EncryptParams params(algorithm, algorithm == tlv::AlgorithmAesCbc ? 16 : 0);
+    algo::encryptData(*data, payload, payloadLen, keyName, key.buf(), key.size(), params);
+    m_keyChain.signWithSha256(*data);
+    data->wireEncode();
+    return data;
+  }
+
+  void
+  measure(const std::string& api, const function<void(Consumer&, bool&)>& consume)
+  {
+    std::string dbPath = (m_tmpPath / (api + ".db")).string();
+    Consumer consumer(*m_face, m_groupName, m_consumerName, dbPath);
+    consumer.addDecryptionKey(m_consumerKeyName, m_consumerDKey);
+
+    size_t nColdAllocations = consumeOnce(consumer, consume);
+
+    size_t nWarmAllocations = 0;
+    for (size_t i = 0; i < N_WARM_CONSUMES; i++)
+      nWarmAllocations += consumeOnce(consumer, consume);
+
+    std::cout << api << ", " << nColdAllocations << ", "
+              << static_cast<double>(nWarmAllocations) / N_WARM_CONSUMES << std::endl;
+  }
+
+  size_t
+  consumeOnce(Consumer& consumer, const function<void(Consumer&, bool&)>& consume)
+  {
+    bool isDone = false;
+    size_t nAllocationsBefore = g_nAllocations;
+    consume(consumer, isDone);
+    while (!isDone) {
+      m_io.poll();
+      m_io.reset();
+    }
+    return g_nAllocations - nAllocationsBefore;
+  }
+
+private:
+  boost::filesystem::path m_tmpPath;
+  boost::asio::io_service m_io;
+  shared_ptr<util::DummyClientFace> m_face;
+  KeyChain m_keyChain;
+
+  Name m_contentName;
+  Name m_groupName;
+  Name m_consumerName;
+  Name m_consumerKeyName;
+  Buffer m_consumerDKey;
+  std::vector<shared_ptr<Data>> m_packets;
+};
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main()
+{
+  ndn::gep::benchmarks::ConsumeBenchmark benchmark;
+  benchmark.run();
+  return 0;
+}
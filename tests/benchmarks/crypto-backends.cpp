@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Benchmark of the crypto backends built in the library: RSA key generation, wrapping and
+ * unwrapping of a C-KEY with RSA-OAEP, and AES-CBC encryption and decryption of contents,
+ * in operations per second for every backend.
+ *
+ * Usage: crypto-backends [rsa key size] [iterations] [payload size]
+ */
+
+#include "algo/crypto-backend.hpp"
+#include "random-number-generator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+static double
+toOperationsPerSecond(size_t nOperations, const time::nanoseconds& duration)
+{
+  return nOperations / (duration.count() / 1e9);
+}
+
+static void
+measure(algo::CryptoBackend& backend, size_t keySize, size_t nIterations, size_t payloadSize,
+        RandomNumberGenerator& rng)
+{
+  // generate fewer RSA keys, they are orders of magnitude slower than the other operations
+  size_t nKeys = std::max<size_t>(nIterations / 100, 1);
+  Buffer privateKey;
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  for (size_t i = 0; i < nKeys; i++)
+    privateKey = backend.generateRsaKey(rng, keySize);
+  time::nanoseconds keygenTime = time::steady_clock::now() - start;
+  Buffer publicKey = backend.deriveRsaPublicKey(privateKey.buf(), privateKey.size());
+
+  Buffer cKey(16);
+  rng.GenerateBlock(cKey.buf(), cKey.size());
+  Buffer wrapped;
+  start = time::steady_clock::now();
+  for (size_t i = 0; i < nIterations; i++)
+    wrapped = backend.encryptRsa(publicKey.buf(), publicKey.size(), cKey.buf(), cKey.size(),
+                                 tlv::AlgorithmRsaOaep);
+  time::nanoseconds wrapTime = time::steady_clock::now() - start;
+
+  Buffer unwrapped;
+  start = time::steady_clock::now();
+  for (size_t i = 0; i < nIterations; i++)
+    unwrapped = backend.decryptRsa(privateKey.buf(), privateKey.size(),
+                                   wrapped.buf(), wrapped.size(), tlv::AlgorithmRsaOaep);
+  time::nanoseconds unwrapTime = time::steady_clock::now() - start;
+
+  Buffer iv(16);
+  rng.GenerateBlock(iv.buf(), iv.size());
+  Buffer plainText(payloadSize);
+  rng.GenerateBlock(plainText.buf(), plainText.size());
+  Buffer cipherText;
+  start = time::steady_clock::now();
+  for (size_t i = 0; i < nIterations; i++)
+    cipherText = backend.encryptAes(tlv::AlgorithmAesCbc, cKey.buf(), cKey.size(), iv.buf(),
+                                    plainText.buf(), plainText.size());
+  time::nanoseconds encryptTime = time::steady_clock::now() - start;
+
+  Buffer decrypted;
+  start = time::steady_clock::now();
+  for (size_t i = 0; i < nIterations; i++)
+    decrypted = backend.decryptAes(tlv::AlgorithmAesCbc, cKey.buf(), cKey.size(), iv.buf(),
+                                   cipherText.buf(), cipherText.size());
+  time::nanoseconds decryptTime = time::steady_clock::now() - start;
+
+  if (unwrapped != cKey || decrypted != plainText) {
+    std::cerr << backend.getName() << ": roundtrip mismatch" << std::endl;
+    std::exit(1);
+  }
+
+  std::cout << backend.getName() << ", "
+            << toOperationsPerSecond(nKeys, keygenTime) << ", "
+            << toOperationsPerSecond(nIterations, wrapTime) << ", "
+            << toOperationsPerSecond(nIterations, unwrapTime) << ", "
+            << toOperationsPerSecond(nIterations, encryptTime) << ", "
+            << toOperationsPerSecond(nIterations, decryptTime) << std::endl;
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t keySize = argc > 1 ? std::stoul(argv[1]) : 2048;
+  size_t nIterations = argc > 2 ? std::stoul(argv[2]) : 1000;
+  size_t payloadSize = argc > 3 ? std::stoul(argv[3]) : 1024;
+
+  RandomNumberGenerator rng;
+
+  std::cout << "backend, keygen (op/s), wrap (op/s), unwrap (op/s), "
+            << "AES-CBC encrypt (op/s), AES-CBC decrypt (op/s)" << std::endl;
+  for (const std::string& name : algo::CryptoBackend::getNames())
+    measure(algo::CryptoBackend::get(name), keySize, nIterations, payloadSize, rng);
+  return 0;
+}
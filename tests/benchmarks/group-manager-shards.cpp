@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark of sharded D-KEY generation: 1, 2, 4, ... group manager processes forked on
+ * the machine share one database, agree on the group key of a new interval and each
+ * creates the D-KEYs of its part of the members. The wall time of each round is compared
+ * with a single process.
+ *
+ * All members share one RSA public key, the D-KEY creation cost does not depend on it.
+ *
+ * Usage: group-manager-shards [members] [max shards] [key size in bits]
+ */
+
+#include "group-manager.hpp"
+#include "group-snapshot.hpp"
+#include "algo/rsa.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+/**
+ * @brief Create the D-KEYs of shard @p shardIndex of @p nShards at @p timeslot
+ *
+ * Runs in the forked process, writes the number of D-KEYs and the E-KEY to @p resultPath.
+ */
+static int
+runShard(const std::string& dbPath, size_t shardIndex, size_t nShards, int keySize,
+         const TimeStamp& timeslot, const std::string& resultPath)
+{
+  try {
+    GroupManager manager(Name("/prefix"), Name("data_type"), dbPath, keySize, 1);
+    manager.setShard(shardIndex, nShards);
+    std::list<Data> groupKey = manager.getGroupKey(timeslot);
+    if (groupKey.empty())
+      return 1;
+
+    const Block& eKey = groupKey.front().getContent();
+    std::ofstream os(resultPath, std::ios::binary | std::ios::trunc);
+    os << groupKey.size() - 1 << std::endl
+       << std::string(reinterpret_cast<const char*>(eKey.value()), eKey.value_size());
+    return os ? 0 : 1;
+  }
+  catch (const std::exception& e) {
+    std::cerr << "shard " << shardIndex << ": " << e.what() << std::endl;
+    return 1;
+  }
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t nMembers = argc > 1 ? std::stoul(argv[1]) : 2000;
+  size_t maxShards = argc > 2 ? std::stoul(argv[2]) : 8;
+  int keySize = argc > 3 ? std::stoi(argv[3]) : 2048;
+
+  boost::filesystem::path tmpPath(TMP_BENCHMARKS_PATH);
+  boost::filesystem::remove_all(tmpPath);
+  boost::filesystem::create_directories(tmpPath);
+  std::string snapshotPath = (tmpPath / "group.snapshot").string();
+  std::string dbPath = (tmpPath / "group.db").string();
+
+  RandomNumberGenerator rng;
+  RsaKeyParams params(keySize);
+  ndn::Buffer memberKey =
+    algo::Rsa::deriveEncryptKey(algo::Rsa::generateKey(rng, params).getKeyBits()).getKeyBits();
+  writeGroupSnapshot(snapshotPath, nMembers, 1,
+                     [&] (size_t) -> const ndn::Buffer& { return memberKey; });
+  GroupManagerDB(dbPath).importSnapshot(snapshotPath);
+
+  std::cout << "members: " << nMembers << ", key size: " << keySize << std::endl
+            << "shards, time (ms), speedup, D-KEYs" << std::endl;
+
+  double baseTime = 0;
+  int day = 0;
+  for (size_t nShards = 1; nShards <= maxShards; nShards *= 2, day++) {
+    // a new day is a new interval, so the shards agree on a new group key
+    TimeStamp timeslot = boost::posix_time::from_iso_string("20150101T003000") +
+                         boost::posix_time::hours(24 * day);
+
+    ndn::time::steady_clock::TimePoint start = ndn::time::steady_clock::now();
+    std::vector<pid_t> children;
+    for (size_t i = 0; i < nShards; i++) {
+      pid_t pid = fork();
+      if (pid == 0) {
+        std::string resultPath = (tmpPath / ("shard-" + std::to_string(i))).string();
+        _exit(runShard(dbPath, i, nShards, keySize, timeslot, resultPath));
+      }
+      children.push_back(pid);
+    }
+
+    bool hasFailed = false;
+    for (pid_t pid : children) {
+      int status = 0;
+      waitpid(pid, &status, 0);
+      hasFailed = hasFailed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    double duration = (ndn::time::steady_clock::now() - start).count() / 1000000.0;
+
+    // the shards must cover all members exactly once with one E-KEY
+    size_t nDKeys = 0;
+    std::string eKey;
+    for (size_t i = 0; i < nShards && !hasFailed; i++) {
+      std::ifstream is((tmpPath / ("shard-" + std::to_string(i))).string(), std::ios::binary);
+      size_t nShardDKeys = 0;
+      is >> nShardDKeys;
+      is.get();
+      std::string shardEKey((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+      nDKeys += nShardDKeys;
+      if (i == 0)
+        eKey = shardEKey;
+      hasFailed = shardEKey != eKey;
+    }
+    if (hasFailed || nDKeys != nMembers) {
+      std::cerr << "shards disagree or miss members with " << nShards << " shards" << std::endl;
+      return 1;
+    }
+
+    if (nShards == 1)
+      baseTime = duration;
+    std::cout << nShards << ", " << duration << ", " << baseTime / duration << ", "
+              << nDKeys << std::endl;
+  }
+
+  boost::filesystem::remove_all(tmpPath);
+  return 0;
+}
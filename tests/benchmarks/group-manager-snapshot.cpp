@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark of standing up a group manager database from a snapshot: a snapshot of a group
+ * with many members is imported, exported and imported again into a fresh database, and
+ * compared with replaying addMember for a part of the members. The import over the members
+ * of a previous snapshot is measured as well, together with the generation increase of
+ * each import.
+ *
+ * Usage: group-manager-snapshot [members] [schedules] [replayed members]
+ */
+
+#include "group-snapshot.hpp"
+#include "random-number-generator.hpp"
+
+#include <boost/filesystem.hpp>
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+// size of the DER encoding of a 2048-bit RSA public key
+static const size_t PUBLIC_KEY_SIZE = 294;
+
+static double
+toMilliseconds(const time::nanoseconds& duration)
+{
+  return duration.count() / 1000000.0;
+}
+
+template<typename F>
+static double
+measure(const F& f)
+{
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  f();
+  return toMilliseconds(time::steady_clock::now() - start);
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t nMembers = argc > 1 ? std::stoul(argv[1]) : 100000;
+  size_t nSchedules = argc > 2 ? std::stoul(argv[2]) : 10;
+  size_t nReplayed = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+  boost::filesystem::path tmpPath(TMP_BENCHMARKS_PATH);
+  boost::filesystem::remove_all(tmpPath);
+  boost::filesystem::create_directories(tmpPath);
+  std::string generatedPath = (tmpPath / "generated.snapshot").string();
+  std::string snapshotPath = (tmpPath / "exported.snapshot").string();
+
+  // random bytes stand for the public keys, which are not used
+  RandomNumberGenerator rng;
+  ndn::Buffer key(PUBLIC_KEY_SIZE);
+  writeGroupSnapshot(generatedPath, nMembers, nSchedules, [&] (size_t) -> const ndn::Buffer& {
+      rng.GenerateBlock(key.buf(), key.size());
+      return key;
+    });
+
+  {
+    GroupManagerDB source((tmpPath / "source.db").string());
+    double importTime = measure([&] { source.importSnapshot(generatedPath); });
+    double exportTime = measure([&] { source.exportSnapshot(snapshotPath); });
+
+    GroupManagerDB replica((tmpPath / "replica.db").string());
+    uint64_t generation = replica.getGeneration();
+    double replicaTime = measure([&] { replica.importSnapshot(snapshotPath); });
+    uint64_t importGenerations = replica.getGeneration() - generation;
+
+    // all the members are deleted and inserted again
+    generation = replica.getGeneration();
+    double reimportTime = measure([&] { replica.importSnapshot(snapshotPath); });
+    uint64_t reimportGenerations = replica.getGeneration() - generation;
+
+    // the members of all schedules are read when a group key is created
+    size_t nRead = 0;
+    double readTime = measure([&] {
+        for (const std::string& scheduleName : replica.listAllScheduleNames())
+          nRead += replica.getScheduleMembers(scheduleName).size();
+      });
+
+    // replay the calls a new group manager would make without snapshot
+    GroupManagerDB replayed((tmpPath / "replayed.db").string());
+    double replayTime = measure([&] {
+        for (size_t i = 0; i < nSchedules; i++)
+          replayed.addSchedule("schedule-" + std::to_string(i), makeDailySchedule(i));
+        for (size_t i = 0; i < nReplayed; i++)
+          replayed.addMember("schedule-" + std::to_string(i % nSchedules),
+                             makeMemberKeyName(i), key);
+      });
+
+    std::cout << "members: " << nMembers << ", schedules: " << nSchedules << std::endl
+              << "snapshot size: " << boost::filesystem::file_size(snapshotPath) << " bytes"
+              << std::endl
+              << "import: " << importTime << " ms" << std::endl
+              << "export: " << exportTime << " ms" << std::endl
+              << "import into replica: " << replicaTime << " ms, "
+              << "generation increase: " << importGenerations << std::endl
+              << "import over " << nMembers << " members: " << reimportTime << " ms, "
+              << "generation increase: " << reimportGenerations << std::endl
+              << "read " << nRead << " members of all schedules: " << readTime << " ms"
+              << std::endl
+              << "replay of " << nReplayed << " members: " << replayTime << " ms, "
+              << "extrapolated to all members: "
+              << replayTime / std::max<size_t>(nReplayed, 1) * nMembers << " ms" << std::endl;
+  }
+
+  boost::filesystem::remove_all(tmpPath);
+  return 0;
+}
@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_BENCHMARKS_GROUP_SNAPSHOT_HPP
+#define NDN_GEP_BENCHMARKS_GROUP_SNAPSHOT_HPP
+
+#include "group-manager-db.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <fstream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+/**
+ * @brief Make a schedule covering the hour from @p hour every day from 2015 to 2025
+ */
+inline Schedule
+makeDailySchedule(int hour)
+{
+  Schedule schedule;
+  schedule.addWhiteInterval(RepetitiveInterval(boost::posix_time::from_iso_string("20150101T000000"),
+                                               boost::posix_time::from_iso_string("20251231T000000"),
+                                               hour % 24, hour % 24 + 1, 1,
+                                               RepetitiveInterval::RepeatUnit::DAY));
+  return schedule;
+}
+
+inline Name
+makeMemberKeyName(size_t member)
+{
+  return Name("/ndn/member").appendNumber(member).append("ksk-123");
+}
+
+/**
+ * @brief Write a snapshot of @p nMembers members spread over @p nSchedules daily schedules
+ *
+ * The public key of each member is returned by @p getKey. The snapshot is written directly
+ * in the format of GroupManagerDB::exportSnapshot, as populating a database of that size
+ * through addMember would dominate the benchmarks.
+ */
+inline void
+writeGroupSnapshot(const std::string& path, size_t nMembers, size_t nSchedules,
+                   const function<const Buffer& (size_t member)>& getKey)
+{
+  std::ofstream os(path, std::ios::binary | std::ios::trunc);
+  os.write("GEPS", 4);
+  os.put(static_cast<char>(GroupManagerDB::SNAPSHOT_VERSION));
+
+  for (size_t i = 0; i < nSchedules; i++) {
+    Block entry(tlv::SnapshotSchedule);
+    entry.push_back(makeStringBlock(tlv::ScheduleName, "schedule-" + std::to_string(i)));
+    entry.push_back(makeDailySchedule(i).wireEncode());
+    entry.encode();
+    os.write(reinterpret_cast<const char*>(entry.wire()), entry.size());
+  }
+
+  for (size_t i = 0; i < nMembers; i++) {
+    const Buffer& key = getKey(i);
+    Block entry(tlv::SnapshotMember);
+    entry.push_back(makeNonNegativeIntegerBlock(tlv::ScheduleIndex, i % nSchedules));
+    entry.push_back(makeMemberKeyName(i).wireEncode());
+    entry.push_back(makeBinaryBlock(tlv::MemberKey, key.buf(), key.size()));
+    entry.encode();
+    os.write(reinterpret_cast<const char*>(entry.wire()), entry.size());
+  }
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_BENCHMARKS_GROUP_SNAPSHOT_HPP
@@ -0,0 +1,407 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Simulation of key distribution at scale in virtual time: one group manager, many
+ * producers and many consumers (a subset of the members) connected through an in-memory
+ * forwarder with delay and loss.
+ *
+ * Every hour, the group manager publishes the group key of the hour ahead of the
+ * boundary, each producer creates the C-KEY and one content packet of the new hour at
+ * the boundary, and each consumer retrieves the content of one producer at a random
+ * time shortly after the boundary. The key generation CPU time, the packet counts,
+ * the peak memory and the latencies of the consumptions are reported per hour as JSON.
+ *
+ * Members share the RSA key pairs of a small pool, so that the setup does not generate
+ * one key pair per member; the D-KEYs are still encrypted for each member.
+ *
+ * Usage: key-distribution-simulation [--members=N] [--producers=N] [--consumers=N]
+ *          [--hours=N] [--delay-ms=N] [--loss=RATE] [--key-pool=N] [--key-size=BITS]
+ *          [--content-size=N] [--jitter-s=N] [--tick-ms=N] [--seed=N]
+ */
+
+#include "virtual-network.hpp"
+#include "consumer.hpp"
+#include "group-manager.hpp"
+#include "producer.hpp"
+#include "schedule.hpp"
+#include "algo/rsa.hpp"
+
+#include <ndn-cxx/security/identity-certificate.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+struct Config
+{
+  size_t nMembers = 10000;
+  size_t nProducers = 500;
+  size_t nConsumers = 5000;
+  size_t nHours = 24;
+  size_t delayMs = 20;
+  double lossRate = 0.01;
+  size_t keyPoolSize = 16;
+  size_t keySize = 2048;
+  size_t contentSize = 1024;
+  size_t jitterS = 60;
+  size_t tickMs = 10;
+  uint32_t seed = 1;
+};
+
+struct HourStats
+{
+  double groupManagerCpuMs = 0;
+  double producerCpuMs = 0;
+  double totalCpuMs = 0;
+  size_t nGroupKeyPackets = 0;
+  size_t nConsumed = 0;
+  size_t nFailed = 0;
+  std::vector<double> latenciesMs;
+  VirtualNetwork::Counters counters;
+};
+
+static Config
+parseConfig(int argc, char** argv)
+{
+  Config config;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t pos = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || pos == std::string::npos) {
+      std::cerr << "invalid argument: " << arg << std::endl;
+      std::exit(2);
+    }
+    std::string key = arg.substr(2, pos - 2);
+    std::string value = arg.substr(pos + 1);
+    if (key == "members") config.nMembers = std::stoul(value);
+    else if (key == "producers") config.nProducers = std::stoul(value);
+    else if (key == "consumers") config.nConsumers = std::stoul(value);
+    else if (key == "hours") config.nHours = std::stoul(value);
+    else if (key == "delay-ms") config.delayMs = std::stoul(value);
+    else if (key == "loss") config.lossRate = std::stod(value);
+    else if (key == "key-pool") config.keyPoolSize = std::stoul(value);
+    else if (key == "key-size") config.keySize = std::stoul(value);
+    else if (key == "content-size") config.contentSize = std::stoul(value);
+    else if (key == "jitter-s") config.jitterS = std::stoul(value);
+    else if (key == "tick-ms") config.tickMs = std::stoul(value);
+    else if (key == "seed") config.seed = std::stoul(value);
+    else {
+      std::cerr << "unknown option: " << key << std::endl;
+      std::exit(2);
+    }
+  }
+  config.nConsumers = std::min(config.nConsumers, config.nMembers);
+  return config;
+}
+
+static double
+getCpuMs()
+{
+  return std::clock() * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static long
+getPeakRssKb()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static double
+getPercentile(std::vector<double>& values, double percentile)
+{
+  if (values.empty())
+    return 0;
+  size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+class Simulation
+{
+public:
+  explicit
+  Simulation(const Config& config)
+    : m_config(config)
+    , m_steadyClock(make_shared<time::UnitTestSteadyClock>())
+    , m_systemClock(make_shared<time::UnitTestSystemClock>())
+    , m_network(m_io, time::milliseconds(config.delayMs), config.lossRate, config.seed)
+    , m_scheduler(m_io)
+    , m_rng(config.seed)
+    , m_start(time::fromIsoString("20150825T000000"))
+  {
+    time::setCustomClocks(m_steadyClock, m_systemClock);
+    m_systemClock->setNow(time::toUnixTimestamp(m_start - time::minutes(10)));
+  }
+
+  ~Simulation()
+  {
+    time::setCustomClocks(nullptr, nullptr);
+  }
+
+  void
+  setUp()
+  {
+    // membership changes every 6 hours: consumers are always members, the other members
+    // are in one of four shifts
+    m_manager.reset(new GroupManager(Name("/Prefix"), Name("/a"), ":memory:",
+                                     m_config.keySize, 1, m_keyChain));
+    boost::posix_time::ptime from = boost::posix_time::from_iso_string("20150825T000000");
+    boost::posix_time::ptime to = from + boost::posix_time::hours(24 * (m_config.nHours / 24 + 2));
+    Schedule always;
+    always.addWhiteInterval(RepetitiveInterval(from, to, 0, 24, 1,
+                                               RepetitiveInterval::RepeatUnit::DAY));
+    m_manager->addSchedule("always", always);
+    for (int shift = 0; shift < 4; shift++) {
+      Schedule schedule;
+      schedule.addWhiteInterval(RepetitiveInterval(from, to, shift * 6, shift * 6 + 6, 1,
+                                                   RepetitiveInterval::RepeatUnit::DAY));
+      m_manager->addSchedule("shift-" + std::to_string(shift), schedule);
+    }
+
+    RandomNumberGenerator rng;
+    RsaKeyParams keyParams(m_config.keySize);
+    for (size_t i = 0; i < m_config.keyPoolSize; i++) {
+      Buffer dKey = algo::Rsa::generateKey(rng, keyParams).getKeyBits();
+      m_keyPool.push_back({dKey, algo::Rsa::deriveEncryptKey(dKey).getKeyBits()});
+    }
+
+    for (size_t i = 0; i < m_config.nMembers; i++) {
+      const Buffer& eKey = m_keyPool[i % m_keyPool.size()].second;
+      IdentityCertificate cert;
+      cert.setName(Name(getMemberName(i)).append("KEY").append("ksk-1")
+                     .append("ID-CERT").append("1"));
+      cert.setPublicKeyInfo(PublicKey(eKey.buf(), eKey.size()));
+      cert.encode();
+      m_keyChain.signWithSha256(cert);
+      m_manager->addMember(i < m_config.nConsumers ? "always" : "shift-" + std::to_string(i % 4),
+                           cert);
+    }
+
+    m_network.addRoute(Name("/Prefix/READ/a/E-KEY"));
+    m_network.addRoute(Name("/Prefix/READ/a/D-KEY"));
+
+    for (size_t i = 0; i < m_config.nProducers; i++) {
+      Name dataType("/a");
+      dataType.append("p" + std::to_string(i));
+      m_network.addRoute(Name("/Prefix/SAMPLE").append(dataType));
+      m_producers.emplace_back(new Producer(Name("/Prefix"), dataType, *m_network.addFace(),
+                                            ":memory:", m_keyChain));
+      // the pacing waits in real time, which the simulation does not need
+      m_producers.back()->setInterestPacing(time::milliseconds::zero());
+    }
+
+    for (size_t i = 0; i < m_config.nConsumers; i++) {
+      unique_ptr<Consumer> consumer(new Consumer(*m_network.addFace(), Name("/Prefix/READ"),
+                                                 getMemberName(i), ":memory:"));
+      consumer->setInterestPacing(time::milliseconds::zero());
+      consumer->addDecryptionKey(Name(getMemberName(i)).append("ksk-1"),
+                                 m_keyPool[i % m_keyPool.size()].first);
+      m_consumers.push_back(std::move(consumer));
+    }
+  }
+
+  void
+  run()
+  {
+    m_hours.resize(m_config.nHours);
+    for (size_t hour = 0; hour < m_config.nHours; hour++) {
+      HourStats& stats = m_hours[hour];
+      VirtualNetwork::Counters countersBefore = m_network.getCounters();
+      double cpuBefore = getCpuMs();
+      time::system_clock::TimePoint boundary = m_start + time::hours(hour);
+
+      // the group manager publishes the group key 10 minutes ahead of the boundary
+      double start = getCpuMs();
+      std::list<Data> groupKeys = m_manager->getGroupKey(
+        boost::posix_time::from_iso_string(time::toIsoString(boundary)));
+      stats.groupManagerCpuMs = getCpuMs() - start;
+      stats.nGroupKeyPackets = groupKeys.size();
+      for (const auto& data : groupKeys)
+        m_network.publish(data);
+
+      advanceTo(boundary, time::seconds(1));
+
+      // producers create the C-KEY and the content of the new hour at the boundary
+      start = getCpuMs();
+      Buffer content(m_config.contentSize);
+      for (auto& producer : m_producers) {
+        producer->createContentKey(boundary,
+                                   [this] (const std::vector<Data>& cKeys) {
+                                     for (const auto& cKey : cKeys)
+                                       m_network.publish(cKey);
+                                   });
+        Data data;
+        producer->produce(data, boundary, content.buf(), content.size());
+        m_network.publish(data);
+      }
+      stats.producerCpuMs = getCpuMs() - start;
+
+      // consumers retrieve the content of one producer within the jitter after the boundary
+      std::uniform_int_distribution<uint64_t> jitter(0, m_config.jitterS * 1000);
+      for (size_t i = 0; i < m_consumers.size(); i++) {
+        Name contentName = Name("/Prefix/SAMPLE/a")
+          .append("p" + std::to_string(i % m_producers.size()))
+          .append(time::toIsoString(boundary));
+        m_scheduler.scheduleEvent(time::milliseconds(jitter(m_rng)),
+                                  [this, i, contentName, &stats] {
+                                    consume(*m_consumers[i], contentName, stats);
+                                  });
+      }
+
+      // fine ticks while consumptions are in progress, then coarse ones up to the next
+      // publication of the group manager
+      advanceTo(boundary + time::seconds(m_config.jitterS) + time::minutes(2),
+                time::milliseconds(m_config.tickMs));
+      advanceTo(boundary + time::minutes(50), time::seconds(1));
+      m_network.purge(time::hours(2));
+
+      stats.totalCpuMs = getCpuMs() - cpuBefore;
+      const VirtualNetwork::Counters& counters = m_network.getCounters();
+      stats.counters.nInterests = counters.nInterests - countersBefore.nInterests;
+      stats.counters.nData = counters.nData - countersBefore.nData;
+      stats.counters.nNacks = counters.nNacks - countersBefore.nNacks;
+      stats.counters.nLost = counters.nLost - countersBefore.nLost;
+      stats.counters.nCsHits = counters.nCsHits - countersBefore.nCsHits;
+      stats.counters.nPublished = counters.nPublished - countersBefore.nPublished;
+    }
+  }
+
+  void
+  report(std::ostream& os)
+  {
+    os << "{\n  \"config\": {"
+       << "\"members\": " << m_config.nMembers
+       << ", \"producers\": " << m_config.nProducers
+       << ", \"consumers\": " << m_config.nConsumers
+       << ", \"hours\": " << m_config.nHours
+       << ", \"delayMs\": " << m_config.delayMs
+       << ", \"loss\": " << m_config.lossRate
+       << ", \"keyPool\": " << m_config.keyPoolSize
+       << ", \"keySize\": " << m_config.keySize
+       << ", \"contentSize\": " << m_config.contentSize
+       << ", \"jitterS\": " << m_config.jitterS
+       << ", \"tickMs\": " << m_config.tickMs
+       << ", \"seed\": " << m_config.seed << "},\n"
+       << "  \"peakRssKb\": " << getPeakRssKb() << ",\n"
+       << "  \"hours\": [\n";
+
+    for (size_t hour = 0; hour < m_hours.size(); hour++) {
+      HourStats& stats = m_hours[hour];
+      os << "    {\"hour\": " << hour
+         << ", \"groupManagerCpuMs\": " << stats.groupManagerCpuMs
+         << ", \"producerCpuMs\": " << stats.producerCpuMs
+         << ", \"totalCpuMs\": " << stats.totalCpuMs
+         << ", \"groupKeyPackets\": " << stats.nGroupKeyPackets
+         << ", \"consumed\": " << stats.nConsumed
+         << ", \"failed\": " << stats.nFailed
+         << ", \"latencyMs\": {"
+         << "\"p50\": " << getPercentile(stats.latenciesMs, 0.5)
+         << ", \"p90\": " << getPercentile(stats.latenciesMs, 0.9)
+         << ", \"p99\": " << getPercentile(stats.latenciesMs, 0.99)
+         << ", \"max\": " << getPercentile(stats.latenciesMs, 1.0) << "}"
+         << ", \"packets\": {"
+         << "\"interests\": " << stats.counters.nInterests
+         << ", \"data\": " << stats.counters.nData
+         << ", \"nacks\": " << stats.counters.nNacks
+         << ", \"lost\": " << stats.counters.nLost
+         << ", \"csHits\": " << stats.counters.nCsHits
+         << ", \"published\": " << stats.counters.nPublished << "}}"
+         << (hour + 1 < m_hours.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}" << std::endl;
+  }
+
+private:
+  static Name
+  getMemberName(size_t i)
+  {
+    return Name("/ndn").append("member" + std::to_string(i));
+  }
+
+  void
+  consume(Consumer& consumer, const Name& contentName, HourStats& stats)
+  {
+    time::steady_clock::TimePoint start = time::steady_clock::now();
+    consumer.consume(contentName,
+                     [start, &stats] (const Data&, const Buffer&) {
+                       stats.nConsumed++;
+                       time::nanoseconds latency = time::steady_clock::now() - start;
+                       stats.latenciesMs.push_back(latency.count() / 1e6);
+                     },
+                     [&stats] (const ErrorCode&, const std::string&) {
+                       stats.nFailed++;
+                     });
+  }
+
+  void
+  advanceTo(const time::system_clock::TimePoint& until, const time::nanoseconds& tick)
+  {
+    while (time::system_clock::now() < until) {
+      m_steadyClock->advance(tick);
+      m_systemClock->advance(tick);
+      if (m_io.stopped())
+        m_io.reset();
+      m_io.poll();
+    }
+  }
+
+private:
+  Config m_config;
+  shared_ptr<time::UnitTestSteadyClock> m_steadyClock;
+  shared_ptr<time::UnitTestSystemClock> m_systemClock;
+  boost::asio::io_service m_io;
+  VirtualNetwork m_network;
+  util::scheduler::Scheduler m_scheduler;
+  std::mt19937 m_rng;
+  time::system_clock::TimePoint m_start;
+
+  KeyChain m_keyChain;
+  std::vector<std::pair<Buffer, Buffer>> m_keyPool;
+  unique_ptr<GroupManager> m_manager;
+  std::vector<unique_ptr<Producer>> m_producers;
+  std::vector<unique_ptr<Consumer>> m_consumers;
+  std::vector<HourStats> m_hours;
+};
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep::benchmarks;
+
+  Config config = parseConfig(argc, argv);
+  Simulation simulation(config);
+  simulation.setUp();
+  simulation.run();
+  simulation.report(std::cout);
+  return 0;
+}
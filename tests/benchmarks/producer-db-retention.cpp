@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark of the content key retention of ProducerDB over a simulated year of hourly
+ * content keys: database file size and content key lookup latency, without retention and
+ * with the keys of the last 30 days pruned daily.
+ *
+ * Usage: producer-db-retention [lookups per sample]
+ */
+
+#include "producer-db.hpp"
+#include "algo/aes.hpp"
+
+#include <boost/filesystem.hpp>
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+using time::system_clock;
+
+static double
+measureLookup(ProducerDB& db, const system_clock::TimePoint& now, size_t nLookups,
+              RandomNumberGenerator& rng)
+{
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  for (size_t i = 0; i < nLookups; i++) {
+    // look up one of the last 30 days, which are kept in both databases
+    system_clock::TimePoint timeslot = now - time::hours(1 + rng.GenerateWord32(0, 30 * 24 - 1));
+    db.getContentKey(timeslot);
+  }
+  time::nanoseconds duration = time::steady_clock::now() - start;
+  return duration.count() / 1000.0 / nLookups;
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t nLookups = argc > 1 ? std::stoul(argv[1]) : 1000;
+
+  boost::filesystem::path tmpPath(TMP_BENCHMARKS_PATH);
+  boost::filesystem::remove_all(tmpPath);
+  boost::filesystem::create_directories(tmpPath);
+  std::string keepAllPath = (tmpPath / "keep-all.db").string();
+  std::string retentionPath = (tmpPath / "retention.db").string();
+
+  RandomNumberGenerator rng;
+  AesKeyParams aesParams;
+  ndn::Buffer key = algo::Aes::generateKey(rng, aesParams).getKeyBits();
+
+  {
+    ProducerDB keepAll(keepAllPath);
+    ProducerDB retention(retentionPath);
+
+    std::cout << "day, keys (keep all), size (keep all), lookup (keep all, us), "
+              << "keys (retention), size (retention), lookup (retention, us)" << std::endl;
+
+    system_clock::TimePoint begin = ndn::time::fromIsoString("20150101T000000");
+    for (int hour = 0; hour < 365 * 24; hour++) {
+      system_clock::TimePoint now = begin + ndn::time::hours(hour);
+      keepAll.addContentKey(now, key);
+      retention.addContentKey(now, key);
+
+      if (hour % 24 != 23)
+        continue;
+
+      // daily pruning round, in batches as Producer does
+      while (retention.deleteContentKeysBefore(now - ndn::time::hours(30 * 24), 1000) == 1000)
+        ;
+      retention.compact();
+
+      int day = hour / 24 + 1;
+      if (day < 30 || day % 30 != 0)
+        continue;
+
+      std::cout << day << ", "
+                << keepAll.getContentKeyCount() << ", "
+                << boost::filesystem::file_size(keepAllPath) << ", "
+                << measureLookup(keepAll, now, nLookups, rng) << ", "
+                << retention.getContentKeyCount() << ", "
+                << boost::filesystem::file_size(retentionPath) << ", "
+                << measureLookup(retention, now, nLookups, rng) << std::endl;
+    }
+  }
+
+  boost::filesystem::remove_all(tmpPath);
+  return 0;
+}
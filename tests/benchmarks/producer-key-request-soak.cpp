@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Soak benchmark of the key requests of a producer: content keys are produced for many
+ * consecutive hours, some of them with E-KEYs which are never answered, and the number of
+ * outstanding key requests and the resident memory are reported as the soak goes on.
+ * Both are expected to stay flat.
+ *
+ * Usage: producer-key-request-soak [hours] [report interval in hours]
+ */
+
+#include "producer.hpp"
+#include "algo/rsa.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+/**
+ * @brief Get the resident memory of this process in KiB, 0 if unknown
+ */
+static size_t
+getResidentMemory()
+{
+  std::ifstream statm("/proc/self/statm");
+  size_t nPages = 0;
+  size_t nResidentPages = 0;
+  if (!(statm >> nPages >> nResidentPages))
+    return 0;
+  return nResidentPages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn;
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t nHours = argc > 1 ? std::stoul(argv[1]) : 1000;
+  size_t reportInterval = argc > 2 ? std::stoul(argv[2]) : 100;
+
+  boost::filesystem::path tmpPath(TMP_BENCHMARKS_PATH);
+  boost::filesystem::remove_all(tmpPath);
+  boost::filesystem::create_directories(tmpPath);
+  std::string dbPath = (tmpPath / "producer.db").string();
+
+  // /prefix/READ/a/E-KEY always covers the content key, /prefix/READ/a/b/E-KEY never answers
+  Name prefix("/prefix");
+  Name dataType("/a/b");
+  RandomNumberGenerator rng;
+  RsaKeyParams params(2048);
+  Buffer eKey =
+    algo::Rsa::deriveEncryptKey(algo::Rsa::generateKey(rng, params).getKeyBits()).getKeyBits();
+  ProducerDB(dbPath).addEKey(Name(prefix).append(NAME_COMPONENT_READ).append("a")
+                                         .append(NAME_COMPONENT_E_KEY),
+                             time::fromIsoString("20000101T000000"),
+                             time::fromIsoString("30000101T000000"), eKey);
+
+  boost::asio::io_service io;
+  auto face = util::makeDummyClientFace(io);
+  Producer producer(prefix, dataType, *face, dbPath);
+  producer.setKeyRequestDeadline(time::milliseconds(1));
+  producer.setContentKeyRetention(time::hours(24));
+
+  std::cout << "hours, outstanding requests, completed, expired, resident memory (KiB)"
+            << std::endl;
+  time::system_clock::TimePoint hour = time::fromIsoString("20150101T000000");
+  const uint8_t content[] = {0x01, 0x02, 0x03, 0x04};
+  for (size_t i = 1; i <= nHours; i++, hour += time::hours(1)) {
+    Data data;
+    producer.produce(data, hour, content, sizeof(content));
+    face->sentInterests.clear();
+    io.poll();
+    io.reset();
+
+    if (i % reportInterval == 0) {
+      const Producer::KeyRequestMetrics& metrics = producer.getKeyRequestMetrics();
+      std::cout << i << ", " << metrics.nOutstanding << ", " << metrics.nCompleted << ", "
+                << metrics.nExpired << ", " << getResidentMemory() << std::endl;
+    }
+  }
+
+  boost::filesystem::remove_all(tmpPath);
+  return 0;
+}
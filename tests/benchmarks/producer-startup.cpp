@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark of the time and file descriptors needed to create N producers, each with its
+ * own KeyChain or all sharing one KeyChain.
+ *
+ * Usage: producer-startup [N]
+ */
+
+#include "producer.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+static size_t
+countOpenFiles()
+{
+  boost::filesystem::path fdDir("/proc/self/fd");
+  if (!boost::filesystem::exists(fdDir))
+    return 0;
+
+  return std::distance(boost::filesystem::directory_iterator(fdDir),
+                       boost::filesystem::directory_iterator());
+}
+
+static void
+createProducers(const std::string& mode, size_t nProducers, Face& face, KeyChain* sharedKeyChain)
+{
+  boost::filesystem::path tmpPath = boost::filesystem::path(TMP_BENCHMARKS_PATH) / mode;
+  boost::filesystem::create_directories(tmpPath);
+
+  size_t nFilesBefore = countOpenFiles();
+  std::vector<unique_ptr<Producer>> producers;
+  producers.reserve(nProducers);
+
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  for (size_t i = 0; i < nProducers; i++) {
+    Name dataType("/data_type");
+    dataType.appendNumber(i);
+    std::string dbPath = (tmpPath / ("producer-" + std::to_string(i) + ".db")).string();
+
+    if (sharedKeyChain == nullptr)
+      producers.emplace_back(new Producer(Name("/prefix"), dataType, face, dbPath));
+    else
+      producers.emplace_back(new Producer(Name("/prefix"), dataType, face, dbPath,
+                                          *sharedKeyChain));
+  }
+  time::nanoseconds elapsed = time::steady_clock::now() - start;
+
+  std::cout << mode << ", " << nProducers << ", "
+            << time::duration_cast<time::microseconds>(elapsed).count() / 1000.0 << ", "
+            << countOpenFiles() - nFilesBefore << std::endl;
+
+  producers.clear();
+  boost::filesystem::remove_all(tmpPath);
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep::benchmarks;
+
+  size_t nProducers = argc > 1 ? std::stoul(argv[1]) : 100;
+
+  boost::asio::io_service io;
+  auto face = ndn::util::makeDummyClientFace(io);
+
+  std::cout << "KeyChain, producers, startup time (ms), additional open files" << std::endl;
+  createProducers("own", nProducers, *face, nullptr);
+
+  ndn::KeyChain keyChain;
+  createProducers("shared", nProducers, *face, &keyChain);
+  return 0;
+}
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Benchmark of creating the content keys of consecutive hours for a data type of depth D,
+ * with the E-KEYs of all the D nodes cached, wrapping the content key in place or on a
+ * worker pool.
+ *
+ * Usage: producer-wrap [max depth] [hours] [threads]
+ */
+
+#include "producer.hpp"
+#include "algo/rsa.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+/**
+ * @brief Create the content keys of @p nHours hours with @p workerPool, nullptr for none
+ *
+ * @return The time in milliseconds until all the encrypted content keys are handed back
+ */
+static double
+createContentKeys(size_t depth, size_t nHours, const Buffer& eKey,
+                  const shared_ptr<WorkerPool>& workerPool)
+{
+  boost::filesystem::path tmpPath(TMP_BENCHMARKS_PATH);
+  boost::filesystem::create_directories(tmpPath);
+  std::string dbPath = (tmpPath / "producer-wrap.db").string();
+  boost::filesystem::remove(dbPath);
+
+  Name prefix("/prefix");
+  Name dataType;
+  for (size_t i = 0; i < depth; i++)
+    dataType.append("node" + std::to_string(i));
+
+  {
+    // cache an E-KEY covering all the hours for every node
+    ProducerDB db(dbPath);
+    Name type = dataType;
+    while (!type.empty()) {
+      Name nodeName = prefix;
+      nodeName.append(NAME_COMPONENT_READ).append(type).append(NAME_COMPONENT_E_KEY);
+      db.addEKey(nodeName, time::fromIsoString("20150101T000000"),
+                 time::fromIsoString("20160101T000000"), eKey);
+      type = type.getPrefix(-1);
+    }
+  }
+
+  boost::asio::io_service io;
+  auto face = util::makeDummyClientFace(io);
+  Producer producer(prefix, dataType, *face, dbPath);
+  producer.setWorkerPool(workerPool);
+
+  size_t nKeys = 0;
+  time::system_clock::TimePoint hour = time::fromIsoString("20150101T000000");
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  for (size_t i = 0; i < nHours; i++, hour += time::hours(1))
+    producer.createContentKey(hour, [&] (const std::vector<Data>& keys) { nKeys += keys.size(); });
+  io.run();
+  time::nanoseconds elapsed = time::steady_clock::now() - start;
+
+  if (nKeys != nHours * dataType.size())
+    std::cerr << "missing content keys at depth " << depth << std::endl;
+  return elapsed.count() / 1000000.0;
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t maxDepth = argc > 1 ? std::stoul(argv[1]) : 16;
+  size_t nHours = argc > 2 ? std::stoul(argv[2]) : 10;
+  size_t nThreads = argc > 3 ? std::stoul(argv[3]) : 0;
+
+  RandomNumberGenerator rng;
+  RsaKeyParams params(2048);
+  ndn::Buffer eKey =
+    algo::Rsa::deriveEncryptKey(algo::Rsa::generateKey(rng, params).getKeyBits()).getKeyBits();
+  auto workerPool = ndn::make_shared<WorkerPool>(nThreads);
+
+  std::cout << "threads: " << workerPool->size() << std::endl
+            << "depth, in place (ms), worker pool (ms), speedup" << std::endl;
+  for (size_t depth = 1; depth <= maxDepth; depth *= 2) {
+    double serialTime = createContentKeys(depth, nHours, eKey, nullptr);
+    double poolTime = createContentKeys(depth, nHours, eKey, workerPool);
+    std::cout << depth << ", " << serialTime << ", " << poolTime << ", "
+              << serialTime / poolTime << std::endl;
+  }
+
+  boost::filesystem::remove_all(TMP_BENCHMARKS_PATH);
+  return 0;
+}
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Benchmark of the timestamp components in key and data names: encoding and decoding
+ * time of ISO string and binary timestamp components, and the size of an E-KEY name.
+ *
+ * Usage: timestamp-names [iterations]
+ */
+
+#include "timestamp-name.hpp"
+
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+static void
+measure(const std::string& label, TimestampNaming naming, size_t nIterations)
+{
+  time::system_clock::TimePoint hour = time::fromIsoString("20150101T000000");
+
+  std::vector<name::Component> components;
+  components.reserve(nIterations);
+  time::steady_clock::TimePoint start = time::steady_clock::now();
+  for (size_t i = 0; i < nIterations; i++)
+    components.push_back(encodeTimestamp(hour + time::hours(i), naming));
+  time::nanoseconds encodeTime = time::steady_clock::now() - start;
+
+  size_t nMismatches = 0;
+  start = time::steady_clock::now();
+  for (size_t i = 0; i < nIterations; i++) {
+    if (decodeTimestamp(components[i]) != hour + time::hours(i))
+      nMismatches++;
+  }
+  time::nanoseconds decodeTime = time::steady_clock::now() - start;
+
+  Name eKeyName("/prefix/READ/data_type/E-KEY");
+  eKeyName.append(components[0]).append(components[1]);
+
+  std::cout << label << ", "
+            << encodeTime.count() / nIterations << ", "
+            << decodeTime.count() / nIterations << ", "
+            << eKeyName.wireEncode().size() << ", "
+            << nMismatches << std::endl;
+}
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep;
+  using namespace ndn::gep::benchmarks;
+
+  size_t nIterations = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+  std::cout << "naming, encode (ns), decode (ns), E-KEY name size (bytes), mismatches"
+            << std::endl;
+  measure("iso", TimestampNaming::Iso, nIterations);
+  measure("binary", TimestampNaming::Binary, nIterations);
+  return 0;
+}
@@ -0,0 +1,438 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Replay of a workload trace recorded by TraceRecorder against DummyClientFaces connected
+ * through the virtual network, in virtual time.
+ *
+ * A producer is created for each namespace of the Produce records, a consumer for each
+ * consumer of the Consume records, and a group manager for each namespace of the
+ * GroupKey records. A producer whose namespace no recorded group manager covers gets a
+ * group manager of its own, which publishes the group key of each hour in which content
+ * is produced. All consumers are members of all group managers. The content is zeros of
+ * the recorded size.
+ *
+ * The calls are replayed at the recorded pace, or faster with --speed. The outcome of the
+ * recorded and the replayed consumptions, the CPU time and the latencies are reported as
+ * JSON.
+ *
+ * Usage: trace-replay <trace> [--speed=FACTOR] [--delay-ms=N] [--loss=RATE]
+ *          [--key-size=BITS] [--tick-ms=N]
+ */
+
+#include "virtual-network.hpp"
+#include "consumer.hpp"
+#include "group-manager.hpp"
+#include "producer.hpp"
+#include "schedule.hpp"
+#include "trace-recorder.hpp"
+#include "algo/rsa.hpp"
+
+#include <ndn-cxx/security/identity-certificate.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+struct Options
+{
+  std::string tracePath;
+  double speed = 1;
+  size_t delayMs = 20;
+  double lossRate = 0;
+  size_t keySize = 2048;
+  size_t tickMs = 10;
+};
+
+static Options
+parseOptions(int argc, char** argv)
+{
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t pos = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0) {
+      options.tracePath = arg;
+      continue;
+    }
+    if (pos == std::string::npos) {
+      std::cerr << "invalid argument: " << arg << std::endl;
+      std::exit(2);
+    }
+    std::string key = arg.substr(2, pos - 2);
+    std::string value = arg.substr(pos + 1);
+    if (key == "speed") options.speed = std::stod(value);
+    else if (key == "delay-ms") options.delayMs = std::stoul(value);
+    else if (key == "loss") options.lossRate = std::stod(value);
+    else if (key == "key-size") options.keySize = std::stoul(value);
+    else if (key == "tick-ms") options.tickMs = std::stoul(value);
+    else {
+      std::cerr << "unknown option: " << key << std::endl;
+      std::exit(2);
+    }
+  }
+  if (options.tracePath.empty() || options.speed <= 0) {
+    std::cerr << "Usage: trace-replay <trace> [--speed=FACTOR] [--delay-ms=N] [--loss=RATE]"
+              << " [--key-size=BITS] [--tick-ms=N]" << std::endl;
+    std::exit(2);
+  }
+  return options;
+}
+
+/**
+ * @brief Split @p name at the component @p marker into the prefix and the data type
+ * @return false if @p name has no @p marker
+ */
+static bool
+splitNamespace(const Name& name, const name::Component& marker, Name& prefix, Name& dataType)
+{
+  for (size_t i = 0; i < name.size(); i++) {
+    if (name.get(i) == marker) {
+      prefix = name.getPrefix(i);
+      dataType = name.getSubName(i + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+static double
+getPercentile(std::vector<double>& values, double percentile)
+{
+  if (values.empty())
+    return 0;
+  size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+class Replay
+{
+public:
+  explicit
+  Replay(const Options& options)
+    : m_options(options)
+    , m_steadyClock(make_shared<time::UnitTestSteadyClock>())
+    , m_systemClock(make_shared<time::UnitTestSystemClock>())
+    , m_network(m_io, time::milliseconds(options.delayMs), options.lossRate)
+  {
+    time::setCustomClocks(m_steadyClock, m_systemClock);
+
+    TraceReader reader(options.tracePath);
+    m_traceStart = reader.getStartTime();
+    TraceRecord record;
+    while (reader.read(record))
+      m_records.push_back(record);
+  }
+
+  ~Replay()
+  {
+    time::setCustomClocks(nullptr, nullptr);
+  }
+
+  void
+  setUp()
+  {
+    m_systemClock->setNow(time::toUnixTimestamp(m_traceStart));
+
+    std::set<Name> consumerNames;
+    std::set<Name> groupNamespaces;
+    std::set<Name> producerNamespaces;
+    for (const auto& record : m_records) {
+      m_nRecorded[record.type]++;
+      if (record.type == trace::Consume)
+        consumerNames.insert(record.actor);
+      else if (record.type == trace::GroupKey)
+        groupNamespaces.insert(record.name);
+      else if (record.type == trace::Produce)
+        producerNamespaces.insert(record.name);
+    }
+
+    // producers without a recorded group manager get one of their own
+    for (const auto& ns : producerNamespaces) {
+      Name prefix, dataType;
+      if (!splitNamespace(ns, NAME_COMPONENT_SAMPLE, prefix, dataType))
+        continue;
+      Name groupNamespace = Name(prefix).append(NAME_COMPONENT_READ).append(dataType);
+      if (groupNamespaces.count(groupNamespace) == 0) {
+        groupNamespaces.insert(groupNamespace);
+        m_synthesizedManagers.insert(ns);
+      }
+    }
+
+    RandomNumberGenerator rng;
+    RsaKeyParams keyParams(m_options.keySize);
+    Schedule always;
+    boost::posix_time::ptime from = boost::posix_time::from_iso_string("19700101T000000");
+    boost::posix_time::ptime to = boost::posix_time::from_iso_string("21000101T000000");
+    always.addWhiteInterval(RepetitiveInterval(from, to, 0, 24, 1,
+                                               RepetitiveInterval::RepeatUnit::DAY));
+
+    for (const auto& ns : groupNamespaces) {
+      Name prefix, dataType;
+      if (!splitNamespace(ns, NAME_COMPONENT_READ, prefix, dataType))
+        continue;
+      unique_ptr<GroupManager> manager(new GroupManager(prefix, dataType, ":memory:",
+                                                        m_options.keySize, 1, m_keyChain));
+      manager->addSchedule("always", always);
+      m_network.addRoute(Name(ns).append(NAME_COMPONENT_E_KEY));
+      m_network.addRoute(Name(ns).append(NAME_COMPONENT_D_KEY));
+      m_managers[ns] = std::move(manager);
+    }
+
+    for (const auto& consumerName : consumerNames) {
+      Buffer dKey = algo::Rsa::generateKey(rng, keyParams).getKeyBits();
+      Buffer eKey = algo::Rsa::deriveEncryptKey(dKey).getKeyBits();
+
+      IdentityCertificate cert;
+      cert.setName(Name(consumerName).append("KEY").append("ksk-1").append("ID-CERT").append("1"));
+      cert.setPublicKeyInfo(PublicKey(eKey.buf(), eKey.size()));
+      cert.encode();
+      m_keyChain.signWithSha256(cert);
+      for (auto& manager : m_managers)
+        manager.second->addMember("always", cert);
+
+      unique_ptr<Consumer> consumer(new Consumer(*m_network.addFace(), Name(),
+                                                 consumerName, ":memory:"));
+      consumer->addDecryptionKey(Name(consumerName).append("ksk-1"), dKey);
+      m_consumers[consumerName] = std::move(consumer);
+    }
+
+    for (const auto& ns : producerNamespaces) {
+      Name prefix, dataType;
+      if (!splitNamespace(ns, NAME_COMPONENT_SAMPLE, prefix, dataType))
+        continue;
+      m_network.addRoute(ns);
+      m_producers[ns].reset(new Producer(prefix, dataType, *m_network.addFace(), ":memory:",
+                                         m_keyChain));
+    }
+  }
+
+  void
+  run()
+  {
+    auto wallStart = std::chrono::steady_clock::now();
+    std::clock_t cpuStart = std::clock();
+
+    for (const auto& record : m_records) {
+      time::nanoseconds offset = record.time - m_traceStart;
+      advanceTo(m_traceStart + time::nanoseconds(static_cast<int64_t>(offset.count() /
+                                                                      m_options.speed)));
+      switch (record.type) {
+        case trace::Produce:
+          produce(record);
+          break;
+        case trace::Consume:
+          consume(record);
+          break;
+        case trace::GroupKey:
+          publishGroupKey(record.name, record.timeslot);
+          break;
+        default:
+          // the outcome and key events are compared with the replay, not replayed
+          break;
+      }
+    }
+    advanceTo(time::system_clock::now() + time::minutes(1));
+
+    m_cpuMs = (std::clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC;
+    m_wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                         wallStart).count();
+  }
+
+  void
+  report(std::ostream& os)
+  {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const VirtualNetwork::Counters& counters = m_network.getCounters();
+
+    os << "{\n"
+       << "  \"trace\": {\"records\": " << m_records.size()
+       << ", \"produce\": " << m_nRecorded[trace::Produce]
+       << ", \"consume\": " << m_nRecorded[trace::Consume]
+       << ", \"consumed\": " << m_nRecorded[trace::Consumed]
+       << ", \"consumeErrors\": " << m_nRecorded[trace::ConsumeError]
+       << ", \"cKeyRequests\": " << m_nRecorded[trace::CKeyRequest]
+       << ", \"dKeyRequests\": " << m_nRecorded[trace::DKeyRequest]
+       << ", \"groupKeys\": " << m_nRecorded[trace::GroupKey] << "},\n"
+       << "  \"replay\": {\"speed\": " << m_options.speed
+       << ", \"producers\": " << m_producers.size()
+       << ", \"consumers\": " << m_consumers.size()
+       << ", \"groupManagers\": " << m_managers.size()
+       << ", \"wallMs\": " << m_wallMs
+       << ", \"cpuMs\": " << m_cpuMs
+       << ", \"produceCpuMs\": " << m_produceCpuMs
+       << ", \"groupKeyCpuMs\": " << m_groupKeyCpuMs
+       << ", \"consumed\": " << m_latenciesMs.size()
+       << ", \"consumeErrors\": " << m_nFailed
+       << ", \"latencyMs\": {"
+       << "\"p50\": " << getPercentile(m_latenciesMs, 0.5)
+       << ", \"p90\": " << getPercentile(m_latenciesMs, 0.9)
+       << ", \"p99\": " << getPercentile(m_latenciesMs, 0.99)
+       << ", \"max\": " << getPercentile(m_latenciesMs, 1.0) << "}"
+       << ", \"packets\": {"
+       << "\"interests\": " << counters.nInterests
+       << ", \"data\": " << counters.nData
+       << ", \"nacks\": " << counters.nNacks
+       << ", \"lost\": " << counters.nLost
+       << ", \"csHits\": " << counters.nCsHits << "}"
+       << ", \"peakRssKb\": " << usage.ru_maxrss << "}\n"
+       << "}" << std::endl;
+  }
+
+private:
+  void
+  produce(const TraceRecord& record)
+  {
+    auto it = m_producers.find(record.name);
+    if (it == m_producers.end())
+      return;
+
+    if (m_synthesizedManagers.count(record.name) > 0) {
+      Name prefix, dataType;
+      splitNamespace(record.name, NAME_COMPONENT_SAMPLE, prefix, dataType);
+      publishGroupKey(Name(prefix).append(NAME_COMPONENT_READ).append(dataType),
+                      record.timeslot);
+    }
+
+    std::clock_t start = std::clock();
+    Producer& producer = *it->second;
+    producer.createContentKey(record.timeslot,
+                              [this] (const std::vector<Data>& cKeys) {
+                                for (const auto& cKey : cKeys)
+                                  m_network.publish(cKey);
+                              });
+    Buffer content(record.size);
+    Data data;
+    producer.produce(data, record.timeslot, content.buf(), content.size());
+    m_produceCpuMs += (std::clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    m_network.publish(data);
+  }
+
+  void
+  consume(const TraceRecord& record)
+  {
+    auto it = m_consumers.find(record.actor);
+    if (it == m_consumers.end())
+      return;
+
+    time::steady_clock::TimePoint start = time::steady_clock::now();
+    it->second->consume(record.name,
+                        [this, start] (const Data&, const Buffer&) {
+                          time::nanoseconds latency = time::steady_clock::now() - start;
+                          m_latenciesMs.push_back(latency.count() / 1e6);
+                        },
+                        [this] (const ErrorCode&, const std::string&) { m_nFailed++; });
+  }
+
+  void
+  publishGroupKey(const Name& groupNamespace, const time::system_clock::TimePoint& timeslot)
+  {
+    auto it = m_managers.find(groupNamespace);
+    if (it == m_managers.end())
+      return;
+
+    // a group key is published once per hour
+    time::system_clock::TimePoint hour =
+      time::fromUnixTimestamp(time::hours(time::duration_cast<time::hours>(
+        time::toUnixTimestamp(timeslot)).count()));
+    if (!m_publishedGroupKeys.insert(std::make_pair(groupNamespace, hour)).second)
+      return;
+
+    std::clock_t start = std::clock();
+    std::list<Data> groupKeys =
+      it->second->getGroupKey(boost::posix_time::from_iso_string(time::toIsoString(hour)));
+    m_groupKeyCpuMs += (std::clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    for (const auto& data : groupKeys)
+      m_network.publish(data);
+  }
+
+  void
+  advanceTo(const time::system_clock::TimePoint& until)
+  {
+    time::nanoseconds tick = time::milliseconds(m_options.tickMs);
+    while (time::system_clock::now() < until) {
+      // the last step ends at the time of the record
+      time::nanoseconds step = std::min<time::nanoseconds>(until - time::system_clock::now(),
+                                                           tick);
+      m_steadyClock->advance(step);
+      m_systemClock->advance(step);
+      if (m_io.stopped())
+        m_io.reset();
+      m_io.poll();
+    }
+  }
+
+private:
+  Options m_options;
+  shared_ptr<time::UnitTestSteadyClock> m_steadyClock;
+  shared_ptr<time::UnitTestSystemClock> m_systemClock;
+  boost::asio::io_service m_io;
+  VirtualNetwork m_network;
+
+  std::vector<TraceRecord> m_records;
+  time::system_clock::TimePoint m_traceStart;
+  std::map<int, size_t> m_nRecorded;
+
+  KeyChain m_keyChain;
+  std::map<Name, unique_ptr<GroupManager>> m_managers;
+  std::set<Name> m_synthesizedManagers;
+  std::set<std::pair<Name, time::system_clock::TimePoint>> m_publishedGroupKeys;
+  std::map<Name, unique_ptr<Producer>> m_producers;
+  std::map<Name, unique_ptr<Consumer>> m_consumers;
+
+  double m_wallMs = 0;
+  double m_cpuMs = 0;
+  double m_produceCpuMs = 0;
+  double m_groupKeyCpuMs = 0;
+  std::vector<double> m_latenciesMs;
+  size_t m_nFailed = 0;
+};
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  using namespace ndn::gep::benchmarks;
+
+  Options options = parseOptions(argc, argv);
+  try {
+    Replay replay(options);
+    replay.setUp();
+    replay.run();
+    replay.report(std::cout);
+  }
+  catch (const ndn::gep::TraceReader::Error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_GEP_BENCHMARKS_VIRTUAL_NETWORK_HPP
+#define NDN_GEP_BENCHMARKS_VIRTUAL_NETWORK_HPP
+
+#include "common.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+#include <ndn-cxx/lp/nack.hpp>
+
+#include <random>
+
+namespace ndn {
+namespace gep {
+namespace benchmarks {
+
+/**
+ * @brief In-memory forwarder connecting many DummyClientFaces in virtual time
+ *
+ * Applications publish their Data directly into the content store of the forwarder. An
+ * Interest sent by a face is answered from the content store, or is kept pending until
+ * matching Data is published or its lifetime expires. An Interest under none of the
+ * routes is NACKed with NoRoute. Each packet is delayed by the one-way delay and lost
+ * with the loss rate, independently in each direction.
+ */
+class VirtualNetwork
+{
+public:
+  struct Counters
+  {
+    uint64_t nInterests = 0;
+    uint64_t nData = 0;
+    uint64_t nNacks = 0;
+    uint64_t nLost = 0;
+    uint64_t nCsHits = 0;
+    uint64_t nPublished = 0;
+  };
+
+  VirtualNetwork(boost::asio::io_service& io, const time::milliseconds& delay, double lossRate,
+                 uint32_t seed = 0)
+    : m_io(io)
+    , m_scheduler(io)
+    , m_delay(delay)
+    , m_lossRate(lossRate)
+    , m_rng(seed)
+  {
+  }
+
+  /// @brief Create a face attached to the forwarder
+  shared_ptr<util::DummyClientFace>
+  addFace()
+  {
+    auto face = util::makeDummyClientFace(m_io, {false, false});
+    size_t faceId = m_faces.size();
+    m_faces.push_back(face);
+    face->onSendInterest.connect([this, faceId] (const Interest& interest) {
+        m_counters.nInterests++;
+        if (isLost())
+          return;
+        m_scheduler.scheduleEvent(m_delay, [this, faceId, interest] {
+            processInterest(faceId, interest);
+          });
+      });
+    return face;
+  }
+
+  /// @brief Let the Interests under @p prefix wait for Data to be published
+  void
+  addRoute(const Name& prefix)
+  {
+    m_routes.insert(prefix);
+  }
+
+  /// @brief Insert @p data in the content store and satisfy the pending Interests
+  void
+  publish(const Data& data)
+  {
+    m_counters.nPublished++;
+    auto stored = make_shared<Data>(data);
+    m_contentStore[stored->getName()] = {stored, time::steady_clock::now()};
+
+    time::steady_clock::TimePoint now = time::steady_clock::now();
+    const Name& name = stored->getName();
+    for (size_t i = 0; i <= name.size(); i++) {
+      auto it = m_pit.find(name.getPrefix(i));
+      if (it == m_pit.end())
+        continue;
+
+      auto& entries = it->second;
+      for (auto entry = entries.begin(); entry != entries.end();) {
+        if (entry->expiry < now) {
+          entry = entries.erase(entry);
+        }
+        else if (entry->interest.matchesData(*stored)) {
+          sendData(entry->faceId, stored);
+          entry = entries.erase(entry);
+        }
+        else {
+          ++entry;
+        }
+      }
+      if (entries.empty())
+        m_pit.erase(it);
+    }
+  }
+
+  /// @brief Evict the Data published more than @p age ago, and the expired Interests
+  void
+  purge(const time::nanoseconds& age)
+  {
+    time::steady_clock::TimePoint now = time::steady_clock::now();
+    for (auto it = m_contentStore.begin(); it != m_contentStore.end();) {
+      if (it->second.insertTime + age < now)
+        it = m_contentStore.erase(it);
+      else
+        ++it;
+    }
+
+    for (auto it = m_pit.begin(); it != m_pit.end();) {
+      it->second.remove_if([now] (const PitEntry& entry) { return entry.expiry < now; });
+      if (it->second.empty())
+        it = m_pit.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  const Counters&
+  getCounters() const
+  {
+    return m_counters;
+  }
+
+  size_t
+  getContentStoreSize() const
+  {
+    return m_contentStore.size();
+  }
+
+private:
+  struct CsEntry
+  {
+    shared_ptr<const Data> data;
+    time::steady_clock::TimePoint insertTime;
+  };
+
+  struct PitEntry
+  {
+    size_t faceId;
+    Interest interest;
+    time::steady_clock::TimePoint expiry;
+  };
+
+  bool
+  isLost()
+  {
+    if (m_lossRate <= 0 || m_lossDistribution(m_rng) >= m_lossRate)
+      return false;
+    m_counters.nLost++;
+    return true;
+  }
+
+  void
+  processInterest(size_t faceId, const Interest& interest)
+  {
+    shared_ptr<const Data> data = findData(interest);
+    if (data != nullptr) {
+      m_counters.nCsHits++;
+      sendData(faceId, data);
+      return;
+    }
+
+    if (hasRoute(interest.getName())) {
+      m_pit[interest.getName()].push_back({faceId, interest,
+                                           time::steady_clock::now() +
+                                           interest.getInterestLifetime()});
+      return;
+    }
+
+    m_counters.nNacks++;
+    if (isLost())
+      return;
+    lp::Nack nack(interest);
+    nack.setReason(lp::NackReason::NO_ROUTE);
+    m_scheduler.scheduleEvent(m_delay, [this, faceId, nack] { m_faces[faceId]->receive(nack); });
+  }
+
+  shared_ptr<const Data>
+  findData(const Interest& interest) const
+  {
+    // the leftmost or the rightmost matching Data under the Interest name
+    shared_ptr<const Data> match;
+    for (auto it = m_contentStore.lower_bound(interest.getName());
+         it != m_contentStore.end() && interest.getName().isPrefixOf(it->first); ++it) {
+      if (!interest.matchesData(*it->second.data))
+        continue;
+      match = it->second.data;
+      if (interest.getChildSelector() != 1)
+        break;
+    }
+    return match;
+  }
+
+  bool
+  hasRoute(const Name& name) const
+  {
+    for (size_t i = 0; i <= name.size(); i++) {
+      if (m_routes.count(name.getPrefix(i)) > 0)
+        return true;
+    }
+    return false;
+  }
+
+  void
+  sendData(size_t faceId, const shared_ptr<const Data>& data)
+  {
+    m_counters.nData++;
+    if (isLost())
+      return;
+    m_scheduler.scheduleEvent(m_delay, [this, faceId, data] { m_faces[faceId]->receive(*data); });
+  }
+
+private:
+  boost::asio::io_service& m_io;
+  util::scheduler::Scheduler m_scheduler;
+  time::milliseconds m_delay;
+  double m_lossRate;
+  std::mt19937 m_rng;
+  std::uniform_real_distribution<double> m_lossDistribution;
+
+  std::vector<shared_ptr<util::DummyClientFace>> m_faces;
+  std::set<Name> m_routes;
+  std::map<Name, CsEntry> m_contentStore;
+  std::map<Name, std::list<PitEntry>> m_pit;
+  Counters m_counters;
+};
+
+} // namespace benchmarks
+} // namespace gep
+} // namespace ndn
+
+#endif // NDN_GEP_BENCHMARKS_VIRTUAL_NETWORK_HPP
@@ -101,6 +101,49 @@ BOOST_AUTO_TEST_CASE(EncryptionDecryption)
                                 plaintext, plaintext + sizeof(plaintext));
 }
 
+BOOST_AUTO_TEST_CASE(DecryptBatch)
+{
+  RandomNumberGenerator rng;
+
+  // payloads of different lengths, including an exact multiple of the block size
+  std::vector<Buffer> plainTexts;
+  for (size_t len : {0, 1, 15, 16, 17, 100, 1000}) {
+    Buffer plainText(len);
+    rng.GenerateBlock(plainText.buf(), plainText.size());
+    plainTexts.push_back(plainText);
+  }
+
+  std::vector<Buffer> ivs;
+  std::vector<Buffer> cipherTexts;
+  for (const auto& plainText : plainTexts) {
+    EncryptParams eparams(tlv::AlgorithmAesCbc, 16);
+    cipherTexts.push_back(Aes::encrypt(key, sizeof(key), plainText.buf(), plainText.size(),
+                                       eparams));
+    ivs.push_back(eparams.getIV());
+  }
+
+  std::vector<Aes::CbcPayload> payloads;
+  for (size_t i = 0; i < cipherTexts.size(); i++)
+    payloads.push_back({ivs[i].buf(), cipherTexts[i].buf(), cipherTexts[i].size()});
+
+  std::vector<Buffer> results = Aes::decryptBatch(key, sizeof(key), payloads);
+  BOOST_REQUIRE_EQUAL(results.size(), plainTexts.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    BOOST_CHECK_EQUAL_COLLECTIONS(results[i].begin(), results[i].end(),
+                                  plainTexts[i].begin(), plainTexts[i].end());
+  }
+
+  // the known answer of the specified IV
+  payloads = {{initvector, ciphertext_cbc_iv, sizeof(ciphertext_cbc_iv)}};
+  results = Aes::decryptBatch(key, sizeof(key), payloads);
+  BOOST_CHECK_EQUAL_COLLECTIONS(results[0].begin(), results[0].end(),
+                                plaintext, plaintext + sizeof(plaintext));
+
+  // truncated payload
+  payloads = {{initvector, ciphertext_cbc_iv, sizeof(ciphertext_cbc_iv) - 1}};
+  BOOST_CHECK_THROW(Aes::decryptBatch(key, sizeof(key), payloads), Error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of gep (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of gep authors and contributors.
+ *
+ * gep is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * gep is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * gep, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "algo/compression.hpp"
+#include "algo/encryptor.hpp"
+#include "algo/aes.hpp"
+#include "algo/error.hpp"
+#include "encrypted-content.hpp"
+
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace gep {
+namespace algo {
+namespace tests {
+
+static Buffer
+makeSamples()
+{
+  std::string samples;
+  for (int i = 0; i < 100; i++)
+    samples += "{\"sensor\":\"temperature\",\"unit\":\"C\",\"value\":" + std::to_string(20 + i % 5) + "}\n";
+  return Buffer(samples.data(), samples.size());
+}
+
+BOOST_AUTO_TEST_SUITE(TestCompression)
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  Buffer samples = makeSamples();
+
+  for (auto type : {tlv::CompressionNone, tlv::CompressionLz4, tlv::CompressionZstd}) {
+    if (!Compression::isSupported(type)) {
+      BOOST_CHECK_THROW(Compression::compress(type, samples.buf(), samples.size()), Error);
+      continue;
+    }
+
+    Buffer compressed = Compression::compress(type, samples.buf(), samples.size());
+    if (type != tlv::CompressionNone)
+      BOOST_CHECK_LT(compressed.size(), samples.size());
+
+    Buffer decompressed = Compression::decompress(type, compressed.buf(), compressed.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(decompressed.begin(), decompressed.end(),
+                                  samples.begin(), samples.end());
+
+    if (type != tlv::CompressionNone) {
+      // truncated payload
+      BOOST_CHECK_THROW(Compression::decompress(type, compressed.buf(), 3), Error);
+      BOOST_CHECK_THROW(Compression::decompress(type, compressed.buf(), compressed.size() / 2),
+                        Error);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MaxPayloadLength)
+{
+  // a payload that consumers would refuse to decompress is rejected when compressed
+  Buffer large(Compression::MAX_PAYLOAD_LENGTH + 1);
+  for (auto type : {tlv::CompressionLz4, tlv::CompressionZstd}) {
+    if (Compression::isSupported(type))
+      BOOST_CHECK_THROW(Compression::compress(type, large.buf(), large.size()), Error);
+  }
+  BOOST_CHECK_EQUAL(Compression::compress(tlv::CompressionNone, large.buf(), large.size()).size(),
+                    large.size());
+}
+
+BOOST_AUTO_TEST_CASE(EncryptData)
+{
+  Buffer samples = makeSamples();
+  const uint8_t key[16] = {0};
+
+  for (auto type : {tlv::CompressionLz4, tlv::CompressionZstd}) {
+    if (!Compression::isSupported(type))
+      continue;
+
+    Data data("/data");
+    EncryptParams params(tlv::AlgorithmAesCbc, 16);
+    params.setCompressionType(type);
+    encryptData(data, samples.buf(), samples.size(), Name("/key"), key, sizeof(key), params);
+
+    EncryptedContent content(data.getContent().blockFromValue());
+    BOOST_CHECK_EQUAL(content.getCompressionAlgorithm(), type);
+    BOOST_CHECK_LT(content.getPayload().size(), samples.size());
+
+    Buffer compressed = Aes::decrypt(key, sizeof(key), content.getPayload().buf(),
+                                     content.getPayload().size(), params);
+    Buffer decompressed = Compression::decompress(type, compressed.buf(), compressed.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(decompressed.begin(), decompressed.end(),
+                                  samples.begin(), samples.end());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace algo
+} // namespace gep
+} // namespace ndn
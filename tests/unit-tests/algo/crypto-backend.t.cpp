@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "algo/crypto-backend.hpp"
+#include "algo/error.hpp"
+
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace gep {
+namespace algo {
+namespace tests {
+
+static const uint8_t KEY[] = {
+  0xdd, 0x60, 0x77, 0xec, 0xa9, 0x6b, 0x23, 0x1b,
+  0x40, 0x6b, 0x5a, 0xf8, 0x7d, 0x3d, 0x55, 0x32
+};
+
+static const uint8_t PLAINTEXT[] = { // plaintext: AES-Encrypt-Test
+  0x41, 0x45, 0x53, 0x2d, 0x45, 0x6e, 0x63, 0x72,
+  0x79, 0x70, 0x74, 0x2d, 0x54, 0x65, 0x73, 0x74
+};
+
+static const uint8_t CIPHERTEXT_ECB[] = {
+  0xcb, 0xe5, 0x6a, 0x80, 0x41, 0x24, 0x58, 0x23,
+  0x84, 0x14, 0x15, 0x61, 0x80, 0xb9, 0x5e, 0xbd,
+  0xce, 0x32, 0xb4, 0xbe, 0xbc, 0x91, 0x31, 0xd6,
+  0x19, 0x00, 0x80, 0x8b, 0xfa, 0x00, 0x05, 0x9c
+};
+
+static const uint8_t IV[] = {
+  0x6f, 0x53, 0x7a, 0x65, 0x58, 0x6c, 0x65, 0x75,
+  0x44, 0x4c, 0x77, 0x35, 0x58, 0x63, 0x78, 0x6e
+};
+
+static const uint8_t CIPHERTEXT_CBC[] = {
+  0xb7, 0x19, 0x5a, 0xbb, 0x23, 0xbf, 0x92, 0xb0,
+  0x95, 0xae, 0x74, 0xe9, 0xad, 0x72, 0x7c, 0x28,
+  0x6e, 0xc6, 0x73, 0xb5, 0x0b, 0x1a, 0x9e, 0xb9,
+  0x4d, 0xc5, 0xbd, 0x8b, 0x47, 0x1f, 0x43, 0x00
+};
+
+BOOST_AUTO_TEST_SUITE(TestCryptoBackend)
+
+// every backend built in the library must pass the same cases
+
+BOOST_AUTO_TEST_CASE(AesKnownAnswers)
+{
+  for (const std::string& name : CryptoBackend::getNames()) {
+    BOOST_TEST_MESSAGE("backend " << name);
+    CryptoBackend& backend = CryptoBackend::get(name);
+
+    Buffer cipherText = backend.encryptAes(tlv::AlgorithmAesEcb, KEY, sizeof(KEY), nullptr,
+                                           PLAINTEXT, sizeof(PLAINTEXT));
+    BOOST_CHECK_EQUAL_COLLECTIONS(cipherText.begin(), cipherText.end(),
+                                  CIPHERTEXT_ECB, CIPHERTEXT_ECB + sizeof(CIPHERTEXT_ECB));
+    Buffer plainText = backend.decryptAes(tlv::AlgorithmAesEcb, KEY, sizeof(KEY), nullptr,
+                                          cipherText.buf(), cipherText.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(plainText.begin(), plainText.end(),
+                                  PLAINTEXT, PLAINTEXT + sizeof(PLAINTEXT));
+
+    cipherText = backend.encryptAes(tlv::AlgorithmAesCbc, KEY, sizeof(KEY), IV,
+                                    PLAINTEXT, sizeof(PLAINTEXT));
+    BOOST_CHECK_EQUAL_COLLECTIONS(cipherText.begin(), cipherText.end(),
+                                  CIPHERTEXT_CBC, CIPHERTEXT_CBC + sizeof(CIPHERTEXT_CBC));
+    plainText = backend.decryptAes(tlv::AlgorithmAesCbc, KEY, sizeof(KEY), IV,
+                                   cipherText.buf(), cipherText.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(plainText.begin(), plainText.end(),
+                                  PLAINTEXT, PLAINTEXT + sizeof(PLAINTEXT));
+
+    std::vector<Buffer> plainTexts =
+      backend.decryptAesCbcBatch(KEY, sizeof(KEY), {{IV, CIPHERTEXT_CBC, sizeof(CIPHERTEXT_CBC)},
+                                                    {IV, CIPHERTEXT_CBC, sizeof(CIPHERTEXT_CBC)}});
+    BOOST_REQUIRE_EQUAL(plainTexts.size(), 2);
+    for (const Buffer& batchPlainText : plainTexts)
+      BOOST_CHECK_EQUAL_COLLECTIONS(batchPlainText.begin(), batchPlainText.end(),
+                                    PLAINTEXT, PLAINTEXT + sizeof(PLAINTEXT));
+
+    // an empty payload is a block of padding
+    cipherText = backend.encryptAes(tlv::AlgorithmAesCbc, KEY, sizeof(KEY), IV, PLAINTEXT, 0);
+    BOOST_CHECK_EQUAL(cipherText.size(), 16);
+
+    BOOST_CHECK_THROW(backend.encryptAes(tlv::AlgorithmRsaOaep, KEY, sizeof(KEY), IV,
+                                         PLAINTEXT, sizeof(PLAINTEXT)), Error);
+    BOOST_CHECK_THROW(backend.decryptAes(tlv::AlgorithmAesCbc, KEY, sizeof(KEY), IV,
+                                         CIPHERTEXT_CBC, 15), std::exception);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RsaInterop)
+{
+  RandomNumberGenerator rng;
+  const uint8_t nonceKey[16] = {0x01, 0x02, 0x03, 0x04};
+
+  for (const std::string& keyBackend : CryptoBackend::getNames()) {
+    Buffer privateKey = CryptoBackend::get(keyBackend).generateRsaKey(rng, 1024);
+    Buffer publicKey = CryptoBackend::get(keyBackend).deriveRsaPublicKey(privateKey.buf(),
+                                                                         privateKey.size());
+
+    // the keys of any backend can be used by every backend, in both directions
+    for (const std::string& encryptBackend : CryptoBackend::getNames()) {
+      for (const std::string& decryptBackend : CryptoBackend::getNames()) {
+        BOOST_TEST_MESSAGE("key " << keyBackend << ", encrypt " << encryptBackend <<
+                           ", decrypt " << decryptBackend);
+        CryptoBackend& encryptor = CryptoBackend::get(encryptBackend);
+        CryptoBackend& decryptor = CryptoBackend::get(decryptBackend);
+        BOOST_CHECK_EQUAL(encryptor.getRsaModulusSize(publicKey.buf(), publicKey.size()), 128);
+
+        for (tlv::AlgorithmTypeValue padding : {tlv::AlgorithmRsaOaep, tlv::AlgorithmRsaPkcs}) {
+          Buffer cipherText = encryptor.encryptRsa(publicKey.buf(), publicKey.size(),
+                                                   nonceKey, sizeof(nonceKey), padding);
+          BOOST_CHECK_EQUAL(cipherText.size(), 128);
+          Buffer plainText = decryptor.decryptRsa(privateKey.buf(), privateKey.size(),
+                                                  cipherText.buf(), cipherText.size(), padding);
+          BOOST_CHECK_EQUAL_COLLECTIONS(plainText.begin(), plainText.end(),
+                                        nonceKey, nonceKey + sizeof(nonceKey));
+        }
+
+        BOOST_CHECK_THROW(encryptor.encryptRsa(publicKey.buf(), publicKey.size(), nonceKey,
+                                               sizeof(nonceKey), tlv::AlgorithmAesCbc), Error);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Selection)
+{
+  std::string defaultName = CryptoBackend::get().getName();
+
+  for (const std::string& name : CryptoBackend::getNames()) {
+    CryptoBackend::select(name);
+    BOOST_CHECK_EQUAL(CryptoBackend::get().getName(), name);
+    BOOST_CHECK_EQUAL(&CryptoBackend::get(), &CryptoBackend::get(name));
+  }
+
+  BOOST_CHECK_THROW(CryptoBackend::select("unknown"), Error);
+  BOOST_CHECK_THROW(CryptoBackend::get("unknown"), Error);
+  CryptoBackend::select(defaultName);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace algo
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "caching-validator.hpp"
+#include "boost-test.hpp"
+
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/certificate-cache-ttl.hpp>
+#include <boost/asio.hpp>
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+/**
+ * @brief Validator accepting the packets signed with a given key, counting its calls
+ */
+class CountingValidator : public Validator
+{
+public:
+  CountingValidator(const PublicKey& publicKey, size_t& nCalls)
+    : m_publicKey(publicKey)
+    , m_nCalls(nCalls)
+  {
+  }
+
+protected:
+  void
+  checkPolicy(const Data& data, int nSteps,
+              const OnDataValidated& onValidated,
+              const OnDataValidationFailed& onValidationFailed,
+              std::vector<shared_ptr<ValidationRequest>>& nextSteps) DECL_OVERRIDE
+  {
+    m_nCalls++;
+    if (verifySignature(data, m_publicKey))
+      onValidated(data.shared_from_this());
+    else
+      onValidationFailed(data.shared_from_this(), "invalid signature");
+  }
+
+  void
+  checkPolicy(const Interest& interest, int nSteps,
+              const OnInterestValidated& onValidated,
+              const OnInterestValidationFailed& onValidationFailed,
+              std::vector<shared_ptr<ValidationRequest>>& nextSteps) DECL_OVERRIDE
+  {
+    m_nCalls++;
+    onValidated(interest.shared_from_this());
+  }
+
+private:
+  PublicKey m_publicKey;
+  size_t& m_nCalls;
+};
+
+class CachingValidatorFixture
+{
+public:
+  CachingValidatorFixture()
+    : nInnerCalls(0)
+    , nValidated(0)
+    , nFailed(0)
+  {
+    certificate = keyChain.getCertificate(keyChain.getDefaultCertificateName());
+  }
+
+  unique_ptr<Validator>
+  makeInner()
+  {
+    return unique_ptr<Validator>(new CountingValidator(certificate->getPublicKeyInfo(),
+                                                       nInnerCalls));
+  }
+
+  shared_ptr<Data>
+  makeData(const Name& name)
+  {
+    shared_ptr<Data> data = make_shared<Data>(name);
+    data->setContent(name.wireEncode());
+    keyChain.sign(*data);
+    data->wireEncode();
+    return data;
+  }
+
+  void
+  validate(Validator& validator, const Data& data)
+  {
+    validator.validate(data,
+                       [this] (const shared_ptr<const Data>&) { nValidated++; },
+                       [this] (const shared_ptr<const Data>&, const std::string&) { nFailed++; });
+  }
+
+public:
+  KeyChain keyChain;
+  shared_ptr<IdentityCertificate> certificate;
+  boost::asio::io_service io;
+  size_t nInnerCalls;
+  size_t nValidated;
+  size_t nFailed;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestCachingValidator, CachingValidatorFixture)
+
+BOOST_AUTO_TEST_CASE(DigestCache)
+{
+  CachingValidator validator(makeInner());
+  shared_ptr<Data> data = makeData("/prefix/SAMPLE/data/1");
+
+  validate(validator, *data);
+  validate(validator, *data);
+  validate(validator, *makeData("/prefix/SAMPLE/data/2"));
+
+  BOOST_CHECK_EQUAL(nValidated, 3);
+  BOOST_CHECK_EQUAL(nInnerCalls, 2);
+  BOOST_CHECK_EQUAL(validator.getNDigestHits(), 1);
+  BOOST_CHECK_EQUAL(validator.getNInnerValidations(), 2);
+
+  // the least recently validated digest is evicted
+  CachingValidator smallValidator(makeInner(), nullptr, 1);
+  validate(smallValidator, *data);
+  validate(smallValidator, *makeData("/prefix/SAMPLE/data/3"));
+  validate(smallValidator, *data);
+  BOOST_CHECK_EQUAL(smallValidator.getNDigestHits(), 0);
+  BOOST_CHECK_EQUAL(smallValidator.getNInnerValidations(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(TrustedCertificate)
+{
+  CachingValidator validator(makeInner());
+  validator.addTrustedCertificate(*certificate, "/prefix/SAMPLE");
+
+  for (int i = 0; i < 5; i++)
+    validate(validator, *makeData(Name("/prefix/SAMPLE/data").appendNumber(i)));
+  BOOST_CHECK_EQUAL(nValidated, 5);
+  BOOST_CHECK_EQUAL(nInnerCalls, 0);
+  BOOST_CHECK_EQUAL(validator.getNSignerHits(), 5);
+
+  // the signer is not trusted outside of its scope
+  validate(validator, *makeData("/other/data"));
+  BOOST_CHECK_EQUAL(nValidated, 6);
+  BOOST_CHECK_EQUAL(nInnerCalls, 1);
+
+  // the signature is still verified
+  shared_ptr<Data> forged = makeData("/prefix/SAMPLE/data/forged");
+  forged->setContent(Name("/forged").wireEncode());
+  forged->setSignature(makeData("/prefix/SAMPLE/data/0")->getSignature());
+  forged->wireEncode();
+  validate(validator, *forged);
+  BOOST_CHECK_EQUAL(nFailed, 1);
+  BOOST_CHECK_EQUAL(nInnerCalls, 1);
+
+  validator.resetCache();
+  validate(validator, *makeData("/prefix/SAMPLE/data/6"));
+  BOOST_CHECK_EQUAL(nInnerCalls, 2);
+}
+
+BOOST_AUTO_TEST_CASE(LearnSigner)
+{
+  auto certificateCache = make_shared<CertificateCacheTtl>(io);
+  certificateCache->insertCertificate(certificate);
+  io.poll();
+  CachingValidator validator(makeInner(), certificateCache);
+
+  validate(validator, *makeData("/prefix/SAMPLE/data/1"));
+  BOOST_CHECK_EQUAL(nInnerCalls, 1);
+
+  // the signer accepted by the inner validator is known for the same name
+  shared_ptr<Data> resigned = makeData("/prefix/SAMPLE/data/1");
+  resigned->setContent(Name("/resigned").wireEncode());
+  keyChain.sign(*resigned);
+  validate(validator, *resigned);
+  BOOST_CHECK_EQUAL(nInnerCalls, 1);
+  BOOST_CHECK_EQUAL(validator.getNSignerHits(), 1);
+
+  // but not for the other names of the namespace, which the inner rules may not allow
+  validate(validator, *makeData("/prefix/SAMPLE/data/2"));
+  validate(validator, *makeData("/prefix/C-KEY/1"));
+  BOOST_CHECK_EQUAL(nInnerCalls, 3);
+  BOOST_CHECK_EQUAL(validator.getNSignerHits(), 1);
+  BOOST_CHECK_EQUAL(nValidated, 4);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerPoolBatch)
+{
+  CachingValidator validator(makeInner());
+  validator.addTrustedCertificate(*certificate);
+  validator.setWorkerPool(make_shared<WorkerPool>(2), io);
+
+  std::vector<shared_ptr<Data>> dataList;
+  for (int i = 0; i < 10; i++)
+    dataList.push_back(makeData(Name("/prefix/SAMPLE/data").appendNumber(i)));
+  dataList[3]->setContent(Name("/forged").wireEncode());
+  dataList[3]->setSignature(dataList[4]->getSignature());
+  dataList[3]->wireEncode();
+
+  for (const auto& data : dataList)
+    validate(validator, *data);
+  // the results are delivered through the io_service
+  BOOST_CHECK_EQUAL(nValidated + nFailed, 0);
+
+  io.run();
+  BOOST_CHECK_EQUAL(nValidated, 9);
+  BOOST_CHECK_EQUAL(nFailed, 1);
+  BOOST_CHECK_EQUAL(nInnerCalls, 0);
+
+  // the validated digests are cached
+  validate(validator, *dataList[0]);
+  BOOST_CHECK_EQUAL(nValidated, 10);
+  BOOST_CHECK_EQUAL(validator.getNDigestHits(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerPoolUnset)
+{
+  CachingValidator validator(makeInner());
+  validator.addTrustedCertificate(*certificate);
+  validator.setWorkerPool(make_shared<WorkerPool>(2), io);
+
+  validate(validator, *makeData("/prefix/SAMPLE/data/1"));
+  // the batch already posted is still verified on the pool it was posted with
+  validator.setWorkerPool(nullptr, io);
+  validate(validator, *makeData("/prefix/SAMPLE/data/2"));
+  BOOST_CHECK_EQUAL(nValidated, 1);
+
+  io.run();
+  BOOST_CHECK_EQUAL(nValidated, 2);
+  BOOST_CHECK_EQUAL(nFailed, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
@@ -23,8 +23,10 @@
 #include "consumer.hpp"
 #include "boost-test.hpp"
 #include "algo/encryptor.hpp"
+#include "encrypted-content.hpp"
 #include "unit-test-time-fixture.hpp"
 
+#include <ndn-cxx/encoding/block-helpers.hpp>
 #include <ndn-cxx/security/key-chain.hpp>
 #include <ndn-cxx/util/dummy-client-face.hpp>
 #include <ndn-cxx/util/time-unit-test-clock.hpp>
@@ -288,6 +290,522 @@ BOOST_AUTO_TEST_CASE(Consume)
   BOOST_CHECK_EQUAL(cKeyCount, 1);
   BOOST_CHECK_EQUAL(dKeyCount, 1);
   BOOST_CHECK_EQUAL(finalCount, 1);
+
+  // RTT of content and key retrieval is measured
+  const RttEstimator& estimator = consumer.getRttEstimator();
+  BOOST_CHECK_EQUAL(estimator.getStatistics(Name("/Prefix/SAMPLE")).nSamples, 1);
+  BOOST_CHECK_EQUAL(estimator.getStatistics(Name("/Prefix/SAMPLE/Content/C-KEY")).nSamples, 1);
+  BOOST_CHECK_EQUAL(estimator.getStatistics(Name("/Prefix/READ/D-KEY")).nSamples, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ConsumeAsync)
+{
+  auto contentData = createEncryptedContent();
+  auto cKeyData = createEncryptedCKey();
+  auto dKeyData = createEncryptedDKey();
+
+  face1->setInterestFilter(Name("/Prefix"),
+                           [&] (const InterestFilter&, const Interest& i) {
+                             for (const auto& data : {contentData, cKeyData, dKeyData}) {
+                               if (i.matchesData(*data)) {
+                                 face1->put(*data);
+                                 return;
+                               }
+                             }
+                           },
+                           RegisterPrefixSuccessCallback(),
+                           [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+  Consumer consumer(*face2, groupName, uName, dbDir);
+  consumer.addDecryptionKey(uKeyName, fixtureUDKeyBuf);
+
+  // consume the same content twice at once, the second one uses the saved keys
+  std::vector<Future<ConsumedData>> futures;
+  futures.push_back(consumer.consumeAsync(contentName));
+  Future<ConsumedData> missing = consumer.consumeAsync(Name("/Prefix/SAMPLE/Missing"));
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+  futures.push_back(consumer.consumeAsync(contentName));
+
+  int finalCount = 0;
+  whenAll(futures).then([&] (const std::vector<ConsumedData>& results) {
+      for (const auto& result : results) {
+        finalCount++;
+        BOOST_CHECK_EQUAL(result.first.getName(), contentData->getName());
+        BOOST_CHECK_EQUAL_COLLECTIONS(result.second.begin(), result.second.end(),
+                                      DATA_CONTEN, DATA_CONTEN + sizeof(DATA_CONTEN));
+      }
+    },
+    [] (const ErrorCode&, const std::string&) { BOOST_CHECK(false); });
+
+  for (int i = 0; i < 50; i++) {
+    do {
+      advanceClocks(time::milliseconds(10), 20);
+    } while (passPacket());
+  }
+
+  BOOST_CHECK_EQUAL(finalCount, 2);
+
+  // retrieval of content nobody answers fails after the retrial
+  BOOST_CHECK(missing.isReady());
+  BOOST_CHECK_EQUAL(missing.hasValue(), false);
+}
+
+BOOST_AUTO_TEST_CASE(ConsumeSegments)
+{
+  auto cKeyData = createEncryptedCKey();
+  auto dKeyData = createEncryptedDKey();
+
+  // the content is DATA_CONTEN repeated in 5 segments, each with its own initial vector
+  std::vector<shared_ptr<Data>> segments;
+  for (uint64_t i = 0; i < 5; i++) {
+    shared_ptr<Data> segment = make_shared<Data>(Name(contentName).appendSegment(i));
+    algo::EncryptParams eparams(tlv::AlgorithmAesCbc, 16);
+    algo::encryptData(*segment, DATA_CONTEN, sizeof(DATA_CONTEN), cKeyName,
+                      fixtureCKeyBuf.buf(), fixtureCKeyBuf.size(), eparams);
+    segment->setName(Name(contentName).appendSegment(i));
+    segment->setFinalBlockId(name::Component::fromSegment(4));
+    keyChain.sign(*segment);
+    segments.push_back(segment);
+  }
+
+  size_t nSegmentInterests = 0;
+  face1->setInterestFilter(Name("/Prefix"),
+                           [&] (const InterestFilter&, const Interest& i) {
+                             for (const auto& data : segments) {
+                               if (i.matchesData(*data)) {
+                                 nSegmentInterests++;
+                                 face1->put(*data);
+                                 return;
+                               }
+                             }
+                             for (const auto& data : {cKeyData, dKeyData}) {
+                               if (i.matchesData(*data)) {
+                                 face1->put(*data);
+                                 return;
+                               }
+                             }
+                           },
+                           RegisterPrefixSuccessCallback(),
+                           [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+  Consumer consumer(*face2, groupName, uName, dbDir);
+  consumer.addDecryptionKey(uKeyName, fixtureUDKeyBuf);
+
+  int finalCount = 0;
+  consumer.consumeSegments(contentName,
+                           [&] (const Buffer& result) {
+                             finalCount++;
+                             BOOST_REQUIRE_EQUAL(result.size(), 5 * sizeof(DATA_CONTEN));
+                             for (size_t i = 0; i < 5; i++)
+                               BOOST_CHECK(std::equal(DATA_CONTEN,
+                                                      DATA_CONTEN + sizeof(DATA_CONTEN),
+                                                      result.begin() + i * sizeof(DATA_CONTEN)));
+                           },
+                           [] (const ErrorCode&, const std::string&) { BOOST_CHECK(false); },
+                           2);
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  BOOST_CHECK_EQUAL(finalCount, 1);
+  BOOST_CHECK_EQUAL(nSegmentInterests, 5);
+
+  // a missing segment fails the retrieval
+  int errorCount = 0;
+  consumer.consumeSegments(Name("/Prefix/SAMPLE/Missing"),
+                           [] (const Buffer&) { BOOST_CHECK(false); },
+                           [&] (const ErrorCode&, const std::string&) { errorCount++; });
+
+  for (int i = 0; i < 50; i++) {
+    do {
+      advanceClocks(time::milliseconds(10), 20);
+    } while (passPacket());
+  }
+
+  BOOST_CHECK_EQUAL(errorCount, 1);
+
+  // a FinalBlockId beyond the maximum fails the retrieval before the segments are requested
+  auto hugeSegment = make_shared<Data>(Name("/Prefix/SAMPLE/Huge").appendSegment(0));
+  hugeSegment->setFinalBlockId(name::Component::fromSegment(1ULL << 40));
+  keyChain.sign(*hugeSegment);
+  segments.push_back(hugeSegment);
+
+  nSegmentInterests = 0;
+  ErrorCode hugeErrorCode = ErrorCode::Timeout;
+  consumer.consumeSegments(Name("/Prefix/SAMPLE/Huge"),
+                           [] (const Buffer&) { BOOST_CHECK(false); },
+                           [&] (const ErrorCode& code, const std::string&) {
+                             hugeErrorCode = code;
+                           });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  BOOST_CHECK(hugeErrorCode == ErrorCode::InvalidEncryptedFormat);
+  BOOST_CHECK_EQUAL(nSegmentInterests, 1);
+}
+
+BOOST_AUTO_TEST_CASE(DecryptContentBatch)
+{
+  auto cKeyData = createEncryptedCKey();
+  auto dKeyData = createEncryptedDKey();
+
+  face1->setInterestFilter(Name("/Prefix"),
+                           [&] (const InterestFilter&, const Interest& i) {
+                             for (const auto& data : {cKeyData, dKeyData}) {
+                               if (i.matchesData(*data)) {
+                                 face1->put(*data);
+                                 return;
+                               }
+                             }
+                           },
+                           RegisterPrefixSuccessCallback(),
+                           [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+  Consumer consumer(*face2, groupName, uName, dbDir);
+  consumer.addDecryptionKey(uKeyName, fixtureUDKeyBuf);
+
+  // enough contents to be decrypted on several threads
+  std::vector<Data> dataList;
+  for (size_t i = 0; i < 300; i++) {
+    Data data(Name(contentName).appendNumber(i));
+    algo::EncryptParams eparams(tlv::AlgorithmAesCbc, 16);
+    algo::encryptData(data, DATA_CONTEN, i % sizeof(DATA_CONTEN), cKeyName,
+                      fixtureCKeyBuf.buf(), fixtureCKeyBuf.size(), eparams);
+    dataList.push_back(data);
+  }
+
+  int finalCount = 0;
+  consumer.decryptContentBatch(dataList,
+                               [&] (const std::vector<Buffer>& results) {
+                                 finalCount++;
+                                 BOOST_REQUIRE_EQUAL(results.size(), dataList.size());
+                                 for (size_t i = 0; i < results.size(); i++) {
+                                   size_t len = i % sizeof(DATA_CONTEN);
+                                   BOOST_CHECK_EQUAL_COLLECTIONS(results[i].begin(),
+                                                                 results[i].end(),
+                                                                 DATA_CONTEN, DATA_CONTEN + len);
+                                 }
+                               },
+                               [] (const ErrorCode&, const std::string&) { BOOST_CHECK(false); });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  BOOST_CHECK_EQUAL(finalCount, 1);
+
+  // a content whose payload is truncated fails the whole batch
+  EncryptedContent truncated(dataList[10].getContent().blockFromValue());
+  Buffer payload = truncated.getPayload();
+  truncated.setPayload(payload.buf(), payload.size() - 1);
+  dataList[10].setContent(truncated.wireEncode());
+
+  int errorCount = 0;
+  consumer.decryptContentBatch(dataList,
+                               [] (const std::vector<Buffer>&) { BOOST_CHECK(false); },
+                               [&] (const ErrorCode& code, const std::string&) {
+                                 errorCount++;
+                                 BOOST_CHECK(code == ErrorCode::InvalidEncryptedFormat);
+                               });
+  BOOST_CHECK_EQUAL(errorCount, 1);
+}
+
+BOOST_AUTO_TEST_CASE(DKeyBundle)
+{
+  auto contentData = createEncryptedContent();
+  auto cKeyData = createEncryptedCKey();
+  auto dKeyData = createEncryptedDKey();
+
+  // bundle of two segments, the first carrying the D-KEY, encrypted for the consumer
+  std::vector<shared_ptr<Data>> bundleSegments;
+  for (uint64_t i = 0; i < 2; i++) {
+    Block entry(tlv::DKeyEntry);
+    entry.push_back(i == 0 ? dKeyName.wireEncode() : Name(dKeyName).append("other").wireEncode());
+    entry.push_back(makeBinaryBlock(tlv::DKeyBits, fixtureDKeyBuf.buf(), fixtureDKeyBuf.size()));
+    entry.encode();
+    Block bundle(tlv::DKeyBundle);
+    bundle.push_back(entry);
+    bundle.encode();
+
+    auto bundleData = make_shared<Data>(Name("/Prefix/READ/D-KEY-BUNDLE")
+                                          .append("20150825T000000").append("20150826T000000"));
+    algo::EncryptParams eparams(tlv::AlgorithmRsaOaep);
+    algo::encryptData(*bundleData, bundle.wire(), bundle.size(), uKeyName,
+                      fixtureUEKeyBuf.buf(), fixtureUEKeyBuf.size(), eparams);
+    bundleData->setName(Name(bundleData->getName()).appendSegment(i));
+    bundleData->setFinalBlockId(name::Component::fromSegment(1));
+    keyChain.sign(*bundleData);
+    bundleSegments.push_back(bundleData);
+  }
+
+  int cKeyCount = 0;
+  int dKeyCount = 0;
+  int bundleCount = 0;
+
+  face1->setInterestFilter(Name("/Prefix"),
+                           [&] (const InterestFilter&, const Interest& i) {
+                             if (i.matchesData(*contentData)) {
+                               face1->put(*contentData);
+                               return;
+                             }
+                             if (i.matchesData(*cKeyData)) {
+                               cKeyCount++;
+                               face1->put(*cKeyData);
+                               return;
+                             }
+                             if (i.matchesData(*dKeyData)) {
+                               dKeyCount++;
+                               face1->put(*dKeyData);
+                               return;
+                             }
+                             for (const auto& bundleData : bundleSegments) {
+                               if (i.matchesData(*bundleData)) {
+                                 bundleCount++;
+                                 face1->put(*bundleData);
+                                 return;
+                               }
+                             }
+                           },
+                           RegisterPrefixSuccessCallback(),
+                           [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+  Consumer consumer(*face2, groupName, uName, dbDir);
+  consumer.addDecryptionKey(uKeyName, fixtureUDKeyBuf);
+
+  size_t nDKeys = 0;
+  consumer.fetchDKeyBundle(boost::posix_time::from_iso_string("20150825T000000"),
+                           boost::posix_time::from_iso_string("20150826T000000"),
+                           [&] (size_t n) { nDKeys = n; },
+                           [] (const ErrorCode&, const std::string&) { BOOST_CHECK(false); });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  BOOST_CHECK_EQUAL(bundleCount, 2);
+  BOOST_CHECK_EQUAL(nDKeys, 2);
+
+  // content is decrypted without retrieving the D-KEY
+  int finalCount = 0;
+  consumer.consume(contentName,
+                   [&] (const Data& data, const Buffer& result) {
+                     finalCount++;
+                     BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                                   DATA_CONTEN,
+                                                   DATA_CONTEN + sizeof(DATA_CONTEN));
+                   },
+                   [] (const ErrorCode& code, const std::string& str) { BOOST_CHECK(false); });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  BOOST_CHECK_EQUAL(finalCount, 1);
+  BOOST_CHECK_EQUAL(cKeyCount, 1);
+  BOOST_CHECK_EQUAL(dKeyCount, 0);
+}
+
+BOOST_AUTO_TEST_CASE(LocalKeys)
+{
+  auto contentData = createEncryptedContent();
+
+  int contentCount = 0;
+  int keyCount = 0;
+  face1->setInterestFilter(Name("/Prefix"),
+                           [&] (const InterestFilter&, const Interest& i) {
+                             if (i.matchesData(*contentData)) {
+                               contentCount++;
+                               face1->put(*contentData);
+                             }
+                             else {
+                               keyCount++;
+                             }
+                           },
+                           RegisterPrefixSuccessCallback(),
+                           [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  // the group manager and the producer register their keys in the same process
+  auto localKeys = make_shared<LocalKeyRegistry>();
+  Name eKeyName("/Prefix/READ/E-KEY/20150825T090000/20150825T100000");
+  localKeys->addGroupKey(eKeyName, fixtureEKeyBuf, fixtureDKeyBuf, {uKeyName});
+  localKeys->addContentKey(cKeyName, eKeyName, fixtureCKeyBuf);
+
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+  Consumer consumer(*face2, groupName, uName, dbDir);
+  consumer.setLocalKeyRegistry(localKeys);
+
+  int finalCount = 0;
+  consumer.consume(contentName,
+                   [&] (const Data& data, const Buffer& result) {
+                     finalCount++;
+                     BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                                   DATA_CONTEN,
+                                                   DATA_CONTEN + sizeof(DATA_CONTEN));
+                   },
+                   [] (const ErrorCode& code, const std::string& str) { BOOST_CHECK(false); });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  // only the content is retrieved from the network
+  BOOST_CHECK_EQUAL(finalCount, 1);
+  BOOST_CHECK_EQUAL(contentCount, 1);
+  BOOST_CHECK_EQUAL(keyCount, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Prefetch)
+{
+  // C-KEYs of two consecutive hours starting from now
+  time::system_clock::TimePoint hourSlot0 = time::fromUnixTimestamp(
+    time::milliseconds((time::toUnixTimestamp(time::system_clock::now()).count() / 3600000) * 3600000));
+  time::system_clock::TimePoint hourSlot1 = hourSlot0 + time::hours(1);
+  Name cKeyName0 = Name("/Prefix/SAMPLE/Content/C-KEY").append(time::toIsoString(hourSlot0));
+  Name cKeyName1 = Name("/Prefix/SAMPLE/Content/C-KEY").append(time::toIsoString(hourSlot1));
+
+  auto createData = [&] (const Name& name, const Buffer& payload, const Name& keyName,
+                         const Buffer& key, tlv::AlgorithmTypeValue algorithm) {
+    shared_ptr<Data> data = make_shared<Data>(name);
+    algo::EncryptParams eparams(algorithm);
+    if (algorithm == tlv::AlgorithmAesCbc)
+      eparams.setIV(IV, sizeof(IV));
+    algo::encryptData(*data, payload.buf(), payload.size(), keyName,
+                      key.buf(), key.size(), eparams);
+    keyChain.sign(*data);
+    return data;
+  };
+
+  Buffer content(DATA_CONTEN, sizeof(DATA_CONTEN));
+  std::vector<shared_ptr<Data>> packets;
+  packets.push_back(createData(Name(contentName).append("0"), content, cKeyName0,
+                               fixtureCKeyBuf, tlv::AlgorithmAesCbc));
+  packets.push_back(createData(Name(contentName).append("1"), content, cKeyName1,
+                               fixtureCKeyBuf, tlv::AlgorithmAesCbc));
+  packets.push_back(createData(cKeyName0, fixtureCKeyBuf, dKeyName,
+                               fixtureEKeyBuf, tlv::AlgorithmRsaOaep));
+  packets.push_back(createData(cKeyName1, fixtureCKeyBuf, dKeyName,
+                               fixtureEKeyBuf, tlv::AlgorithmRsaOaep));
+  packets.push_back(createEncryptedDKey());
+
+  // the producer creates the C-KEY of the next hour late
+  bool isCKey1Ready = false;
+  int nCKey1Interests = 0;
+  std::vector<int> requestCounts(packets.size(), 0);
+  face1->setInterestFilter(Name("/Prefix"),
+                           [&] (const InterestFilter&, const Interest& i) {
+                             if (i.matchesData(*packets[3])) {
+                               nCKey1Interests++;
+                               if (!isCKey1Ready)
+                                 return;
+                             }
+                             for (size_t n = 0; n < packets.size(); n++) {
+                               if (i.matchesData(*packets[n])) {
+                                 requestCounts[n]++;
+                                 face1->put(*packets[n]);
+                                 return;
+                               }
+                             }
+                           },
+                           RegisterPrefixSuccessCallback(),
+                           [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+  Consumer consumer(*face2, groupName, uName, dbDir);
+  consumer.addDecryptionKey(uKeyName, fixtureUDKeyBuf);
+  consumer.enablePrefetch(time::minutes(5),
+                          [] (const ErrorCode&, const std::string&) { BOOST_CHECK(false); });
+
+  int finalCount = 0;
+  auto consumptionCallBack = [&] (const Data& data, const Buffer& result) {
+    finalCount++;
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                  DATA_CONTEN, DATA_CONTEN + sizeof(DATA_CONTEN));
+  };
+  auto errorCallBack = [] (const ErrorCode& code, const std::string& str) { BOOST_CHECK(false); };
+
+  consumer.consume(packets[0]->getName(), consumptionCallBack, errorCallBack);
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  BOOST_CHECK_EQUAL(finalCount, 1);
+  BOOST_CHECK_EQUAL(requestCounts[2], 1);
+  BOOST_CHECK_EQUAL(requestCounts[3], 0);
+
+  // advance to the prefetch time, 5 minutes before the next hour
+  time::seconds untilPrefetch = time::duration_cast<time::seconds>(
+    hourSlot1 - time::minutes(5) - time::system_clock::now());
+  advanceClocks(time::seconds(1), untilPrefetch.count());
+  for (int i = 0; i < 10; i++) {
+    do {
+      advanceClocks(time::milliseconds(10), 20);
+    } while (passPacket());
+  }
+  BOOST_CHECK_GT(nCKey1Interests, 0);
+  BOOST_CHECK_EQUAL(requestCounts[3], 0);
+
+  // the prefetch is retried until the C-KEY is created, without reporting an error
+  isCKey1Ready = true;
+  for (int i = 0; i < 60 && requestCounts[3] == 0; i++) {
+    advanceClocks(time::seconds(1), 1);
+    do {
+      advanceClocks(time::milliseconds(10), 20);
+    } while (passPacket());
+  }
+
+  // the C-KEY of the next hour has been prefetched
+  BOOST_CHECK_GT(nCKey1Interests, 1);
+  BOOST_CHECK_EQUAL(requestCounts[3], 1);
+
+  // content of the next hour is decrypted without retrieving the C-KEY again
+  consumer.consume(packets[1]->getName(), consumptionCallBack, errorCallBack);
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  BOOST_CHECK_EQUAL(finalCount, 2);
+  BOOST_CHECK_EQUAL(requestCounts[3], 1);
+  BOOST_CHECK_EQUAL(requestCounts[4], 1);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
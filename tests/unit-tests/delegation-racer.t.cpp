@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "delegation-racer.hpp"
+#include "unit-test-time-fixture.hpp"
+
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+class DelegationRacerFixture : public UnitTestTimeFixture
+{
+public:
+  DelegationRacerFixture()
+    : face1(util::makeDummyClientFace(io, {true, true}))
+    , face2(util::makeDummyClientFace(io, {true, true}))
+    , readInterestOffset1(0)
+    , readDataOffset1(0)
+    , readInterestOffset2(0)
+    , readDataOffset2(0)
+    , link("/LINK", {{10, Name("/a")}, {20, Name("/b")}, {30, Name("/c")}})
+  {
+    keyChain.sign(link);
+  }
+
+  bool
+  passPacket()
+  {
+    bool hasPassed = false;
+
+    checkFace(face1->sentInterests, readInterestOffset1, *face2, hasPassed);
+    checkFace(face1->sentDatas, readDataOffset1, *face2, hasPassed);
+    checkFace(face2->sentInterests, readInterestOffset2, *face1, hasPassed);
+    checkFace(face2->sentDatas, readDataOffset2, *face1, hasPassed);
+
+    return hasPassed;
+  }
+
+  template<typename Packet>
+  void
+  checkFace(std::vector<Packet>& receivedPackets,
+            size_t& readPacketOffset,
+            util::DummyClientFace& receiver,
+            bool& hasPassed)
+  {
+    while (receivedPackets.size() > readPacketOffset) {
+      receiver.receive(receivedPackets[readPacketOffset]);
+      readPacketOffset++;
+      hasPassed = true;
+    }
+  }
+
+public:
+  shared_ptr<util::DummyClientFace> face1;
+  shared_ptr<util::DummyClientFace> face2;
+
+  size_t readInterestOffset1;
+  size_t readDataOffset1;
+  size_t readInterestOffset2;
+  size_t readDataOffset2;
+
+  KeyChain keyChain;
+  Link link;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestDelegationRacer, DelegationRacerFixture)
+
+BOOST_AUTO_TEST_CASE(FirstDataWins)
+{
+  Name prefix("/prefix");
+  std::set<uint32_t> nonces;
+  size_t nReceivedInterests = 0;
+
+  // only the last delegation can reach the data
+  face2->setInterestFilter(prefix,
+         [&] (const InterestFilter&, const Interest& i) {
+            nReceivedInterests++;
+            nonces.insert(i.getNonce());
+            BOOST_REQUIRE(i.hasSelectedDelegation());
+            if (i.getSelectedDelegation() == 2) {
+              shared_ptr<Data> data = make_shared<Data>(i.getName());
+              keyChain.sign(*data);
+              face2->put(*data);
+            }
+         },
+         RegisterPrefixSuccessCallback(),
+         [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  DelegationRacer racer(*face1, 3);
+  Interest interest(Name(prefix).append("data"));
+  interest.setInterestLifetime(time::seconds(10));
+
+  size_t nData = 0;
+  size_t nFailures = 0;
+  racer.fetch(interest, link,
+              [&] (const Interest&, const Data& data) { nData++; },
+              [&] { nFailures++; });
+
+  do {
+    advanceClocks(time::milliseconds(10), 200);
+  } while (passPacket());
+
+  // all delegations are tried at once with different nonces, the first data wins
+  BOOST_CHECK_EQUAL(nReceivedInterests, 3);
+  BOOST_CHECK_EQUAL(nonces.size(), 3);
+  // the lifetime of each Interest is the RTO of its delegation, the initial one here
+  for (const Interest& sentInterest : face1->sentInterests)
+    BOOST_CHECK_EQUAL(sentInterest.getInterestLifetime(), time::seconds(1));
+  BOOST_CHECK_EQUAL(nData, 1);
+  BOOST_CHECK_EQUAL(nFailures, 0);
+
+  // the winning delegation is ranked first
+  std::vector<size_t> order = racer.rankDelegations(link);
+  BOOST_REQUIRE_EQUAL(order.size(), 3);
+  BOOST_CHECK_EQUAL(order[0], 2);
+  BOOST_CHECK_EQUAL(racer.getRttEstimator().getStatistics(Name("/c")).nSamples, 1);
+}
+
+BOOST_AUTO_TEST_CASE(AllDelegationsFail)
+{
+  Name prefix("/prefix");
+  size_t nReceivedInterests = 0;
+
+  face2->setInterestFilter(prefix,
+         [&] (const InterestFilter&, const Interest& i) {
+            nReceivedInterests++;
+         },
+         RegisterPrefixSuccessCallback(),
+         [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  DelegationRacer racer(*face1, 2);
+  Interest interest(Name(prefix).append("data"));
+  interest.setInterestLifetime(time::seconds(1));
+
+  size_t nData = 0;
+  size_t nFailures = 0;
+  racer.fetch(interest, link,
+              [&] (const Interest&, const Data& data) { nData++; },
+              [&] { nFailures++; });
+
+  do {
+    advanceClocks(time::milliseconds(10), 200);
+  } while (passPacket());
+
+  // two rounds: the two preferred delegations at first, then the last one
+  BOOST_CHECK_EQUAL(nReceivedInterests, 3);
+  BOOST_CHECK_EQUAL(nData, 0);
+  BOOST_CHECK_EQUAL(nFailures, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Cancel)
+{
+  DelegationRacer racer(*face1, 2);
+  Interest interest(Name("/prefix/data"));
+  interest.setInterestLifetime(time::seconds(1));
+
+  size_t nData = 0;
+  size_t nFailures = 0;
+  uint64_t raceId = racer.fetch(interest, link,
+                                [&] (const Interest&, const Data& data) { nData++; },
+                                [&] { nFailures++; });
+  advanceClocks(time::milliseconds(10), 1);
+  BOOST_CHECK_EQUAL(face1->sentInterests.size(), 2);
+
+  // a cancelled race sends no further round and reports nothing
+  racer.cancel(raceId);
+  racer.cancel(raceId);
+  advanceClocks(time::milliseconds(10), 300);
+
+  BOOST_CHECK_EQUAL(face1->sentInterests.size(), 2);
+  BOOST_CHECK_EQUAL(nData, 0);
+  BOOST_CHECK_EQUAL(nFailures, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Ranking)
+{
+  DelegationRacer racer(*face1);
+
+  // without measurements, delegations are ranked by preference
+  std::vector<size_t> order = racer.rankDelegations(link);
+  BOOST_REQUIRE_EQUAL(order.size(), 3);
+  BOOST_CHECK_EQUAL(order[0], 0);
+  BOOST_CHECK_EQUAL(order[1], 1);
+  BOOST_CHECK_EQUAL(order[2], 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
@@ -311,6 +311,32 @@ BOOST_AUTO_TEST_CASE(SetterGetter)
                                 encoded.wire(),
                                 encoded.wire() + encoded.size());
 }
+
+BOOST_AUTO_TEST_CASE(Compression)
+{
+  EncryptedContent content(tlv::AlgorithmRsaOaep, KeyLocator("/test/key/locator"),
+                           message, sizeof(message), iv, sizeof(iv));
+  BOOST_CHECK_EQUAL(content.getCompressionAlgorithm(), tlv::CompressionNone);
+
+  // no compression is not encoded, for compatibility with existing content
+  Block contentBlock(encrypted, sizeof(encrypted));
+  BOOST_CHECK(content.wireEncode() == contentBlock);
+
+  content.setCompressionAlgorithm(tlv::CompressionLz4);
+  Block encoded = content.wireEncode();
+  encoded.parse();
+  BOOST_CHECK_EQUAL(encoded.elements_size(), 5);
+  BOOST_CHECK_EQUAL(encoded.elements()[2].type(), tlv::CompressionAlgorithm);
+
+  EncryptedContent decoded(encoded);
+  BOOST_CHECK_EQUAL(decoded.getCompressionAlgorithm(), tlv::CompressionLz4);
+  BOOST_CHECK_EQUAL(decoded.getAlgorithmType(), tlv::AlgorithmRsaOaep);
+  BOOST_CHECK(decoded == content);
+
+  EncryptedContent uncompressed(contentBlock);
+  BOOST_CHECK_EQUAL(uncompressed.getCompressionAlgorithm(), tlv::CompressionNone);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "future.hpp"
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestFuture)
+
+BOOST_AUTO_TEST_CASE(ValueAndError)
+{
+  Promise<int> promise;
+  Future<int> future = promise.getFuture();
+  BOOST_CHECK_EQUAL(future.isReady(), false);
+  BOOST_CHECK_THROW(future.get(), Future<int>::Error);
+
+  int value = 0;
+  future.then([&] (const int& v) { value = v; },
+              [] (const ErrorCode&, const std::string&) { BOOST_CHECK(false); });
+  BOOST_CHECK(promise.setValue(42));
+  BOOST_CHECK_EQUAL(value, 42);
+  BOOST_CHECK_EQUAL(future.get(), 42);
+
+  // a promise is set only once
+  BOOST_CHECK_EQUAL(promise.setValue(1), false);
+  BOOST_CHECK_EQUAL(promise.setError(ErrorCode::Timeout, "timeout"), false);
+  BOOST_CHECK_EQUAL(future.get(), 42);
+
+  // continuation registered after completion is invoked immediately
+  Promise<int> failed;
+  BOOST_CHECK(failed.setError(ErrorCode::Timeout, "timeout"));
+  ErrorCode code = ErrorCode::Validation;
+  failed.getFuture().then([] (const int&) { BOOST_CHECK(false); },
+                          [&] (const ErrorCode& c, const std::string&) { code = c; });
+  BOOST_CHECK(code == ErrorCode::Timeout);
+  BOOST_CHECK_EQUAL(failed.getFuture().hasValue(), false);
+  BOOST_CHECK_EQUAL(failed.getFuture().getErrorMessage(), "timeout");
+  BOOST_CHECK_THROW(failed.getFuture().get(), Future<int>::Error);
+}
+
+BOOST_AUTO_TEST_CASE(WhenAll)
+{
+  std::vector<Promise<int>> promises(3);
+  std::vector<Future<int>> futures;
+  for (const auto& promise : promises)
+    futures.push_back(promise.getFuture());
+
+  std::vector<int> values;
+  whenAll(futures).then([&] (const std::vector<int>& v) { values = v; });
+
+  promises[2].setValue(3);
+  promises[0].setValue(1);
+  BOOST_CHECK(values.empty());
+  promises[1].setValue(2);
+  BOOST_REQUIRE_EQUAL(values.size(), 3);
+  BOOST_CHECK_EQUAL(values[0], 1);
+  BOOST_CHECK_EQUAL(values[1], 2);
+  BOOST_CHECK_EQUAL(values[2], 3);
+
+  // the first error fails the composed future
+  std::vector<Promise<int>> otherPromises(2);
+  Future<std::vector<int>> all = whenAll(std::vector<Future<int>>{otherPromises[0].getFuture(),
+                                                                  otherPromises[1].getFuture()});
+  otherPromises[1].setError(ErrorCode::DataRetrievalFailure, "/a");
+  BOOST_CHECK(all.isReady());
+  BOOST_CHECK(all.getErrorCode() == ErrorCode::DataRetrievalFailure);
+  otherPromises[0].setValue(1);
+  BOOST_CHECK_EQUAL(all.hasValue(), false);
+
+  BOOST_CHECK(whenAll(std::vector<Future<int>>()).hasValue());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
@@ -24,6 +24,7 @@
 #include "boost-test.hpp"
 
 #include <boost/filesystem.hpp>
+#include <fstream>
 
 namespace ndn {
 namespace gep {
@@ -256,6 +257,209 @@ BOOST_AUTO_TEST_CASE(DatabaseFunctions)
   BOOST_CHECK_NO_THROW(db.deleteSchedule("not-existing-time"));
 }
 
+BOOST_AUTO_TEST_CASE(Visitors)
+{
+  std::string dbDir = tmpPath.c_str();
+  GroupManagerDB db(dbDir + "/test.db");
+
+  Block scheduleBlock(SCHEDULE, sizeof(SCHEDULE));
+  Schedule schedule(scheduleBlock);
+  Buffer keyBuf1(10, 0x01);
+  Buffer keyBuf2(20, 0x02);
+
+  db.addSchedule("work-time", schedule);
+  db.addSchedule("rest-time", schedule);
+  db.addMember("work-time", Name("/ndn/BoyA/ksk-123"), keyBuf1);
+  db.addMember("rest-time", Name("/ndn/BoyB/ksk-123"), keyBuf2);
+  db.addMember("rest-time", Name("/ndn/GirlC/ksk-123"), keyBuf1);
+
+  std::set<std::string> scheduleNames;
+  db.visitSchedules([&] (const std::string& name, const Block& block) {
+      BOOST_CHECK(block == scheduleBlock);
+      scheduleNames.insert(name);
+      return true;
+    });
+  BOOST_CHECK(scheduleNames == std::set<std::string>({"work-time", "rest-time"}));
+
+  std::map<Name, Buffer> members;
+  db.visitScheduleMembers("rest-time",
+                          [&] (const Name& keyName, const uint8_t* key, size_t keySize) {
+                            members[keyName] = Buffer(key, keySize);
+                            return true;
+                          });
+  BOOST_REQUIRE_EQUAL(members.size(), 2);
+  BOOST_CHECK(members[Name("/ndn/BoyB/ksk-123")] == keyBuf2);
+  BOOST_CHECK(members[Name("/ndn/GirlC/ksk-123")] == keyBuf1);
+  BOOST_CHECK(db.getScheduleMembers("rest-time") == members);
+
+  size_t nMembers = 0;
+  db.visitMembers([&] (const Name&, const uint8_t*, size_t) {
+      nMembers++;
+      return true;
+    });
+  BOOST_CHECK_EQUAL(nMembers, 3);
+
+  // the visitor stops the iteration by returning false
+  nMembers = 0;
+  db.visitMembers([&] (const Name&, const uint8_t*, size_t) {
+      nMembers++;
+      return false;
+    });
+  BOOST_CHECK_EQUAL(nMembers, 1);
+
+  db.visitScheduleMembers("sleep-time", [] (const Name&, const uint8_t*, size_t) {
+      BOOST_ERROR("no member is expected");
+      return true;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(Generation)
+{
+  std::string dbDir = tmpPath.c_str();
+  GroupManagerDB db(dbDir + "/test.db");
+  Schedule schedule(Block(SCHEDULE, sizeof(SCHEDULE)));
+  Buffer keyBuf(10, 0x01);
+
+  uint64_t generation = db.getGeneration();
+  BOOST_CHECK_EQUAL(db.getGeneration(), generation);
+
+  // every change of a schedule or a member starts a new generation
+  auto checkChanged = [&] {
+    BOOST_CHECK_GT(db.getGeneration(), generation);
+    generation = db.getGeneration();
+  };
+  db.addSchedule("work-time", schedule);
+  checkChanged();
+  db.updateSchedule("work-time", schedule);
+  checkChanged();
+  db.addSchedule("rest-time", schedule);
+  checkChanged();
+  db.addMember("work-time", Name("/ndn/BoyA/ksk-123"), keyBuf);
+  checkChanged();
+  db.updateMemberSchedule(Name("/ndn/BoyA"), "rest-time");
+  checkChanged();
+  db.deleteMember(Name("/ndn/BoyA"));
+  checkChanged();
+  db.deleteSchedule("work-time");
+  checkChanged();
+
+  // as does a change committed through another connection
+  GroupManagerDB(dbDir + "/test.db").addSchedule("other-time", schedule);
+  checkChanged();
+
+  // reads do not
+  db.hasSchedule("other-time");
+  db.listAllMembers();
+  BOOST_CHECK_EQUAL(db.getGeneration(), generation);
+}
+
+BOOST_AUTO_TEST_CASE(GroupKeys)
+{
+  std::string dbDir = tmpPath.c_str();
+  GroupManagerDB db(dbDir + "/test.db");
+  Name eKeyName("/Alice/READ/data_type/E-KEY/20150825T090000/20150825T100000");
+  TimeStamp endTime(boost::posix_time::from_iso_string("20150825T100000"));
+  Buffer priKey(10, 0x01), pubKey(10, 0x02), otherKey(10, 0x03), result1, result2;
+
+  // the key pair added first for a generation is kept
+  db.addGroupKey(eKeyName, 1, endTime, priKey, pubKey);
+  db.addGroupKey(eKeyName, 1, endTime, otherKey, otherKey);
+  BOOST_REQUIRE(db.getGroupKey(eKeyName, 1, result1, result2));
+  BOOST_CHECK(result1 == priKey);
+  BOOST_CHECK(result2 == pubKey);
+  BOOST_CHECK_EQUAL(db.getGroupKey(eKeyName, 2, result1, result2), false);
+  db.addGroupKey(eKeyName, 2, endTime, otherKey, otherKey);
+
+  // key pairs of older generations, then of expired intervals, are pruned
+  db.pruneGroupKeys(endTime - boost::posix_time::hours(1), 2);
+  BOOST_CHECK_EQUAL(db.getGroupKey(eKeyName, 1, result1, result2), false);
+  BOOST_CHECK(db.getGroupKey(eKeyName, 2, result1, result2));
+  db.pruneGroupKeys(endTime, 2);
+  BOOST_CHECK_EQUAL(db.getGroupKey(eKeyName, 2, result1, result2), false);
+}
+
+BOOST_AUTO_TEST_CASE(Snapshot)
+{
+  std::string dbDir = tmpPath.c_str();
+  GroupManagerDB db(dbDir + "/test.db");
+
+  Block scheduleBlock(SCHEDULE, sizeof(SCHEDULE));
+  Schedule schedule(scheduleBlock);
+  Schedule otherSchedule(scheduleBlock);
+  otherSchedule.addWhiteInterval(RepetitiveInterval(Block(REPETITIVE_INTERVAL,
+                                                          sizeof(REPETITIVE_INTERVAL))));
+  Buffer keyBuf1(10, 0x01);
+  Buffer keyBuf2(20, 0x02);
+
+  db.addSchedule("work-time", schedule);
+  db.addSchedule("rest-time", otherSchedule);
+  db.addSchedule("empty-time", schedule);
+  db.addMember("work-time", Name("/ndn/BoyA/ksk-123"), keyBuf1);
+  db.addMember("rest-time", Name("/ndn/BoyB/ksk-123"), keyBuf2);
+  db.addMember("rest-time", Name("/ndn/GirlC/ksk-123"), keyBuf1);
+  db.deleteSchedule("empty-time");
+
+  std::string snapshotPath = dbDir + "/test.snapshot";
+  db.exportSnapshot(snapshotPath);
+  BOOST_CHECK_EQUAL(boost::filesystem::exists(snapshotPath + ".tmp"), false);
+
+  // the snapshot replaces the content of another database
+  GroupManagerDB replica(dbDir + "/replica.db");
+  replica.addSchedule("old-time", schedule);
+  replica.addMember("old-time", Name("/ndn/Old/ksk-123"), keyBuf1);
+  uint64_t generation = replica.getGeneration();
+  replica.importSnapshot(snapshotPath);
+  // the whole import increases the generation once
+  BOOST_CHECK_EQUAL(replica.getGeneration(), generation + 1);
+
+  BOOST_CHECK_EQUAL(replica.hasSchedule("old-time"), false);
+  BOOST_CHECK_EQUAL(replica.hasMember(Name("/ndn/Old")), false);
+  BOOST_CHECK_EQUAL(replica.listAllScheduleNames().size(), 2);
+  BOOST_CHECK(replica.getSchedule("work-time").wireEncode() == schedule.wireEncode());
+  BOOST_CHECK(replica.getSchedule("rest-time").wireEncode() == otherSchedule.wireEncode());
+  BOOST_CHECK_EQUAL(replica.listAllMembers().size(), 3);
+  BOOST_CHECK_EQUAL(replica.getMemberSchedule(Name("/ndn/BoyA")), "work-time");
+  BOOST_CHECK_EQUAL(replica.getMemberSchedule(Name("/ndn/GirlC")), "rest-time");
+
+  std::map<Name, Buffer> members = replica.getScheduleMembers("rest-time");
+  BOOST_REQUIRE_EQUAL(members.size(), 2);
+  BOOST_CHECK(members[Name("/ndn/BoyB/ksk-123")] == keyBuf2);
+  BOOST_CHECK(members[Name("/ndn/GirlC/ksk-123")] == keyBuf1);
+
+  // a malformed snapshot leaves the database unchanged
+  std::string corruptPath = dbDir + "/corrupt.snapshot";
+  {
+    std::ifstream is(snapshotPath, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    std::ofstream os(corruptPath, std::ios::binary);
+    os << content.substr(0, content.size() - 5);
+  }
+  BOOST_CHECK_THROW(db.importSnapshot(corruptPath), GroupManagerDB::Error);
+  BOOST_CHECK_EQUAL(db.listAllScheduleNames().size(), 2);
+  BOOST_CHECK_EQUAL(db.listAllMembers().size(), 3);
+
+  {
+    std::ofstream os(corruptPath, std::ios::binary);
+    os << "GEPT";
+  }
+  BOOST_CHECK_THROW(db.importSnapshot(corruptPath), GroupManagerDB::Error);
+  BOOST_CHECK_THROW(db.importSnapshot(dbDir + "/not-existing.snapshot"), GroupManagerDB::Error);
+
+  // a failed export keeps the previous snapshot
+  boost::filesystem::create_directory(snapshotPath + ".tmp");
+  BOOST_CHECK_THROW(GroupManagerDB(dbDir + "/empty.db").exportSnapshot(snapshotPath),
+                    GroupManagerDB::Error);
+  boost::filesystem::remove(snapshotPath + ".tmp");
+  replica.importSnapshot(snapshotPath);
+  BOOST_CHECK_EQUAL(replica.listAllScheduleNames().size(), 2);
+  BOOST_CHECK_EQUAL(replica.listAllMembers().size(), 3);
+
+  // the generation triggers are restored after the import
+  generation = replica.getGeneration();
+  replica.addMember("work-time", Name("/ndn/New/ksk-123"), keyBuf1);
+  BOOST_CHECK_EQUAL(replica.getGeneration(), generation + 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -266,6 +266,48 @@ BOOST_AUTO_TEST_CASE(CalculateInterval)
   BOOST_CHECK_EQUAL(to_iso_string(result.getEndTime()), "20150827T060000");
 }
 
+BOOST_AUTO_TEST_CASE(CalculateIntervalCache)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/manager-interval-cache-test.db";
+
+  GroupManager manager(Name("Alice"), Name("data_type"), dbDir, 1024, 1);
+  setManager(manager);
+
+  std::map<Name, Buffer> memberKeys;
+  Interval result = manager.calculateInterval(from_iso_string("20150825T093000"), memberKeys);
+  BOOST_CHECK_EQUAL(to_iso_string(result.getStartTime()), "20150825T090000");
+  BOOST_CHECK_EQUAL(memberKeys.size(), 3);
+
+  // another timeslot in the same interval gets the same result
+  result = manager.calculateInterval(from_iso_string("20150825T095959"), memberKeys);
+  BOOST_CHECK_EQUAL(to_iso_string(result.getStartTime()), "20150825T090000");
+  BOOST_CHECK_EQUAL(to_iso_string(result.getEndTime()), "20150825T100000");
+  BOOST_CHECK_EQUAL(memberKeys.size(), 3);
+
+  // a change through the group manager is seen right away
+  manager.removeMember(Name("/ndn/memberC"));
+  result = manager.calculateInterval(from_iso_string("20150825T093000"), memberKeys);
+  BOOST_CHECK_EQUAL(memberKeys.size(), 2);
+
+  // so is a change through another connection to the database
+  Schedule schedule;
+  schedule.addWhiteInterval(RepetitiveInterval(from_iso_string("20150825T000000"),
+                                               from_iso_string("20150827T000000"),
+                                               9, 10, 1, RepetitiveInterval::RepeatUnit::DAY));
+  {
+    GroupManagerDB db(dbDir);
+    uint64_t generation = db.getGeneration();
+    db.addSchedule("schedule3", schedule);
+    BOOST_CHECK_GT(db.getGeneration(), generation);
+    db.addMember("schedule3", Name("/ndn/memberD/ksk-123"), encryptKeyBuf);
+  }
+  result = manager.calculateInterval(from_iso_string("20150825T093000"), memberKeys);
+  BOOST_CHECK_EQUAL(to_iso_string(result.getStartTime()), "20150825T090000");
+  BOOST_CHECK_EQUAL(memberKeys.size(), 3);
+  BOOST_CHECK(memberKeys.count(Name("/ndn/memberD/ksk-123")) > 0);
+}
+
 BOOST_AUTO_TEST_CASE(GetGroupKey)
 {
   // create the group manager database
@@ -358,6 +400,322 @@ BOOST_AUTO_TEST_CASE(GetGroupKey)
   BOOST_CHECK_EQUAL(manager.getGroupKey(tp3).size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(GetGroupKeyBundle)
+{
+  // create the group manager database
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/manager-group-key-bundle-test.db";
+
+  // create group manager
+  GroupManager manager(Name("Alice"), Name("data_type"), dbDir, 1024, 1);
+  setManager(manager);
+
+  // get the group keys of one day
+  std::list<Data> result = manager.getGroupKeyBundle(from_iso_string("20150825T000000"),
+                                                     from_iso_string("20150826T000000"));
+
+  // E-KEYs come first, followed by one bundle per member
+  std::map<Name, Buffer> eKeys;
+  std::map<std::string, Block> bundles;
+  for (const Data& data : result) {
+    const Name& name = data.getName();
+    if (name.get(3) == NAME_COMPONENT_E_KEY) {
+      BOOST_CHECK(bundles.empty());
+      eKeys[name.getSubName(4)] = Buffer(data.getContent().value(), data.getContent().value_size());
+    }
+    else {
+      BOOST_CHECK_EQUAL(name.getPrefix(7).toUri(),
+                        "/Alice/READ/data_type/D-KEY-BUNDLE/20150825T000000/20150826T000000/FOR");
+      // a short bundle fits in one segment
+      BOOST_CHECK(name.get(-1) == name::Component::fromSegment(0));
+      BOOST_CHECK(data.getFinalBlockId() == name::Component::fromSegment(0));
+      bundles[name.get(8).toUri()] = data.getContent();
+    }
+  }
+  BOOST_CHECK(eKeys.size() > 1);
+  BOOST_CHECK(eKeys.find(Name("/20150825T090000/20150825T100000")) != eKeys.end());
+  BOOST_REQUIRE_EQUAL(bundles.size(), 3);
+  BOOST_CHECK(bundles.find("memberA") != bundles.end());
+  BOOST_CHECK(bundles.find("memberB") != bundles.end());
+  BOOST_REQUIRE(bundles.find("memberC") != bundles.end());
+
+  // decrypt the bundle of member C
+  Block dataContent = bundles["memberC"];
+  dataContent.parse();
+  BOOST_REQUIRE_EQUAL(dataContent.elements_size(), 2);
+
+  EncryptedContent encryptedNonce(dataContent.elements()[0]);
+  algo::EncryptParams decryptParams(tlv::AlgorithmRsaOaep);
+  const Buffer& bufferNonce = encryptedNonce.getPayload();
+  Buffer nonce = algo::Rsa::decrypt(decryptKeyBuf.buf(), decryptKeyBuf.size(),
+                                    bufferNonce.buf(), bufferNonce.size(), decryptParams);
+
+  EncryptedContent encryptedPayload(dataContent.elements()[1]);
+  decryptParams.setAlgorithmType(tlv::AlgorithmAesCbc);
+  decryptParams.setIV(encryptedPayload.getInitialVector().buf(),
+                      encryptedPayload.getInitialVector().size());
+  const Buffer& bufferPayload = encryptedPayload.getPayload();
+  Buffer bundleBuf = algo::Aes::decrypt(nonce.buf(), nonce.size(),
+                                        bufferPayload.buf(), bufferPayload.size(),
+                                        decryptParams);
+
+  // every D-KEY in the bundle matches the E-KEY of its interval
+  Block bundle(bundleBuf.buf(), bundleBuf.size());
+  BOOST_CHECK_EQUAL(bundle.type(), tlv::DKeyBundle);
+  bundle.parse();
+  BOOST_CHECK(bundle.elements_size() > 0);
+
+  bool hasSharedInterval = false;
+  for (const Block& entry : bundle.elements()) {
+    BOOST_CHECK_EQUAL(entry.type(), tlv::DKeyEntry);
+    entry.parse();
+    Name dKeyName(entry.get(tlv::Name));
+    BOOST_CHECK_EQUAL(dKeyName.getPrefix(4).toUri(), "/Alice/READ/data_type/D-KEY");
+    if (dKeyName.getSubName(4) == Name("/20150825T090000/20150825T100000"))
+      hasSharedInterval = true;
+
+    auto eKey = eKeys.find(dKeyName.getSubName(4));
+    BOOST_REQUIRE(eKey != eKeys.end());
+    const Block& dKeyBits = entry.get(tlv::DKeyBits);
+    Buffer derivedEKey =
+      algo::Rsa::deriveEncryptKey(Buffer(dKeyBits.value(), dKeyBits.value_size())).getKeyBits();
+    BOOST_CHECK_EQUAL_COLLECTIONS(derivedEKey.begin(), derivedEKey.end(),
+                                  eKey->second.begin(), eKey->second.end());
+  }
+  BOOST_CHECK(hasSharedInterval);
+
+  // no bundle when nobody can access the data
+  BOOST_CHECK_EQUAL(manager.getGroupKeyBundle(from_iso_string("20150826T000000"),
+                                              from_iso_string("20150826T050000")).size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GetGroupKeyBundleSegments)
+{
+  // create the group manager database
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/manager-group-key-bundle-segments-test.db";
+
+  // 2048-bit group keys of one-hour intervals, every other hour of the day
+  GroupManager manager(Name("Alice"), Name("data_type"), dbDir, 2048, 1);
+  Schedule schedule;
+  for (int hour = 0; hour < 24; hour += 2)
+    schedule.addWhiteInterval(RepetitiveInterval(from_iso_string("20150825T000000"),
+                                                 from_iso_string("20150825T000000"),
+                                                 hour, hour + 1));
+  manager.addSchedule("schedule", schedule);
+  Data memberA(cert.wireEncode());
+  memberA.setName(Name("/ndn/memberA/KEY/ksk-123/ID-CERT/123"));
+  manager.addMember("schedule", memberA);
+
+  std::list<Data> result = manager.getGroupKeyBundle(from_iso_string("20150825T000000"),
+                                                     from_iso_string("20150826T000000"));
+
+  size_t nEKeys = 0;
+  size_t nDKeys = 0;
+  std::set<uint64_t> segmentNos;
+  for (const Data& data : result) {
+    // every packet, the segments of the bundle included, can be put on a face
+    BOOST_CHECK_LE(data.wireEncode().size(), MAX_NDN_PACKET_SIZE);
+
+    const Name& name = data.getName();
+    if (name.get(3) == NAME_COMPONENT_E_KEY) {
+      nEKeys++;
+      continue;
+    }
+
+    BOOST_REQUIRE(name.get(-1).isSegment());
+    segmentNos.insert(name.get(-1).toSegment());
+    BOOST_REQUIRE(!data.getFinalBlockId().empty());
+
+    // each segment decrypts on its own
+    Block dataContent = data.getContent();
+    dataContent.parse();
+    BOOST_REQUIRE_EQUAL(dataContent.elements_size(), 2);
+
+    EncryptedContent encryptedNonce(dataContent.elements()[0]);
+    algo::EncryptParams decryptParams(tlv::AlgorithmRsaOaep);
+    const Buffer& bufferNonce = encryptedNonce.getPayload();
+    Buffer nonce = algo::Rsa::decrypt(decryptKeyBuf.buf(), decryptKeyBuf.size(),
+                                      bufferNonce.buf(), bufferNonce.size(), decryptParams);
+
+    EncryptedContent encryptedPayload(dataContent.elements()[1]);
+    decryptParams.setAlgorithmType(tlv::AlgorithmAesCbc);
+    decryptParams.setIV(encryptedPayload.getInitialVector().buf(),
+                        encryptedPayload.getInitialVector().size());
+    const Buffer& bufferPayload = encryptedPayload.getPayload();
+    Buffer bundleBuf = algo::Aes::decrypt(nonce.buf(), nonce.size(),
+                                          bufferPayload.buf(), bufferPayload.size(),
+                                          decryptParams);
+
+    Block bundle(bundleBuf.buf(), bundleBuf.size());
+    BOOST_CHECK_EQUAL(bundle.type(), tlv::DKeyBundle);
+    bundle.parse();
+    BOOST_CHECK(bundle.elements_size() > 0);
+    nDKeys += bundle.elements_size();
+  }
+
+  // the bundle of a day does not fit in one packet, and its segments cover all the D-KEYs
+  BOOST_CHECK_EQUAL(nEKeys, 12);
+  BOOST_CHECK_EQUAL(nDKeys, 12);
+  BOOST_REQUIRE(segmentNos.size() > 1);
+  BOOST_CHECK_EQUAL(*segmentNos.rbegin(), segmentNos.size() - 1);
+  BOOST_CHECK(result.back().getFinalBlockId() ==
+              name::Component::fromSegment(segmentNos.size() - 1));
+}
+
+BOOST_AUTO_TEST_CASE(GetGroupKeys)
+{
+  // create the group manager database
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/manager-group-keys-test.db";
+
+  // create group manager serving two data types
+  GroupManager manager(Name("Alice"), Name("data_type"), dbDir, 1024, 1);
+  manager.addDataType(Name("other_type"));
+  manager.addDataType(Name("other_type"));
+  setManager(manager);
+
+  TimeStamp tp1(from_iso_string("20150825T093000"));
+  std::map<Name, std::list<Data>> result = manager.getGroupKeys(tp1);
+  BOOST_REQUIRE_EQUAL(result.size(), 2);
+
+  std::vector<Block> encryptedNonces;
+  for (const auto& entry : result) {
+    const std::list<Data>& groupKey = entry.second;
+    BOOST_REQUIRE_EQUAL(groupKey.size(), 4);
+
+    Name dataNamespace("/Alice/READ");
+    dataNamespace.append(entry.first);
+
+    auto dataIterator = groupKey.begin();
+    BOOST_CHECK_EQUAL(dataIterator->getName(),
+                      Name(dataNamespace).append("E-KEY")
+                        .append("20150825T090000").append("20150825T100000"));
+    Buffer groupEKey(dataIterator->getContent().value(), dataIterator->getContent().value_size());
+
+    // D-KEY of member A
+    dataIterator++;
+    BOOST_CHECK_EQUAL(dataIterator->getName(),
+                      Name(dataNamespace).append("D-KEY")
+                        .append("20150825T090000").append("20150825T100000")
+                        .append("FOR").append(Name("/ndn/memberA/ksk-123")));
+
+    Block dataContent = dataIterator->getContent();
+    dataContent.parse();
+    BOOST_REQUIRE_EQUAL(dataContent.elements_size(), 2);
+    encryptedNonces.push_back(dataContent.elements()[0]);
+
+    EncryptedContent encryptedNonce(dataContent.elements()[0]);
+    algo::EncryptParams decryptParams(tlv::AlgorithmRsaOaep);
+    const Buffer& bufferNonce = encryptedNonce.getPayload();
+    Buffer nonce = algo::Rsa::decrypt(decryptKeyBuf.buf(), decryptKeyBuf.size(),
+                                      bufferNonce.buf(), bufferNonce.size(), decryptParams);
+
+    EncryptedContent encryptedPayload(dataContent.elements()[1]);
+    decryptParams.setAlgorithmType(tlv::AlgorithmAesCbc);
+    decryptParams.setIV(encryptedPayload.getInitialVector().buf(),
+                        encryptedPayload.getInitialVector().size());
+    const Buffer& bufferPayload = encryptedPayload.getPayload();
+    Buffer groupDKey = algo::Aes::decrypt(nonce.buf(), nonce.size(),
+                                          bufferPayload.buf(), bufferPayload.size(),
+                                          decryptParams);
+
+    // the D-KEY matches the E-KEY of the data type
+    Buffer derivedGroupEKey = algo::Rsa::deriveEncryptKey(groupDKey).getKeyBits();
+    BOOST_CHECK_EQUAL_COLLECTIONS(groupEKey.begin(), groupEKey.end(),
+                                  derivedGroupEKey.begin(), derivedGroupEKey.end());
+  }
+
+  // the encrypted nonce of a member is shared by the data types
+  BOOST_CHECK(encryptedNonces[0] == encryptedNonces[1]);
+
+  // invalid time stamp to get group keys
+  TimeStamp tp2(from_iso_string("20150826T083000"));
+  BOOST_CHECK_EQUAL(manager.getGroupKeys(tp2).size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Shards)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/manager-shards-test.db";
+
+  // two shards sharing the database
+  GroupManager shard0(Name("Alice"), Name("data_type"), dbDir, 1024, 1);
+  GroupManager shard1(Name("Alice"), Name("data_type"), dbDir, 1024, 1);
+  setManager(shard0);
+  shard0.setShard(0, 2);
+  shard1.setShard(1, 2);
+
+  TimeStamp tp1(from_iso_string("20150825T093000"));
+  std::list<Data> result0 = shard0.getGroupKey(tp1);
+  std::list<Data> result1 = shard1.getGroupKey(tp1);
+
+  // both shards create the E-KEY of the same group key
+  BOOST_REQUIRE_GE(result0.size(), 1);
+  BOOST_REQUIRE_GE(result1.size(), 1);
+  BOOST_CHECK_EQUAL(result0.front().getName(), result1.front().getName());
+  BOOST_CHECK(result0.front().getContent() == result1.front().getContent());
+
+  // each member gets its D-KEY from one shard only
+  std::set<Name> dKeyNames;
+  for (auto it = ++result0.begin(); it != result0.end(); it++)
+    dKeyNames.insert(it->getName());
+  for (auto it = ++result1.begin(); it != result1.end(); it++)
+    dKeyNames.insert(it->getName());
+  BOOST_CHECK_EQUAL(result0.size() + result1.size(), 5);
+  BOOST_CHECK_EQUAL(dKeyNames.size(), 3);
+
+  // the group key of the interval is kept
+  std::list<Data> again = shard0.getGroupKey(tp1);
+  BOOST_CHECK(again.front().getContent() == result0.front().getContent());
+
+  // a shard behind the other one still gets the group key agreed on for an earlier timeslot
+  TimeStamp tp2(from_iso_string("20150825T113000"));
+  std::list<Data> later1 = shard1.getGroupKey(tp2);
+  BOOST_REQUIRE_GE(later1.size(), 1);
+  BOOST_CHECK_NE(later1.front().getName(), result0.front().getName());
+  std::list<Data> behind0 = shard0.getGroupKey(tp1);
+  BOOST_CHECK(behind0.front().getContent() == result0.front().getContent());
+
+  // a removed member does not get the group key again, nor the new one
+  shard1.removeMember(Name("/ndn/memberA"));
+  std::list<Data> afterRemoval0 = shard0.getGroupKey(tp1);
+  std::list<Data> afterRemoval1 = shard1.getGroupKey(tp1);
+  BOOST_CHECK_EQUAL(afterRemoval0.front().getName(), result0.front().getName());
+  BOOST_CHECK(afterRemoval0.front().getContent() != result0.front().getContent());
+  BOOST_CHECK(afterRemoval0.front().getContent() == afterRemoval1.front().getContent());
+  BOOST_CHECK_EQUAL(afterRemoval0.size() + afterRemoval1.size(), 4);
+
+  // a single shard creates all the D-KEYs
+  shard0.setShard(0, 1);
+  BOOST_CHECK_EQUAL(shard0.getGroupKey(tp1).size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryTimestampNaming)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/manager-binary-naming-test.db";
+
+  GroupManager manager(Name("Alice"), Name("data_type"), dbDir, 1024, 1);
+  setManager(manager);
+  manager.setTimestampNaming(TimestampNaming::Binary);
+
+  TimeStamp tp1(from_iso_string("20150825T093000"));
+  std::list<Data> result = manager.getGroupKey(tp1);
+  BOOST_REQUIRE_EQUAL(result.size(), 4);
+
+  Name eKeyName("/Alice/READ/data_type/E-KEY");
+  eKeyName.appendTimestamp(time::fromIsoString("20150825T090000"))
+          .appendTimestamp(time::fromIsoString("20150825T100000"));
+  BOOST_CHECK_EQUAL(result.front().getName(), eKeyName);
+  BOOST_CHECK(decodeTimestamp(result.front().getName().get(-2)) ==
+              time::fromIsoString("20150825T090000"));
+
+  Name dKeyName("/Alice/READ/data_type/D-KEY");
+  dKeyName.append(eKeyName.getSubName(-2));
+  BOOST_CHECK(dKeyName.isPrefixOf((++result.begin())->getName()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace test
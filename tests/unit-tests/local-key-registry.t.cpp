@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "local-key-registry.hpp"
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestLocalKeyRegistry)
+
+BOOST_AUTO_TEST_CASE(KeyLookup)
+{
+  LocalKeyRegistry registry;
+  Buffer eKeyBits1(10), dKeyBits1(20), eKeyBits2(30), dKeyBits2(40), cKeyBits(16);
+  eKeyBits1[0] = 1;
+  eKeyBits2[0] = 2;
+
+  Name eKeyName1("/Alice/READ/data_type/E-KEY/20150825T090000/20150825T100000");
+  Name eKeyName2("/Alice/READ/data_type/E-KEY/20150825T100000/20150825T120000");
+  Name cKeyName("/Alice/SAMPLE/data_type/C-KEY/20150825T090000");
+  registry.addGroupKey(eKeyName1, eKeyBits1, dKeyBits1,
+                       {Name("/ndn/memberA/ksk-123"), Name("/ndn/memberB/ksk-123")});
+  registry.addGroupKey(eKeyName2, eKeyBits2, dKeyBits2, {Name("/ndn/memberC/ksk-123")});
+  registry.addContentKey(cKeyName, eKeyName1, cKeyBits);
+
+  // E-KEY covering the timeslot
+  Name eKeyName;
+  Buffer keyBits;
+  Name nodeName("/Alice/READ/data_type/E-KEY");
+  BOOST_CHECK(registry.getEKey(nodeName, time::fromIsoString("20150825T093000"),
+                               eKeyName, keyBits));
+  BOOST_CHECK_EQUAL(eKeyName, eKeyName1);
+  BOOST_CHECK(keyBits == eKeyBits1);
+  BOOST_CHECK(registry.getEKey(nodeName, time::fromIsoString("20150825T100000"),
+                               eKeyName, keyBits));
+  BOOST_CHECK_EQUAL(eKeyName, eKeyName2);
+  BOOST_CHECK_EQUAL(registry.getEKey(nodeName, time::fromIsoString("20150825T120000"),
+                                     eKeyName, keyBits), false);
+  BOOST_CHECK_EQUAL(registry.getEKey(Name("/Alice/READ/E-KEY"),
+                                     time::fromIsoString("20150825T093000"),
+                                     eKeyName, keyBits), false);
+
+  // D-KEY only for members
+  Name dKeyName1("/Alice/READ/data_type/D-KEY/20150825T090000/20150825T100000");
+  BOOST_CHECK(registry.getDKey(dKeyName1, Name("/ndn/memberA"), keyBits));
+  BOOST_CHECK(keyBits == dKeyBits1);
+  BOOST_CHECK_EQUAL(registry.getDKey(dKeyName1, Name("/ndn/memberC"), keyBits), false);
+  // a prefix of the identity of a member is not a member
+  BOOST_CHECK_EQUAL(registry.getDKey(dKeyName1, Name("/ndn"), keyBits), false);
+  BOOST_CHECK_EQUAL(registry.getDKey(dKeyName1, Name("/"), keyBits), false);
+  BOOST_CHECK_EQUAL(registry.getCKey(cKeyName, Name("/ndn"), keyBits), false);
+
+  // C-KEY only for members of the group it is encrypted for
+  BOOST_CHECK(registry.getCKey(cKeyName, Name("/ndn/memberB"), keyBits));
+  BOOST_CHECK(keyBits == cKeyBits);
+  BOOST_CHECK_EQUAL(registry.getCKey(cKeyName, Name("/ndn/memberC"), keyBits), false);
+  registry.addContentKey(cKeyName, eKeyName2, cKeyBits);
+  BOOST_CHECK(registry.getCKey(cKeyName, Name("/ndn/memberC"), keyBits));
+
+  // the group keys of expired intervals are removed, then the C-KEYs left without E-KEY
+  registry.removeBefore(time::fromIsoString("20150825T100000"));
+  BOOST_CHECK_EQUAL(registry.getDKey(dKeyName1, Name("/ndn/memberA"), keyBits), false);
+  BOOST_CHECK(registry.getCKey(cKeyName, Name("/ndn/memberC"), keyBits));
+  BOOST_CHECK_EQUAL(registry.getCKey(cKeyName, Name("/ndn/memberB"), keyBits), false);
+  registry.removeBefore(time::fromIsoString("20150825T120000"));
+  BOOST_CHECK_EQUAL(registry.getCKey(cKeyName, Name("/ndn/memberC"), keyBits), false);
+  BOOST_CHECK_EQUAL(registry.getEKey(nodeName, time::fromIsoString("20150825T100000"),
+                                     eKeyName, keyBits), false);
+
+  registry.addGroupKey(eKeyName1, eKeyBits1, dKeyBits1, {Name("/ndn/memberA/ksk-123")});
+  registry.addContentKey(cKeyName, eKeyName1, cKeyBits);
+  registry.clear();
+  BOOST_CHECK_EQUAL(registry.getCKey(cKeyName, Name("/ndn/memberB"), keyBits), false);
+  BOOST_CHECK_EQUAL(registry.getDKey(dKeyName1, Name("/ndn/memberA"), keyBits), false);
+}
+
+BOOST_AUTO_TEST_CASE(RemoveContentKeysBefore)
+{
+  LocalKeyRegistry registry;
+  Buffer eKeyBits(10), dKeyBits(20), cKeyBits(16);
+
+  Name eKeyName("/Alice/READ/data_type/E-KEY/20150825T090000/20150825T120000");
+  Name cKeyName1("/Alice/SAMPLE/data_type/C-KEY/20150825T090000");
+  Name cKeyName2("/Alice/SAMPLE/data_type/C-KEY/20150825T100000");
+  Name otherCKeyName("/Bob/SAMPLE/data_type/C-KEY/20150825T090000");
+  registry.addGroupKey(eKeyName, eKeyBits, dKeyBits, {Name("/ndn/memberA/ksk-123")});
+  registry.addContentKey(cKeyName1, eKeyName, cKeyBits);
+  registry.addContentKey(cKeyName2, eKeyName, cKeyBits);
+  registry.addContentKey(otherCKeyName, eKeyName, cKeyBits);
+
+  // only the C-KEYs of the producer are pruned, the group keys and other C-KEYs are kept
+  registry.removeContentKeysBefore(Name("/Alice/SAMPLE/data_type/C-KEY"),
+                                   time::fromIsoString("20150825T100000"));
+  Buffer keyBits;
+  BOOST_CHECK_EQUAL(registry.getCKey(cKeyName1, Name("/ndn/memberA"), keyBits), false);
+  BOOST_CHECK(registry.getCKey(cKeyName2, Name("/ndn/memberA"), keyBits));
+  BOOST_CHECK(registry.getCKey(otherCKeyName, Name("/ndn/memberA"), keyBits));
+  Name dKeyName("/Alice/READ/data_type/D-KEY/20150825T090000/20150825T120000");
+  BOOST_CHECK(registry.getDKey(dKeyName, Name("/ndn/memberA"), keyBits));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
@@ -108,6 +108,96 @@ BOOST_AUTO_TEST_CASE(DatabaseFunctions)
   BOOST_CHECK_NO_THROW(db.deleteContentKey(point4));
 }
 
+BOOST_AUTO_TEST_CASE(EKeyFunctions)
+{
+  // construction
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+  ProducerDB db(dbDir);
+
+  RandomNumberGenerator rng;
+  AesKeyParams params(128);
+  Buffer keyBuf1 = algo::Aes::generateKey(rng, params).getKeyBits();
+  Buffer keyBuf2 = algo::Aes::generateKey(rng, params).getKeyBits();
+
+  Name nodeName1("/prefix/READ/a/E-KEY");
+  Name nodeName2("/prefix/READ/a/b/E-KEY");
+
+  system_clock::TimePoint point1(time::fromIsoString("20150101T100000"));
+  system_clock::TimePoint point2(time::fromIsoString("20150101T120000"));
+  system_clock::TimePoint point3(time::fromIsoString("20150101T140000"));
+
+  // add E-KEYs into the database
+  BOOST_CHECK_EQUAL(db.hasEKey(nodeName1), false);
+  BOOST_CHECK_NO_THROW(db.addEKey(nodeName1, point1, point2, keyBuf1));
+  BOOST_CHECK_EQUAL(db.hasEKey(nodeName1), true);
+  BOOST_CHECK_EQUAL(db.hasEKey(nodeName2), false);
+
+  // get E-KEY
+  system_clock::TimePoint begin;
+  system_clock::TimePoint end;
+  Buffer keyResult;
+  std::tie(begin, end, keyResult) = db.getEKey(nodeName1);
+  BOOST_CHECK(begin == point1);
+  BOOST_CHECK(end == point2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(keyResult.begin(), keyResult.end(),
+                                keyBuf1.begin(), keyBuf1.end());
+
+  // throw exception when there is no E-KEY for the node
+  BOOST_CHECK_THROW(db.getEKey(nodeName2), ProducerDB::Error);
+
+  // a newer E-KEY replaces the old one
+  BOOST_CHECK_NO_THROW(db.addEKey(nodeName1, point2, point3, keyBuf2));
+  std::tie(begin, end, keyResult) = db.getEKey(nodeName1);
+  BOOST_CHECK(begin == point2);
+  BOOST_CHECK(end == point3);
+  BOOST_CHECK_EQUAL_COLLECTIONS(keyResult.begin(), keyResult.end(),
+                                keyBuf2.begin(), keyBuf2.end());
+
+  // delete E-KEY
+  db.deleteEKey(nodeName1);
+  BOOST_CHECK_EQUAL(db.hasEKey(nodeName1), false);
+  BOOST_CHECK_NO_THROW(db.deleteEKey(nodeName2));
+}
+
+BOOST_AUTO_TEST_CASE(Retention)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+
+  RandomNumberGenerator rng;
+  AesKeyParams params(128);
+  Buffer keyBuf = algo::Aes::generateKey(rng, params).getKeyBits();
+
+  // 10 days of hourly content keys
+  system_clock::TimePoint begin(time::fromIsoString("20150101T000000"));
+  {
+    ProducerDB db(dbDir);
+    for (int i = 0; i < 240; i++)
+      db.addContentKey(begin + time::hours(i), keyBuf);
+  }
+  uintmax_t fullSize = boost::filesystem::file_size(dbDir);
+
+  // reopen, as a producer restarting with a retention policy
+  ProducerDB db(dbDir);
+  BOOST_CHECK_EQUAL(db.getContentKeyCount(), 240);
+
+  // keys before the hour covering the timeslot are deleted, oldest first, by batch
+  system_clock::TimePoint cutoff = begin + time::hours(200) + time::minutes(30);
+  BOOST_CHECK_EQUAL(db.deleteContentKeysBefore(cutoff, 150), 150);
+  BOOST_CHECK_EQUAL(db.hasContentKey(begin + time::hours(149)), false);
+  BOOST_CHECK_EQUAL(db.hasContentKey(begin + time::hours(150)), true);
+  BOOST_CHECK_EQUAL(db.deleteContentKeysBefore(cutoff), 50);
+  BOOST_CHECK_EQUAL(db.deleteContentKeysBefore(cutoff), 0);
+  BOOST_CHECK_EQUAL(db.hasContentKey(begin + time::hours(199)), false);
+  BOOST_CHECK_EQUAL(db.hasContentKey(begin + time::hours(200)), true);
+  BOOST_CHECK_EQUAL(db.getContentKeyCount(), 40);
+
+  // the freed pages are returned to the file system
+  db.compact();
+  BOOST_CHECK_LT(boost::filesystem::file_size(dbDir), fullSize);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -31,6 +31,9 @@
 #include <boost/asio.hpp>
 #include <boost/filesystem.hpp>
 
+#include <fstream>
+#include <sstream>
+
 namespace ndn {
 namespace gep {
 namespace tests {
@@ -267,6 +270,66 @@ BOOST_AUTO_TEST_CASE(ContentKeyRequest)
                                 DATA_CONTEN + sizeof(DATA_CONTEN));
 }
 
+BOOST_AUTO_TEST_CASE(BinaryTimestampNaming)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+
+  Name prefix("/prefix");
+  Name suffix("/a/b/c");
+  Name expectedInterest = prefix;
+  expectedInterest.append(NAME_COMPONENT_READ).append(suffix).append(NAME_COMPONENT_E_KEY);
+
+  // E-KEYs named by a group manager with binary timestamps
+  Name timeMarker;
+  timeMarker.appendTimestamp(time::fromIsoString("20150101T100000"))
+            .appendTimestamp(time::fromIsoString("20150101T120000"));
+  for (size_t i = 0; i < suffix.size(); i++) {
+    createEncryptionKey(expectedInterest, timeMarker);
+    expectedInterest = expectedInterest.getPrefix(-2).append(NAME_COMPONENT_E_KEY);
+  }
+
+  face2->setInterestFilter(prefix,
+         [&] (const InterestFilter&, const Interest& i) {
+            Name interestName = i.getName();
+            interestName.append(timeMarker);
+            BOOST_REQUIRE(encryptionKeys.find(interestName) != encryptionKeys.end());
+            face2->put(*(encryptionKeys[interestName]));
+         },
+         RegisterPrefixSuccessCallback(),
+         [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  Producer producer(prefix, suffix, *face1, dbDir);
+  producer.setTimestampNaming(TimestampNaming::Binary);
+
+  time::system_clock::TimePoint testTime = time::fromIsoString("20150101T100001");
+  name::Component testTimeRounded =
+    name::Component::fromTimestamp(time::fromIsoString("20150101T100000"));
+  size_t nKeys = 0;
+  Name contentKeyName = producer.createContentKey(testTime,
+    [&] (const std::vector<Data>& result) {
+      for (const Data& cKeyData : result) {
+        BOOST_CHECK_EQUAL(cKeyData.getName().get(6), testTimeRounded);
+        BOOST_CHECK_EQUAL(cKeyData.getName().getSubName(-2), timeMarker);
+      }
+      nKeys = result.size();
+    });
+  BOOST_CHECK_EQUAL(contentKeyName.get(-1), testTimeRounded);
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+  BOOST_CHECK_EQUAL(nKeys, 3);
+
+  Data testData;
+  producer.produce(testData, testTime, DATA_CONTEN, sizeof(DATA_CONTEN));
+  BOOST_CHECK(decodeTimestamp(testData.getName().get(5)) == testTime);
+}
+
 BOOST_AUTO_TEST_CASE(ContentKeySearch)
 {
   std::string dbDir = tmpPath.c_str();
@@ -350,6 +413,253 @@ BOOST_AUTO_TEST_CASE(ContentKeySearch)
   } while (passPacket());
 }
 
+BOOST_AUTO_TEST_CASE(EKeyPersistence)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+
+  Name prefix("/prefix");
+  Name suffix("/suffix");
+  Name expectedInterest = prefix;
+  expectedInterest.append(NAME_COMPONENT_READ);
+  expectedInterest.append(suffix);
+  expectedInterest.append(NAME_COMPONENT_E_KEY);
+
+  Name timeMarker("20150101T100000/20150101T120000");
+  time::system_clock::TimePoint testTime1 = time::fromIsoString("20150101T100001");
+  time::system_clock::TimePoint testTime2 = time::fromIsoString("20150101T110001");
+
+  createEncryptionKey(expectedInterest, timeMarker);
+
+  size_t requestCount = 0;
+  face2->setInterestFilter(prefix,
+         [&] (const InterestFilter&, const Interest& i) {
+            Name interestName = i.getName();
+            interestName.append(timeMarker);
+            face2->put(*(encryptionKeys[interestName]));
+            requestCount++;
+            return;
+         },
+         RegisterPrefixSuccessCallback(),
+         [] (const Name&, const std::string& e) { });
+
+  do {
+    advanceClocks(time::milliseconds(10), 20);
+  } while (passPacket());
+
+  {
+    // the first producer has to retrieve the E-KEY
+    Producer producer(prefix, suffix, *face1, dbDir);
+    size_t resultCount = 0;
+    producer.createContentKey(testTime1,
+            [&](const std::vector<Data>& result){
+              resultCount = result.size();
+            });
+    do {
+      advanceClocks(time::milliseconds(10), 20);
+    } while (passPacket());
+
+    BOOST_CHECK_EQUAL(requestCount, 1);
+    BOOST_CHECK_EQUAL(resultCount, 1);
+  }
+
+  /*
+  Verify that a restarted producer reloads the E-KEY from its database and
+  encrypts the content key of the next hour without any key retrieval.
+  */
+  size_t nSentInterests = face1->sentInterests.size();
+  Producer restartedProducer(prefix, suffix, *face1, dbDir);
+  bool hasCallbackFired = false;
+  restartedProducer.createContentKey(testTime2,
+          [&](const std::vector<Data>& result){
+            hasCallbackFired = true;
+            BOOST_REQUIRE_EQUAL(result.size(), 1);
+            BOOST_CHECK_EQUAL(result[0].getName().getSubName(6),
+                              Name(expectedInterest).append(timeMarker));
+          });
+
+  BOOST_CHECK_EQUAL(hasCallbackFired, true);
+  BOOST_CHECK_EQUAL(face1->sentInterests.size(), nSentInterests);
+  BOOST_CHECK_EQUAL(requestCount, 1);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerPoolWrap)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+
+  Name prefix("/prefix");
+  Name suffix("/a/b/c");
+  Name nodeName = prefix;
+  nodeName.append(NAME_COMPONENT_READ);
+  nodeName.append(suffix);
+  nodeName.append(NAME_COMPONENT_E_KEY);
+
+  Name timeMarker("20150101T100000/20150101T120000");
+  time::system_clock::TimePoint testTime = time::fromIsoString("20150101T100001");
+
+  // cache the E-KEYs of all the nodes, so that no E-KEY is retrieved
+  {
+    ProducerDB db(dbDir);
+    for (size_t i = 0; i < suffix.size(); i++) {
+      createEncryptionKey(nodeName, timeMarker);
+      const Block& eKey = encryptionKeys[Name(nodeName).append(timeMarker)]->getContent();
+      db.addEKey(nodeName, time::fromIsoString("20150101T100000"),
+                 time::fromIsoString("20150101T120000"),
+                 Buffer(eKey.value(), eKey.value_size()));
+      nodeName = nodeName.getPrefix(-2).append(NAME_COMPONENT_E_KEY);
+    }
+  }
+
+  Producer producer(prefix, suffix, *face1, dbDir);
+  producer.setWorkerPool(make_shared<WorkerPool>(2));
+  std::vector<Data> result;
+  bool hasCallbackFired = false;
+  producer.createContentKey(testTime,
+          [&](const std::vector<Data>& keys){
+            hasCallbackFired = true;
+            result = keys;
+          });
+
+  // the keys are wrapped on the pool and handed back through the io_service
+  BOOST_CHECK_EQUAL(hasCallbackFired, false);
+  io.run();
+  BOOST_CHECK_EQUAL(hasCallbackFired, true);
+  BOOST_CHECK_EQUAL(face1->sentInterests.size(), 0);
+  BOOST_REQUIRE_EQUAL(result.size(), 3);
+
+  Buffer contentKey = ProducerDB(dbDir).getContentKey(testTime);
+  algo::EncryptParams params(tlv::AlgorithmRsaOaep);
+  for (const Data& cKeyData : result) {
+    Block encryptedKeyBlock = cKeyData.getContent();
+    encryptedKeyBlock.parse();
+    EncryptedContent content(*(encryptedKeyBlock.elements_begin()));
+    const Buffer& encryptedKey = content.getPayload();
+    const Buffer& decryptionKey = decryptionKeys.at(cKeyData.getName().getSubName(8));
+    Buffer retrievedKey = algo::Rsa::decrypt(decryptionKey.buf(), decryptionKey.size(),
+                                             encryptedKey.buf(), encryptedKey.size(),
+                                             params);
+    BOOST_CHECK_EQUAL_COLLECTIONS(contentKey.begin(), contentKey.end(),
+                                  retrievedKey.begin(), retrievedKey.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(KeyRequestSoak)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+
+  Name prefix("/prefix");
+  Name suffix("/suffix");
+  Name nodeName = prefix;
+  nodeName.append(NAME_COMPONENT_READ);
+  nodeName.append(suffix);
+  nodeName.append(NAME_COMPONENT_E_KEY);
+
+  // an E-KEY covering the whole soak, so that every content key is encrypted right away
+  Name timeMarker("20150101T000000/20160101T000000");
+  createEncryptionKey(nodeName, timeMarker);
+  const Block& eKey = encryptionKeys[Name(nodeName).append(timeMarker)]->getContent();
+  ProducerDB(dbDir).addEKey(nodeName, time::fromIsoString("20150101T000000"),
+                            time::fromIsoString("20160101T000000"),
+                            Buffer(eKey.value(), eKey.value_size()));
+
+  Producer producer(prefix, suffix, *face1, dbDir);
+  time::system_clock::TimePoint hour = time::fromIsoString("20150101T000000");
+  const size_t nHours = 500;
+  for (size_t i = 0; i < nHours; i++, hour += time::hours(1)) {
+    // produce() creates the content key of a new hour without a callback
+    Data data;
+    producer.produce(data, hour, DATA_CONTEN, sizeof(DATA_CONTEN));
+    BOOST_REQUIRE_EQUAL(producer.getKeyRequestMetrics().nOutstanding, 0);
+  }
+
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().nCompleted, nHours);
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().maxOutstanding, 1);
+  BOOST_CHECK_EQUAL(face1->sentInterests.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(KeyRequestDeadlineAndCancel)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+
+  // no E-KEY is ever answered
+  Producer producer(Name("/prefix"), Name("/suffix"), *face1, dbDir);
+  producer.setKeyRequestDeadline(time::milliseconds(500));
+  producer.setMaxKeyRequests(2);
+
+  std::vector<ErrorCode> errors;
+  size_t nResults = 0;
+  auto createContentKey = [&] (const char* timeslot) {
+    producer.createContentKey(time::fromIsoString(timeslot),
+                              [&] (const std::vector<Data>&) { nResults++; },
+                              [&] (const ErrorCode& code, const std::string&) {
+                                errors.push_back(code);
+                              });
+  };
+
+  createContentKey("20150101T100001");
+  createContentKey("20150101T110001");
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().nOutstanding, 2);
+
+  // the oldest request makes room for the third one
+  createContentKey("20150101T120001");
+  BOOST_REQUIRE_EQUAL(errors.size(), 1);
+  BOOST_CHECK(errors[0] == ErrorCode::Cancelled);
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().nEvicted, 1);
+
+  BOOST_CHECK_EQUAL(producer.cancelKeyRequest(time::fromIsoString("20150101T110001")), true);
+  BOOST_CHECK_EQUAL(producer.cancelKeyRequest(time::fromIsoString("20150101T110001")), false);
+  BOOST_REQUIRE_EQUAL(errors.size(), 2);
+  BOOST_CHECK(errors[1] == ErrorCode::Cancelled);
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().nCancelled, 1);
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().nOutstanding, 1);
+
+  // the last request expires, and the late timeouts of its interests are ignored
+  advanceClocks(time::milliseconds(10), 60);
+  BOOST_REQUIRE_EQUAL(errors.size(), 3);
+  BOOST_CHECK(errors[2] == ErrorCode::Timeout);
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().nExpired, 1);
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().nOutstanding, 0);
+
+  advanceClocks(time::seconds(1), 30);
+  BOOST_CHECK_EQUAL(errors.size(), 3);
+  BOOST_CHECK_EQUAL(nResults, 0);
+  BOOST_CHECK_EQUAL(producer.getKeyRequestMetrics().maxOutstanding, 2);
+}
+
+BOOST_AUTO_TEST_CASE(CreateContentKeyAsync)
+{
+  std::string dbDir = tmpPath.c_str();
+  time::system_clock::TimePoint testTime = time::fromIsoString("20150101T100001");
+
+  // a producer without E-KEY node has nothing to retrieve
+  Producer rootProducer(Name("/prefix"), Name(), *face1, dbDir + "/root.db");
+  Future<std::vector<Data>> noEKey = rootProducer.createContentKeyAsync(testTime);
+  BOOST_REQUIRE(noEKey.isReady());
+  BOOST_REQUIRE(noEKey.hasValue());
+  BOOST_CHECK_EQUAL(noEKey.get().size(), 0);
+
+  // no E-KEY is ever answered
+  Producer producer(Name("/prefix"), Name("/suffix"), *face1, dbDir + "/test.db");
+  Future<std::vector<Data>> first = producer.createContentKeyAsync(testTime);
+  BOOST_CHECK_EQUAL(first.isReady(), false);
+
+  // a call for the timeslot still being retrieved, after its content key is deleted, ends
+  // with the retrieval
+  ProducerDB testDb(dbDir + "/test.db");
+  BOOST_CHECK_EQUAL(testDb.deleteContentKeysBefore(time::fromIsoString("20150102T000000")), 1);
+  Future<std::vector<Data>> second = producer.createContentKeyAsync(testTime);
+  BOOST_CHECK_EQUAL(second.isReady(), false);
+
+  BOOST_CHECK(producer.cancelKeyRequest(testTime));
+  BOOST_REQUIRE(first.isReady());
+  BOOST_REQUIRE(second.isReady());
+  BOOST_CHECK(first.getErrorCode() == ErrorCode::Cancelled);
+  BOOST_CHECK(second.getErrorCode() == ErrorCode::Cancelled);
+}
+
 BOOST_AUTO_TEST_CASE(ContentKeyTimeout)
 {
   std::string dbDir = tmpPath.c_str();
@@ -394,6 +704,112 @@ BOOST_AUTO_TEST_CASE(ContentKeyTimeout)
   } while (passPacket());
 }
 
+BOOST_AUTO_TEST_CASE(SharedKeyChain)
+{
+  std::string dbDir = tmpPath.c_str();
+  Name certName = keyChain.getDefaultCertificateName();
+  uint8_t content[] = {0x01, 0x02, 0x03};
+
+  // producers of different data types sign with the same injected KeyChain
+  Producer producerA(Name("/prefix"), Name("/a"), *face1, dbDir + "/test-a.db", keyChain);
+  Producer producerB(Name("/prefix"), Name("/b"), *face1, dbDir + "/test-b.db", keyChain, 1);
+
+  time::system_clock::TimePoint testTime = time::fromIsoString("20150101T100001");
+  Data dataA, dataB;
+  producerA.produce(dataA, testTime, content, sizeof(content));
+  producerB.produce(dataB, testTime, content, sizeof(content));
+
+  BOOST_CHECK_EQUAL(dataA.getSignature().getKeyLocator().getName(), certName);
+  BOOST_CHECK_EQUAL(dataB.getSignature().getKeyLocator().getName(), certName);
+}
+
+BOOST_AUTO_TEST_CASE(ProduceSegments)
+{
+  std::string dbDir = tmpPath.c_str();
+  Producer producer(Name("/prefix"), Name("/a"), *face1, dbDir + "/test.db");
+  ProducerDB testDb(dbDir + "/test.db");
+
+  std::string content;
+  for (size_t i = 0; i < 10000; i++)
+    content.push_back(static_cast<char>(i % 251));
+
+  time::system_clock::TimePoint testTime = time::fromIsoString("20150101T100001");
+  std::istringstream is(content);
+  std::vector<Data> segments = producer.produceSegments(testTime, is, 4096);
+
+  std::string filePath = dbDir + "/content";
+  std::ofstream(filePath, std::ios::binary) << content;
+  std::vector<Data> mappedSegments = producer.produceSegments(testTime, filePath, 4096);
+
+  Buffer contentKey = testDb.getContentKey(testTime);
+  Name dataName("/prefix/SAMPLE/a/20150101T100001");
+
+  for (const auto& result : {segments, mappedSegments}) {
+    BOOST_REQUIRE_EQUAL(result.size(), 3);
+
+    std::string decrypted;
+    std::set<Buffer> ivs;
+    for (size_t i = 0; i < result.size(); i++) {
+      BOOST_CHECK_EQUAL(result[i].getName(), Name(dataName).appendSegment(i));
+      BOOST_CHECK_EQUAL(result[i].getFinalBlockId(), name::Component::fromSegment(2));
+
+      EncryptedContent encryptedContent(result[i].getContent().blockFromValue());
+      ivs.insert(encryptedContent.getInitialVector());
+
+      algo::EncryptParams decryptParams(tlv::AlgorithmAesCbc);
+      decryptParams.setIV(encryptedContent.getInitialVector().buf(),
+                          encryptedContent.getInitialVector().size());
+      Buffer payload = algo::Aes::decrypt(contentKey.buf(), contentKey.size(),
+                                          encryptedContent.getPayload().buf(),
+                                          encryptedContent.getPayload().size(),
+                                          decryptParams);
+      decrypted.append(payload.begin(), payload.end());
+    }
+
+    // each segment is encrypted with its own initial vector
+    BOOST_CHECK_EQUAL(ivs.size(), result.size());
+    BOOST_CHECK(decrypted == content);
+  }
+
+  // an empty content is produced as one segment
+  std::istringstream empty;
+  BOOST_CHECK_EQUAL(producer.produceSegments(testTime, empty, 4096).size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ContentKeyRetention)
+{
+  std::string dbDir = tmpPath.c_str();
+  dbDir += "/test.db";
+
+  // 10 days of hourly content keys left by a previous run
+  time::system_clock::TimePoint begin = time::fromIsoString("20150101T000000");
+  {
+    ProducerDB db(dbDir);
+    for (int i = 0; i < 240; i++)
+      db.addContentKey(begin + time::hours(i), Buffer(16));
+  }
+  systemClock->setNow(time::toUnixTimestamp(begin + time::hours(240)));
+
+  Producer producer(Name("/prefix"), Name("/a"), *face1, dbDir);
+  producer.setContentKeyRetention(time::hours(48), time::hours(1));
+  ProducerDB testDb(dbDir);
+
+  // the first round runs right away
+  advanceClocks(time::milliseconds(10), 10);
+  BOOST_CHECK_EQUAL(testDb.getContentKeyCount(), 48);
+  BOOST_CHECK_EQUAL(testDb.hasContentKey(begin + time::hours(191)), false);
+  BOOST_CHECK_EQUAL(testDb.hasContentKey(begin + time::hours(192)), true);
+
+  // the following rounds prune the hours leaving the window
+  advanceClocks(time::minutes(1), 125);
+  BOOST_CHECK_EQUAL(testDb.getContentKeyCount(), 46);
+
+  // disabled retention keeps the keys
+  producer.setContentKeyRetention(time::hours(0));
+  advanceClocks(time::minutes(1), 125);
+  BOOST_CHECK_EQUAL(testDb.getContentKeyCount(), 46);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
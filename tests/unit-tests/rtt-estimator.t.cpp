@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rtt-estimator.hpp"
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestRttEstimator)
+
+BOOST_AUTO_TEST_CASE(Estimation)
+{
+  RttEstimator::Options options;
+  RttEstimator estimator(options);
+  Name prefix("/prefix/READ/a/E-KEY");
+
+  // initial RTO before any measurement
+  BOOST_CHECK(estimator.getRto(prefix) == options.initialRto);
+  BOOST_CHECK_EQUAL(estimator.getStatistics(prefix).nSamples, 0);
+
+  // the first measurement initializes SRTT and RTTVAR
+  estimator.addMeasurement(prefix, time::milliseconds(100));
+  RttEstimator::Statistics statistics = estimator.getStatistics(prefix);
+  BOOST_CHECK(statistics.srtt == time::milliseconds(100));
+  BOOST_CHECK(statistics.rttVar == time::milliseconds(50));
+  BOOST_CHECK(statistics.rto == time::milliseconds(300));
+  BOOST_CHECK_EQUAL(statistics.nSamples, 1);
+
+  // following measurements are smoothed
+  estimator.addMeasurement(prefix, time::milliseconds(100));
+  statistics = estimator.getStatistics(prefix);
+  BOOST_CHECK(statistics.srtt == time::milliseconds(100));
+  BOOST_CHECK(statistics.rttVar == time::nanoseconds(37500000));
+  BOOST_CHECK(statistics.rto == time::milliseconds(250));
+
+  // RTO is bounded
+  for (int i = 0; i < 100; i++)
+    estimator.addMeasurement(prefix, time::milliseconds(1));
+  BOOST_CHECK(estimator.getRto(prefix) == options.minRto);
+
+  for (int i = 0; i < 100; i++)
+    estimator.addMeasurement(prefix, time::seconds(10));
+  BOOST_CHECK(estimator.getRto(prefix) == options.maxRto);
+
+  // other prefixes are not affected
+  BOOST_CHECK(estimator.getRto(Name("/prefix/READ/E-KEY")) == options.initialRto);
+}
+
+BOOST_AUTO_TEST_CASE(Backoff)
+{
+  RttEstimator estimator;
+  Name prefix("/prefix/READ/a/E-KEY");
+
+  BOOST_CHECK(estimator.backoff(prefix, time::milliseconds(300)) == time::milliseconds(600));
+  BOOST_CHECK(estimator.backoff(prefix, time::milliseconds(3000)) == time::seconds(4));
+
+  estimator.addTimeout(prefix);
+  estimator.addTimeout(prefix);
+  BOOST_CHECK_EQUAL(estimator.getStatistics(prefix).nTimeouts, 2);
+}
+
+BOOST_AUTO_TEST_CASE(MeasurementPrefix)
+{
+  BOOST_CHECK_EQUAL(RttEstimator::getMeasurementPrefix(Name("/p/READ/a/E-KEY")),
+                    Name("/p/READ/a/E-KEY"));
+  BOOST_CHECK_EQUAL(RttEstimator::getMeasurementPrefix(Name("/p/SAMPLE/a/C-KEY/1/FOR/p/READ")),
+                    Name("/p/SAMPLE/a/C-KEY"));
+  BOOST_CHECK_EQUAL(RttEstimator::getMeasurementPrefix(Name("/p/READ/a/D-KEY/1/2/FOR/u")),
+                    Name("/p/READ/a/D-KEY"));
+  BOOST_CHECK_EQUAL(RttEstimator::getMeasurementPrefix(Name("/p/SAMPLE/a/20150101T100000")),
+                    Name("/p/SAMPLE/a"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "span-tracer.hpp"
+#include "boost-test.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestSpanTracer)
+
+BOOST_AUTO_TEST_CASE(Disabled)
+{
+  SpanTracer tracer;
+  BOOST_CHECK_EQUAL(tracer.isEnabled(), false);
+
+  // the global tracer is disabled unless enabled explicitly
+  size_t nEvents = SpanTracer::get().size();
+  {
+    ScopedSpan span("disabled");
+    span.setDetail("detail");
+  }
+  BOOST_CHECK_EQUAL(SpanTracer::get().size(), nEvents);
+}
+
+BOOST_AUTO_TEST_CASE(RecordEvents)
+{
+  SpanTracer tracer;
+  tracer.enable();
+  BOOST_CHECK_EQUAL(tracer.isEnabled(), true);
+
+  tracer.addSpan("decrypt", time::steady_clock::now(), "C-KEY hit");
+  tracer.addInstant("timeout", "/a/b");
+  uint64_t id = tracer.getNextAsyncId();
+  BOOST_CHECK_NE(id, 0);
+  BOOST_CHECK_NE(tracer.getNextAsyncId(), id);
+  tracer.beginAsync("consume", id, "/a/b");
+  tracer.endAsync("consume", id);
+  BOOST_CHECK_EQUAL(tracer.size(), 4);
+
+  tracer.clear();
+  BOOST_CHECK_EQUAL(tracer.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ScopedSpanRecord)
+{
+  SpanTracer& tracer = SpanTracer::get();
+  tracer.enable();
+  tracer.clear();
+  {
+    ScopedSpan span("scoped");
+    span.setDetail("detail");
+  }
+  tracer.disable();
+
+  BOOST_CHECK_EQUAL(tracer.size(), 1);
+  std::ostringstream os;
+  tracer.writeChromeTrace(os);
+  tracer.clear();
+
+  std::string json = os.str();
+  BOOST_CHECK(json.find("\"name\":\"scoped\"") != std::string::npos);
+  BOOST_CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+  BOOST_CHECK(json.find("\"args\":{\"detail\":\"detail\"}") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(ChromeTrace)
+{
+  SpanTracer tracer;
+  std::ostringstream empty;
+  tracer.writeChromeTrace(empty);
+  BOOST_CHECK_EQUAL(empty.str(), "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n]}\n");
+
+  tracer.enable();
+  tracer.addInstant("nack", "/a/\"b\"\\c");
+  tracer.beginAsync("consume", 7);
+  tracer.endAsync("consume", 7);
+
+  std::ostringstream os;
+  tracer.writeChromeTrace(os);
+  std::string json = os.str();
+
+  BOOST_CHECK(json.find("\"ph\":\"i\",") != std::string::npos);
+  BOOST_CHECK(json.find("\"detail\":\"/a/\\\"b\\\"\\\\c\"") != std::string::npos);
+  BOOST_CHECK(json.find("\"ph\":\"b\",") != std::string::npos);
+  BOOST_CHECK(json.find("\"ph\":\"e\",") != std::string::npos);
+  BOOST_CHECK(json.find("\"id\":7") != std::string::npos);
+  BOOST_CHECK_EQUAL(std::count(json.begin(), json.end(), '{'),
+                    std::count(json.begin(), json.end(), '}'));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timestamp-name.hpp"
+#include "boost-test.hpp"
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+using boost::posix_time::from_iso_string;
+
+BOOST_AUTO_TEST_SUITE(TestTimestampName)
+
+BOOST_AUTO_TEST_CASE(Iso)
+{
+  time::system_clock::TimePoint tp = time::fromIsoString("20150825T093000");
+  name::Component component = encodeTimestamp(tp, TimestampNaming::Iso);
+  BOOST_CHECK_EQUAL(component.toUri(), "20150825T093000");
+  BOOST_CHECK_EQUAL(encodeTimestamp(from_iso_string("20150825T093000"), TimestampNaming::Iso),
+                    component);
+  BOOST_CHECK(decodeTimestamp(component) == tp);
+  BOOST_CHECK(getTimestampNaming(component) == TimestampNaming::Iso);
+}
+
+BOOST_AUTO_TEST_CASE(Binary)
+{
+  time::system_clock::TimePoint tp = time::fromIsoString("20150825T093000.123456");
+  name::Component component = encodeTimestamp(tp, TimestampNaming::Binary);
+  BOOST_CHECK(component.isTimestamp());
+  BOOST_CHECK_LT(component.size(), encodeTimestamp(tp, TimestampNaming::Iso).size());
+  BOOST_CHECK_EQUAL(encodeTimestamp(from_iso_string("20150825T093000.123456"),
+                                    TimestampNaming::Binary), component);
+  BOOST_CHECK(decodeTimestamp(component) == tp);
+  BOOST_CHECK(getTimestampNaming(component) == TimestampNaming::Binary);
+
+  // the canonical order of binary timestamps follows time, as exclude filters need
+  BOOST_CHECK_LT(component, encodeTimestamp(tp + time::hours(1), TimestampNaming::Binary));
+}
+
+BOOST_AUTO_TEST_CASE(Invalid)
+{
+  BOOST_CHECK_THROW(decodeTimestamp(name::Component("E-KEY")), std::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace-recorder.hpp"
+#include "producer.hpp"
+#include "boost-test.hpp"
+#include "unit-test-time-fixture.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <boost/filesystem.hpp>
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+class TraceRecorderFixture : public UnitTestTimeFixture
+{
+public:
+  TraceRecorderFixture()
+    : tmpPath(boost::filesystem::path(TMP_TESTS_PATH))
+  {
+    boost::filesystem::create_directories(tmpPath);
+    systemClock->setNow(time::toUnixTimestamp(time::fromIsoString("20150825T090000")));
+  }
+
+  ~TraceRecorderFixture()
+  {
+    boost::filesystem::remove_all(tmpPath);
+  }
+
+public:
+  boost::filesystem::path tmpPath;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestTraceRecorder, TraceRecorderFixture)
+
+BOOST_AUTO_TEST_CASE(RecordAndRead)
+{
+  std::string tracePath = (tmpPath / "test.trace").string();
+  time::system_clock::TimePoint timeslot = time::fromIsoString("20150825T090000");
+  {
+    TraceRecorder recorder(tracePath);
+    recorder.record(trace::Produce, Name("/Alice/SAMPLE/data_type"), Name(), timeslot, 1024);
+    advanceClocks(time::milliseconds(1500));
+    recorder.record(trace::Consume, Name("/Alice/SAMPLE/data_type/20150825T090000"),
+                    Name("/ndn/memberA"));
+    recorder.record(trace::ConsumeError, Name("/Alice/SAMPLE/data_type/20150825T090000"),
+                    Name("/ndn/memberA"), time::system_clock::TimePoint(), 1);
+    BOOST_CHECK_EQUAL(recorder.getNRecords(), 3);
+  }
+
+  TraceReader reader(tracePath);
+  BOOST_CHECK(reader.getStartTime() == timeslot);
+
+  TraceRecord record;
+  BOOST_REQUIRE(reader.read(record));
+  BOOST_CHECK_EQUAL(record.type, trace::Produce);
+  BOOST_CHECK(record.time == timeslot);
+  BOOST_CHECK_EQUAL(record.name, Name("/Alice/SAMPLE/data_type"));
+  BOOST_CHECK(record.actor.empty());
+  BOOST_CHECK(record.timeslot == timeslot);
+  BOOST_CHECK_EQUAL(record.size, 1024);
+
+  BOOST_REQUIRE(reader.read(record));
+  BOOST_CHECK_EQUAL(record.type, trace::Consume);
+  BOOST_CHECK(record.time == timeslot + time::milliseconds(1500));
+  BOOST_CHECK_EQUAL(record.actor, Name("/ndn/memberA"));
+  BOOST_CHECK(record.timeslot == time::system_clock::TimePoint());
+  BOOST_CHECK_EQUAL(record.size, 0);
+
+  BOOST_REQUIRE(reader.read(record));
+  BOOST_CHECK_EQUAL(record.type, trace::ConsumeError);
+  BOOST_CHECK_EQUAL(record.size, 1);
+
+  BOOST_CHECK_EQUAL(reader.read(record), false);
+
+  // records are a few octets more than their names
+  BOOST_CHECK_LT(boost::filesystem::file_size(tracePath), 200);
+}
+
+BOOST_AUTO_TEST_CASE(MalformedTrace)
+{
+  std::string tracePath = (tmpPath / "test.trace").string();
+  BOOST_CHECK_THROW(TraceReader(tracePath), TraceReader::Error);
+
+  std::ofstream(tracePath) << "GEPX";
+  BOOST_CHECK_THROW(TraceReader(tracePath), TraceReader::Error);
+
+  {
+    TraceRecorder recorder(tracePath);
+    recorder.record(trace::Produce, Name("/Alice/SAMPLE/data_type"));
+  }
+  boost::filesystem::resize_file(tracePath, boost::filesystem::file_size(tracePath) - 1);
+  TraceReader reader(tracePath);
+  TraceRecord record;
+  BOOST_CHECK_THROW(reader.read(record), TraceReader::Error);
+}
+
+BOOST_AUTO_TEST_CASE(ProducerEvents)
+{
+  std::string tracePath = (tmpPath / "test.trace").string();
+  auto face = util::makeDummyClientFace(io, {true, true});
+  time::system_clock::TimePoint timeslot = time::fromIsoString("20150825T093000");
+  uint8_t content[] = {0x01, 0x02, 0x03};
+  {
+    auto recorder = make_shared<TraceRecorder>(tracePath);
+    Producer producer(Name("/Alice"), Name("/data_type"), *face,
+                      (tmpPath / "test.db").string());
+    producer.setTraceRecorder(recorder);
+
+    Data data;
+    producer.produce(data, timeslot, content, sizeof(content));
+  }
+
+  TraceReader reader(tracePath);
+  TraceRecord record;
+  BOOST_REQUIRE(reader.read(record));
+  BOOST_CHECK_EQUAL(record.type, trace::Produce);
+  BOOST_CHECK_EQUAL(record.name, Name("/Alice/SAMPLE/data_type"));
+  BOOST_CHECK(record.timeslot == timeslot);
+  BOOST_CHECK_EQUAL(record.size, sizeof(content));
+
+  BOOST_REQUIRE(reader.read(record));
+  BOOST_CHECK_EQUAL(record.type, trace::ContentKey);
+  BOOST_CHECK_EQUAL(record.name, Name("/Alice/SAMPLE/data_type/C-KEY/20150825T090000"));
+  BOOST_CHECK(record.timeslot == time::fromIsoString("20150825T090000"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn
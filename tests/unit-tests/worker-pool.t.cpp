@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2015,  Regents of the University of California
+ *
+ * This file is part of ndn-group-encrypt (Group-based Encryption Protocol for NDN).
+ * See AUTHORS.md for complete list of ndn-group-encrypt authors and contributors.
+ *
+ * ndn-group-encrypt is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-group-encrypt is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-group-encrypt, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worker-pool.hpp"
+#include "boost-test.hpp"
+
+#include <atomic>
+
+namespace ndn {
+namespace gep {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestWorkerPool)
+
+BOOST_AUTO_TEST_CASE(RunTasks)
+{
+  std::atomic<int> nRuns(0);
+  std::set<std::thread::id> threadIds;
+  std::mutex mutex;
+  {
+    WorkerPool pool(4);
+    BOOST_CHECK_EQUAL(pool.size(), 4);
+    for (int i = 0; i < 100; i++)
+      pool.post([&] {
+          nRuns++;
+          std::lock_guard<std::mutex> lock(mutex);
+          threadIds.insert(std::this_thread::get_id());
+        });
+  }
+  // the posted tasks are run before the pool is destroyed
+  BOOST_CHECK_EQUAL(nRuns.load(), 100);
+  BOOST_CHECK_LE(threadIds.size(), 4);
+  BOOST_CHECK_EQUAL(threadIds.count(std::this_thread::get_id()), 0);
+
+  WorkerPool defaultPool;
+  BOOST_CHECK_GE(defaultPool.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace gep
+} // namespace ndn